@@ -0,0 +1,260 @@
+/* Short_Cycle_Batch.cpp
+
+   Copyright (c) 2005 Thomas R. Halford 
+   All rights reserved.
+ 
+   Developed by: Thomas R. Halford
+                 Communication Sciences Institute
+                 University of Southern California
+                 http://csi.usc.edu
+ 
+   Permission is hereby granted, free of charge, to any person obtaining a copy 
+   of this software and associated documentation files (the "Software"), to deal 
+   with the Software without restriction, including without limitation the rights 
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+   copies of the Software, and to permit persons to whom the Software is furnished 
+   to do so, subject to the following conditions:
+  
+    * Redistributions of source code must retain the above copyright notice, this 
+      list of conditions and the following disclaimers.
+    * Redistributions in binary form must reproduce the above copyright notice, 
+      this list of conditions and the following disclaimers in the documentation 
+      and/or other materials provided with the distribution.
+    * Neither the names of Thomas R. Halford, the Communication Sciences Institute, 
+      the University of Southern California nor the names of its contributors may 
+      be used to endorse or promote products derived from this Software without 
+      specific prior written permission. 
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+   INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+   PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE CONTRIBUTORS OR 
+   COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN 
+   AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION 
+   WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE SOFTWARE.
+*/
+
+
+#include <algorithm>
+#include <sstream>
+#include "Short_Cycle_Batch.h"
+#include "Short_Cycle_Sparse_Matrix.h"
+#include "Short_Cycle_Counter.h"
+#include "Short_Cycle_Tasks.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+#if SCM_THREADS
+#include <thread>
+#endif
+
+using namespace std;
+
+Short_Cycle_Batch::Short_Cycle_Batch( void )
+ : next_file_(0), next_stream_(0), jobs_(0), threads_(0), read_ahead_(0)
+#if SCM_THREADS
+   , done_(0), errors_(0)
+#endif
+{
+	return;
+}
+
+void Short_Cycle_Batch::add_file( const string& filename )
+{
+	files_.push_back(filename);
+}
+
+int Short_Cycle_Batch::add_directory( const string& dirname )
+{
+	vector<string> names;
+#ifdef _WIN32
+	WIN32_FIND_DATAA data;
+	HANDLE find = FindFirstFileA((dirname+"\\*").c_str(),&data);
+	if( find == INVALID_HANDLE_VALUE ) return 0;
+	do
+	{
+		if( data.cFileName[0] != '.' && !(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) ) 
+			names.push_back(dirname+"\\"+data.cFileName);
+	}
+	while( FindNextFileA(find,&data) );
+	FindClose(find);
+#else
+	DIR* dir = opendir(dirname.c_str());
+	if( dir == NULL ) return 0;
+	struct dirent* entry;
+	while( (entry = readdir(dir)) != NULL )
+	{
+		struct stat info;
+		string name = dirname+"/"+entry->d_name;
+		if( entry->d_name[0] != '.' && stat(name.c_str(),&info) == 0 && S_ISREG(info.st_mode) ) 
+			names.push_back(name);
+	}
+	
+	closedir(dir);
+#endif
+	
+	sort(names.begin(),names.end());
+	files_.insert(files_.end(),names.begin(),names.end());
+	return 1;
+}
+
+void Short_Cycle_Batch::add_stream( istream& names )
+{
+	streams_.push_back(&names);
+}
+
+// The files come first, then the names read from each stream in turn.
+// Blank lines are skipped.
+int Short_Cycle_Batch::next_name( string& name )
+{
+	if( next_file_ < files_.size() ) 
+	{
+		name = files_[next_file_++];
+		return 1;
+	}
+	
+	while( next_stream_ < streams_.size() )
+	{
+		while( getline(*streams_[next_stream_],name) )
+		{
+			if( !name.empty() && name[name.size()-1] == '\r' ) name.erase(name.size()-1);
+			if( !name.empty() ) return 1;
+		}
+		
+		next_stream_++;
+	}
+	
+	return 0;
+}
+
+Short_Cycle_Batch::Item Short_Cycle_Batch::read( const string& name )
+{
+	Item item;
+	item.name = name;
+	item.E    = new Short_Cycle_Sparse_Matrix;
+	if( !item.E->map_binary_file(name.c_str()) && !item.E->read_alist_file(name.c_str()) &&
+		!item.E->read_matrix_market_file(name.c_str()) ) 
+	{
+		delete item.E;
+		item.E = NULL;
+	}
+	
+	return item;
+}
+
+// Count one graph and write its line.  Returns 0 if it could not be read.
+int Short_Cycle_Batch::count( Short_Cycle_Counter& counter, Item& item, ostream& out )
+{
+	if( item.E == NULL ) 
+	{
+		out << item.name << "\terror\n" << flush;
+		return 0;
+	}
+	
+	counter.initialize(*item.E);
+	delete item.E;
+	item.E = NULL;
+	counter.count();
+	out << item.name << "\t" << counter.girth() << "\t" << counter.Ng() << "\t" << counter.Ng2() 
+		<< "\t" << counter.Ng4() << (counter.exact() ? "" : "\tinexact") << "\n" << flush;
+	return 1;
+}
+
+#if SCM_THREADS
+
+// The counters share pool_ (see Short_Cycle_Counter::set_pool()).
+int Short_Cycle_Batch::run( ostream& out )
+{
+	Short_Cycle_Thread_Pool probe(threads_);
+	int n_threads = probe.threads();
+	int jobs = (jobs_ > 0 ? jobs_ : n_threads);
+	queue_.clear();
+	done_   = 0;
+	errors_ = 0;
+	
+	thread reader(&Short_Cycle_Batch::read_all,this);
+	vector<thread> workers;
+	for( int jj = 1; jj < jobs; jj++ ) workers.push_back(thread(&Short_Cycle_Batch::count_all,this,jj,&out));
+	count_all(0,&out);
+	for( size_t jj = 0; jj < workers.size(); jj++ ) workers[jj].join();
+	reader.join();
+	return errors_;
+}
+
+void Short_Cycle_Batch::read_all( void )
+{
+	int jobs = (jobs_ > 0 ? jobs_ : Short_Cycle_Thread_Pool(threads_).threads());
+	size_t ahead = (size_t)(read_ahead_ > 0 ? read_ahead_ : 2*jobs);
+	string name;
+	while( next_name(name) )
+	{
+		Item item = read(name);
+		unique_lock<mutex> guard(lock_);
+		while( queue_.size() >= ahead ) taken_.wait(guard);
+		queue_.push_back(item);
+		queued_.notify_one();
+	}
+	
+	lock_guard<mutex> guard(lock_);
+	done_ = 1;
+	queued_.notify_all();
+}
+
+// The loop of a counting thread.  Each count runs on threads/jobs threads.
+void Short_Cycle_Batch::count_all( int job, ostream* out )
+{
+	Short_Cycle_Thread_Pool probe(threads_);
+	int n_threads = probe.threads();
+	int jobs = (jobs_ > 0 ? jobs_ : n_threads);
+	int share = n_threads/jobs+(job < n_threads%jobs ? 1 : 0);
+	
+	Short_Cycle_Counter counter;
+	counter.set_threads(share > 0 ? share : 1);
+	counter.set_pool(&pool_);
+	for( ;; )
+	{
+		Item item;
+		{
+			unique_lock<mutex> guard(lock_);
+			while( queue_.empty() && !done_ ) queued_.wait(guard);
+			if( queue_.empty() ) return;
+			item = queue_.front();
+			queue_.pop_front();
+			taken_.notify_one();
+		}
+		
+		// The line is written under out_lock_; the count is not.
+		ostringstream line;
+		int ok = count(counter,item,line);
+		lock_guard<mutex> guard(out_lock_);
+		*out << line.str() << flush;
+		if( !ok ) 
+		{
+			lock_guard<mutex> count_guard(lock_);
+			errors_++;
+		}
+	}
+}
+
+#else
+
+int Short_Cycle_Batch::run( ostream& out )
+{
+	Short_Cycle_Counter counter;
+	counter.set_threads(threads_);
+	int errors = 0;
+	string name;
+	while( next_name(name) )
+	{
+		Item item = read(name);
+		if( !count(counter,item,out) ) errors++;
+	}
+	
+	return errors;
+}
+
+#endif
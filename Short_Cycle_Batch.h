@@ -0,0 +1,129 @@
+/* Short_Cycle_Batch.h
+
+   Copyright (c) 2005 Thomas R. Halford 
+   All rights reserved.
+ 
+   Developed by: Thomas R. Halford
+                 Communication Sciences Institute
+                 University of Southern California
+                 http://csi.usc.edu
+ 
+   Permission is hereby granted, free of charge, to any person obtaining a copy 
+   of this software and associated documentation files (the "Software"), to deal 
+   with the Software without restriction, including without limitation the rights 
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+   copies of the Software, and to permit persons to whom the Software is furnished 
+   to do so, subject to the following conditions:
+  
+    * Redistributions of source code must retain the above copyright notice, this 
+      list of conditions and the following disclaimers.
+    * Redistributions in binary form must reproduce the above copyright notice, 
+      this list of conditions and the following disclaimers in the documentation 
+      and/or other materials provided with the distribution.
+    * Neither the names of Thomas R. Halford, the Communication Sciences Institute, 
+      the University of Southern California nor the names of its contributors may 
+      be used to endorse or promote products derived from this Software without 
+      specific prior written permission. 
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+   INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+   PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE CONTRIBUTORS OR 
+   COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN 
+   AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION 
+   WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE SOFTWARE.
+*/
+
+
+// Short_Cycle_Batch.h counts the short cycles of many graphs in one
+// process.  An I/O thread reads the alist and MatrixMarket files, or maps
+// the binary ones (see Short_Cycle_Sparse_Matrix.h), ahead of the counts
+// into a queue of bounded length.  jobs counters, each with its own thread
+// pool, take the graphs from the queue and count them; a counter keeps
+// its per vertex arrays and shares one matrix buffer pool with the
+// others, so graphs of equal size allocate nothing after the first.
+// Each result is written as soon as its count finishes, one line per
+// graph:
+//
+//   name <tab> girth <tab> N_g <tab> N_{g+2} <tab> N_{g+4}
+//
+// followed by <tab>inexact if a count may exceed 2^64, or name <tab>error
+// if the file cannot be read.  Without threads (see SCM_THREADS in
+// Short_Cycle_Pool.h) the graphs are read and counted in turn.
+
+#ifndef SHORT_CYCLE_BATCH
+#define SHORT_CYCLE_BATCH
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Short_Cycle_Pool.h"
+
+#if SCM_THREADS
+#include <condition_variable>
+#include <deque>
+#endif
+
+class Short_Cycle_Sparse_Matrix;
+class Short_Cycle_Counter;
+
+class Short_Cycle_Batch
+{
+  public:
+	Short_Cycle_Batch( void );
+	
+	// The inputs, counted in the order added.  add_directory() adds every
+	// file in dirname that is not hidden, in name order, and returns 0 if
+	// the directory cannot be read.  The file names of a stream, one per
+	// line, are read as the batch runs, so a stream may be a pipe from a
+	// process that is still producing graphs.
+	void add_file( const std::string& filename );
+	int add_directory( const std::string& dirname );
+	void add_stream( std::istream& names );
+	
+	// jobs graphs are counted at once by threads/jobs threads each.  0,
+	// the default, uses one thread per hardware thread and as many jobs.
+	void set_jobs( int jobs ) { jobs_ = jobs; };
+	void set_threads( int n_threads ) { threads_ = n_threads; };
+	
+	// Number of graphs read ahead of the counts (default 2*jobs).
+	void set_read_ahead( int graphs ) { read_ahead_ = graphs; };
+	
+	// Count every input, writing the results to out.  Returns the number of
+	// inputs that could not be read.
+	int run( std::ostream& out );
+	
+  private:
+	struct Item
+	{
+		std::string name;
+		Short_Cycle_Sparse_Matrix* E;  // NULL if the file cannot be read.
+	};
+	
+	int next_name( std::string& name );   // 0 once the inputs are exhausted.
+	Item read( const std::string& name );
+	int count( Short_Cycle_Counter& counter, Item& item, std::ostream& out );
+	
+	std::vector<std::string> files_;
+	std::vector<std::istream*> streams_;
+	size_t next_file_, next_stream_;
+	int jobs_, threads_, read_ahead_;
+	Short_Cycle_Pool pool_;		// Shared by the counters.
+	
+#if SCM_THREADS
+	void read_all( void );		// The I/O thread.
+	void count_all( int job, std::ostream* out );
+	
+	std::mutex lock_;			// Guards the members below.
+	std::condition_variable queued_, taken_;
+	std::deque<Item> queue_;
+	int done_;					// Set when every input has been read.
+	int errors_;
+	std::mutex out_lock_;
+#endif
+
+	// Not copyable.
+	Short_Cycle_Batch( const Short_Cycle_Batch& );
+	Short_Cycle_Batch& operator=( const Short_Cycle_Batch& );
+};
+
+#endif
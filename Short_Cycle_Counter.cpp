@@ -34,1036 +34,359 @@
 */
 
 #include <math.h>
-// NOTE: Location of cblas.h is machine dependent.
-//#include "openblas/cblas.h"
-#include "vecLib/cblas.h"
+#include <algorithm>
+#include <string.h>
 #include "Short_Cycle_Counter.h"
+#include "Short_Cycle_Engine.h"
 
 // Constructors.
 Short_Cycle_Counter::Short_Cycle_Counter( void ) 
- : U_(0), W_(0), g_(4), Ng_(0), Ng2_(0), Ng4_(0),  
-   Ng_per_u_(NULL), Ng2_per_u_(NULL), Ng4_per_u_(NULL)
+ : U_(0), W_(0), dU_(0), dW_(0), g_(4), Ng_(0), Ng2_(0), Ng4_(0), exact_(1), rows_(0), counted_(0), lo_(0), top_(0),
+   Ng_per_u_(NULL), Ng2_per_u_(NULL), Ng4_per_u_(NULL), 
+   Ng_per_w_(NULL), Ng2_per_w_(NULL), Ng4_per_w_(NULL), shared_(NULL)
 {
 	return;
 } 
 
-Short_Cycle_Counter::Short_Cycle_Counter( const Short_Cycle_Matrix& E )
+Short_Cycle_Counter::Short_Cycle_Counter( const Short_Cycle_Matrix<double>& E )
+ : U_(0), W_(0), dU_(0), dW_(0), g_(4), Ng_(0), Ng2_(0), Ng4_(0), exact_(1), rows_(0), counted_(0), lo_(0), top_(0),
+   Ng_per_u_(NULL), Ng2_per_u_(NULL), Ng4_per_u_(NULL), 
+   Ng_per_w_(NULL), Ng2_per_w_(NULL), Ng4_per_w_(NULL), shared_(NULL)
+{
+	initialize(E);
+}	
+
+Short_Cycle_Counter::Short_Cycle_Counter( const Short_Cycle_Sparse_Matrix& E )
+ : U_(0), W_(0), dU_(0), dW_(0), g_(4), Ng_(0), Ng2_(0), Ng4_(0), exact_(1), rows_(0), counted_(0), lo_(0), top_(0),
+   Ng_per_u_(NULL), Ng2_per_u_(NULL), Ng4_per_u_(NULL), 
+   Ng_per_w_(NULL), Ng2_per_w_(NULL), Ng4_per_w_(NULL), shared_(NULL)
 {
 	initialize(E);
 }	
 	
-void Short_Cycle_Counter::initialize( const Short_Cycle_Matrix& E )
+// The incidence matrix is stored in sparse form by the counter.
+void Short_Cycle_Counter::initialize( const Short_Cycle_Matrix<double>& E )
 {
-	U_   = E.e_nr();
-	W_   = E.e_nc();
-	g_   = 1000000;
-	Ng_  = 0;
-	Ng2_ = 0;
-	Ng4_ = 0;
-	Ng_per_u_  = new double[U_];
-	memset(Ng_per_u_,0,U_*sizeof(double));
-	Ng2_per_u_ = new double[U_];
-	memset(Ng_per_u_,0,U_*sizeof(double));
-	Ng4_per_u_ = new double[U_];
-	memset(Ng_per_u_,0,U_*sizeof(double));
+	SCSM E_sparse;
+	E_sparse.compress(E);
+	initialize(E_sparse);
+}
+
+void Short_Cycle_Counter::initialize( const Short_Cycle_Sparse_Matrix& E )
+{
+	reset(E.e_nr(),E.e_nc());
 	E_   = E;
 	ET_.transpose(E_);
+	find_degrees();
 }
 
-Short_Cycle_Counter::~Short_Cycle_Counter( void )
+// E and E^T are used in place in the mapped file.
+int Short_Cycle_Counter::read_binary_file( const char* filename )
 {
-	if( Ng_per_u_ )  delete [] Ng_per_u_;
-	if( Ng2_per_u_ ) delete [] Ng2_per_u_;
-	if( Ng4_per_u_ ) delete [] Ng4_per_u_;
+	SCSM E, ET;
+	if( !E.map_binary_file(filename) || !ET.map_binary_file(filename,1) ) return 0;
+	
+	reset(E.e_nr(),E.e_nc());
+	E_.swap(E);
+	ET_.swap(ET);
+	find_degrees();
+	return 1;
 }
 
-// The main counting method.  Different counting helper
-// methods are called depending on the girth.
-void Short_Cycle_Counter::count( void )
+// Clear the counts for a graph with |U| = U and |W| = W.
+void Short_Cycle_Counter::reset( int U, int W )
 {
-	g_   = 1000000;
-	Ng_  = 0;
-	Ng2_ = 0;
-	Ng4_ = 0;
-	// Count 4 cycles first to determine girth.
-	if( count_four_cycles() )
+	// The per vertex arrays are kept if U is unchanged.  Pooled matrix
+	// buffers are only of use for graphs of the same dimensions.
+	if( U != U_ || W != W_ ) pool_.trim();
+	if( U != U_ || Ng_per_u_ == NULL )
 	{
-		// girth == 4
-		count_six_eight_cycles();
+		delete [] Ng_per_u_;
+		delete [] Ng2_per_u_;
+		delete [] Ng4_per_u_;
+		Ng_per_u_  = new double[U];
+		Ng2_per_u_ = new double[U];
+		Ng4_per_u_ = new double[U];
 	}
 	
-	else
+	if( W != W_ || Ng_per_w_ == NULL )
 	{
-		// Count 6 and 8 cycles to determine the girth.
-		count_six_eight_cycles();
-		if( g_ == 6 )
-		{
-			Ng_  = L_U_0_6_.int_trace()/6;
-			L_U_0_6_.diagonal(Ng_per_u_);
-			
-			Ng2_ = L_U_0_8_.int_trace()/8;
-			L_U_0_8_.diagonal(Ng2_per_u_);
-		
-			// Count the 10 cycles with girth = 6.
-			count_ten_cycles_g_6();			
-			Ng4_ = L_U_0_g4_.int_trace()/10;
-			L_U_0_g4_.diagonal(Ng4_per_u_);
-		}
-		
-		else if( g_ == 8 )
-		{
-			Ng_ = L_U_0_8_.int_trace()/8;
-			L_U_0_8_.diagonal(Ng_per_u_);
-			// Count 10 and 12 cycles when the girth = 8.
-			count_ten_cycles_g_6(); 
-			count_twelve_cycles_g_8();
-			Ng2_ = L_U_0_g2_.int_trace()/10;
-			L_U_0_g2_.diagonal(Ng2_per_u_);
-			Ng4_ = L_U_0_g4_.int_trace()/12;
-			L_U_0_g4_.diagonal(Ng4_per_u_);
-		}
-		
-		else count_longer_cycles();
+		delete [] Ng_per_w_;
+		delete [] Ng2_per_w_;
+		delete [] Ng4_per_w_;
+		Ng_per_w_  = new double[W];
+		Ng2_per_w_ = new double[W];
+		Ng4_per_w_ = new double[W];
 	}
-
-}
-
-// Returns 1 if the girth is 4, 0 otherwise.
-int Short_Cycle_Counter::count_four_cycles( void )
-{
-	// Compute P_U_2, P_W_2, L_U_0_2_m1, L_W_0_2_m1, 
-	// L_U_0_2_m2, L_W_0_2_m2, P_U_2_c2, and P_W_2_c2
-	// simulataneously for speed.
-	process_P_U_2();
-	process_P_W_2();
 	
-	// Compute L_U_1_2 and L_W_1_2.
-	L_U_1_2_.matrix_mult(E_,L_W_0_2_m1_);
-	L_W_1_2_.matrix_mult(ET_,L_U_0_2_m1_);
-
-	// Compute P_U_3, P_W_3.
-	P_U_3_.matrix_mult(P_U_2_,E_);
-	P_U_3_ -= L_U_1_2_;
-	P_W_3_.transpose(P_U_3_);
-															
-	// Compute L_U_0_4, L_W_0_4.
-	L_U_0_4_.mx_mult_diag(P_U_3_,ET_);
-	L_W_0_4_.mx_mult_diag(P_W_3_,E_);
-
-	int temp = L_U_0_4_.int_trace();
-	if( temp == 0 ) return 0;
-	else
-	{
-		g_  = 4;
-		Ng_ = temp/4;
-		L_U_0_4_.diagonal(Ng_per_u_);
-		return 1;
-	}
+	U_   = U;
+	W_   = W;
+	g_   = 1000000;
+	Ng_  = 0;
+	Ng2_ = 0;
+	Ng4_ = 0;
+	exact_ = 1;
+	counted_ = 0;
+	top_ = 0;
+	memset(Ng_per_u_,0,U_*sizeof(double));
+	memset(Ng2_per_u_,0,U_*sizeof(double));
+	memset(Ng4_per_u_,0,U_*sizeof(double));
+	memset(Ng_per_w_,0,W_*sizeof(double));
+	memset(Ng2_per_w_,0,W_*sizeof(double));
+	memset(Ng4_per_w_,0,W_*sizeof(double));
 }
 
-void Short_Cycle_Counter::count_six_eight_cycles( void )
+// The maximum vertex degrees are needed by walk_bound().
+void Short_Cycle_Counter::find_degrees( void )
 {
-	// Compute L_U_2_2, L_W_2_2.
-	L_U_2_2_.mx_mult_zero(E_,L_W_1_2_);
-	L_W_2_2_.mx_mult_zero(ET_,L_U_1_2_);
-	
-	// Comput P_U_4, P_W_4.
-	P_U_4_.matrix_mult(P_U_3_,ET_); 
-	P_U_4_ -= L_U_0_4_; 
-	P_U_4_ -= L_U_2_2_;
-	
-	P_W_4_.matrix_mult(P_W_3_,E_);  
-	P_W_4_ -= L_W_0_4_; 
-	P_W_4_ -= L_W_2_2_;
-	
-	// Compute L_U_1_4, L_W_1_4.
-	L_U_1_4_.matrix_mult(E_,L_W_0_4_);  
-	L_U_temp_ = P_U_3_*E_;
-	L_U_1_4_ -= L_U_temp_;
-	L_U_1_4_ -= L_U_temp_;
-	
-	L_W_1_4_.matrix_mult(ET_,L_U_0_4_); 
-	L_W_temp_ = P_W_3_*ET_;
-	L_W_1_4_ -= L_W_temp_;
-	L_W_1_4_ -= L_W_temp_;
-	
-	// Compute L_U_3_2, L_W_3_2.
-	L_U_3_2_.matrix_mult(P_U_3_,L_W_0_2_m1_); 
-	L_U_3_2_ -= L_U_temp_;
-	
-	L_W_3_2_.matrix_mult(P_W_3_,L_U_0_2_m1_); 
-	L_W_3_2_ -= L_W_temp_;
-	
-	// Compute P_U_5, P_W_5.  
-	P_U_5_.matrix_mult(P_U_4_,E_);  
-	P_U_5_ -= L_U_1_4_; 
-	P_U_5_ -= L_U_3_2_; 
-	
-	P_W_5_.transpose(P_U_5_); 
-	
-	// Compute L_U_0_6, L_W_0_6.
-	L_U_0_6_.mx_mult_diag(P_U_5_,ET_);
-	L_W_0_6_.mx_mult_diag(P_W_5_,E_);
-	
-	int temp = L_U_0_6_.int_trace();
-	if( g_ == 4 ) 
+	dU_ = dW_ = 0;
+	for( int rr = 0; rr < U_; rr++ )
 	{
-		Ng2_ = temp/6; 
-		L_U_0_6_.diagonal(Ng2_per_u_);
+		int d = E_.row_ptr()[rr+1]-E_.row_ptr()[rr];
+		if( d > dU_ ) dU_ = d;
 	}
 	
-	else if( temp > 0 ) g_ = 6;
-	
-	// Compute L_U_2_4, L_W_2_4.
-	L_U_2_4_.mx_mult_zero(E_,L_W_1_4_);  
-	if( g_ == 4 ) 
+	for( int cc = 0; cc < W_; cc++ )
 	{
-		L_U_temp_ = P_U_2_.mx_choose_3(6.0);
-		L_U_2_4_ -= L_U_temp_;
-	}
-	
-	L_W_1_4_.delete_data();
-	
-	L_W_2_4_.mx_mult_zero(ET_,L_U_1_4_); 
-	if( g_ == 4 ) 
-	{
-		L_W_temp_ = P_W_2_.mx_choose_3(6.0);
-		L_W_2_4_ -= L_W_temp_;
-	}
-
-	// Compute L_U_4_2, L_W_4_2.
-	L_U_4_2_.mx_mult_zero(E_,L_W_3_2_);  
-	L_U_temp_.matrix_mult(L_U_0_2_m1_,L_U_2_2_); 
-	L_U_4_2_ -= L_U_temp_; 
-	if( g_ == 4 )
-	{
-		L_U_4_2_ += P_U_2_c2_;
-		L_U_4_2_ += P_U_2_c2_;
-	}
-	
-	L_U_2_2_.delete_data();
-	
-	L_W_4_2_.mx_mult_zero(ET_,L_U_3_2_); 
-	L_W_temp_.matrix_mult(L_W_0_2_m1_,L_W_2_2_); 
-	L_W_4_2_ -= L_W_temp_; 
-	if( g_ == 4 )
-	{
-		L_W_4_2_ += P_W_2_c2_;
-		L_W_4_2_ += P_W_2_c2_;
-	}
-	
-	L_W_2_2_.delete_data();
-	
-	// Compute P_U_6, P_W_6.
-	P_U_6_.matrix_mult(P_U_5_,ET_); 
-	P_U_6_ -= L_U_0_6_; 
-	P_U_6_ -= L_U_2_4_; 
-	P_U_6_ -= L_U_4_2_;
-	L_U_2_4_.delete_data();
-	
-	P_W_6_.matrix_mult(P_W_5_,E_); 
-	P_W_6_ -= L_W_0_6_; 
-	P_W_6_ -= L_W_2_4_; 
-	P_W_6_ -= L_W_4_2_;
-		
-	// Compute L_U_1_6, L_W_1_6.
-	L_U_1_6_.matrix_mult(E_,L_W_0_6_); 
-	L_U_temp_  = P_U_5_;
-	L_U_temp_ *= E_;
-	L_U_temp_ *= 2.0;
-	L_U_1_6_  -= L_U_temp_;
-	if( g_ == 4 )
-	{
-		L_U_temp_  = P_U_3_.mx_choose_2(2.0);
-		L_U_temp_ *= E_;
-		L_U_1_6_  -= L_U_temp_;
-		L_U_temp_.matrix_mult(P_U_2_c2_,E_);
-		L_U_temp_ -= P_U_3_;
-		L_U_temp_ *= E_;
-		L_U_temp_ *= 2.0;
-		L_U_1_6_  += L_U_temp_;
-		L_U_temp_.matrix_mult(E_,P_W_2_c2_);
-		L_U_temp_ -= P_U_3_;
-		L_U_temp_ *= E_;
-		L_U_temp_ *= 2.0;
-		L_U_1_6_  += L_U_temp_;
+		int d = ET_.row_ptr()[cc+1]-ET_.row_ptr()[cc];
+		if( d > dW_ ) dW_ = d;
 	}
+}
 
-	L_W_1_6_.matrix_mult(ET_,L_U_0_6_); 
-	L_W_temp_  = P_W_5_;
-	L_W_temp_ *= ET_;
-	L_W_temp_ *= 2.0;
-	L_W_1_6_  -= L_W_temp_;
-	if( g_ == 4 )
-	{
-		L_W_temp_  = P_W_3_.mx_choose_2(2.0);
-		L_W_temp_ *= ET_;
-		L_W_1_6_  -= L_W_temp_;
-		L_W_temp_.matrix_mult(P_W_2_c2_,ET_);
-		L_W_temp_ -= P_W_3_;
-		L_W_temp_ *= ET_;
-		L_W_temp_ *= 2.0;
-		L_W_1_6_  += L_W_temp_;
-		L_W_temp_.matrix_mult(ET_,P_U_2_c2_);
-		L_W_temp_ -= P_W_3_;
-		L_W_temp_ *= ET_;
-		L_W_temp_ *= 2.0;
-		L_W_1_6_  += L_W_temp_;
-	}
+Short_Cycle_Counter::~Short_Cycle_Counter( void )
+{
+	if( Ng_per_u_ )  delete [] Ng_per_u_;
+	if( Ng2_per_u_ ) delete [] Ng2_per_u_;
+	if( Ng4_per_u_ ) delete [] Ng4_per_u_;
+	if( Ng_per_w_ )  delete [] Ng_per_w_;
+	if( Ng2_per_w_ ) delete [] Ng2_per_w_;
+	if( Ng4_per_w_ ) delete [] Ng4_per_w_;
+}
 
-	// Compute L_U_3_4.
-	if( g_ == 4 )
+// The main counting method.  The girth is found first by girth_.  32 bit
+// elements are used when all of the counts read, i.e., those of length
+// up to max(g,8)+4, are bounded below 2^32.  The engine abandons the
+// count if one exceeds the bound, in which case it is repeated in 64
+// bits.  The engine matrices are allocated from (and returned to) pool_,
+// or the shared pool, which is made current on the calling thread and,
+// by threads_, on the workers of the engine.
+void Short_Cycle_Counter::count( void )
+{
+	Short_Cycle_Pool* prev = Short_Cycle_Pool::use(shared_ ? shared_ : &pool_);
+	exact_ = 1;
+	memset(Ng_per_u_,0,U_*sizeof(double));
+	memset(Ng2_per_u_,0,U_*sizeof(double));
+	memset(Ng4_per_u_,0,U_*sizeof(double));
+	Ng_per_edge_.assign(E_.nnz(),0.0);
+	Ng2_per_edge_.assign(E_.nnz(),0.0);
+	Ng4_per_edge_.assign(E_.nnz(),0.0);
+	girth_.compute(E_,ET_,&threads_);
+	
+	int done = 0;
+	int k = (girth_.girth() > 8 && girth_.girth() < 1000000 ? girth_.girth() : 8)+4;
+	if( walk_bound(k) < ldexp(1.0,32) )
 	{
-		L_U_3_4_.matrix_mult(E_,L_W_2_4_); 
-		L_U_temp_.matrix_mult(L_U_0_2_m1_,L_U_1_4_); 
-		L_U_3_4_  -= L_U_temp_;
-		L_U_temp_  = P_U_3_.mx_choose_2(4.0);
-		L_U_temp_ *= E_;
-		L_U_3_4_  -= L_U_temp_;
-		L_U_temp_.matrix_mult(P_U_2_c2_,E_);
-		L_U_temp_ -= P_U_3_;
-		L_U_temp_ *= E_;
-		L_U_temp_ *= 4.0;
-		L_U_3_4_  += L_U_temp_;
-		L_U_temp_.matrix_mult(E_,P_W_2_c2_);
-		L_U_temp_ -= P_U_3_;
-		L_U_temp_ *= E_;
-		L_U_temp_ *= 6.0;
-		L_U_3_4_  += L_U_temp_;
+		Short_Cycle_Engine<uint32_t> engine(*this);
+		done = engine.count();
 	}
 	
-	else{ L_U_3_4_ = L_U_1_4_; } // Both 0 if g_ > 4.
-	
-	L_U_1_4_.delete_data();
-
-	// Compute L_U_5_2 and L_W_5_2.
-	L_U_5_2_.matrix_mult(E_,L_W_4_2_);
-	L_U_temp_.matrix_mult(L_U_0_2_m1_,L_U_3_2_);
-	L_U_5_2_ -= L_U_temp_;
-	L_U_temp_ = P_U_5_*E_;
-	L_U_5_2_ -= L_U_temp_;
-	if( g_ == 4 )
+	if( !done )
 	{
-		L_U_temp_  = P_U_3_*E_;
-		L_U_5_2_  += L_U_temp_;
-		L_U_5_2_  += L_U_temp_; 
-		L_U_temp_.matrix_mult(L_U_0_4_,L_U_1_2_);
-		L_U_5_2_  -= L_U_temp_;
-		L_U_temp_  = L_U_3_2_*E_;
-		L_U_5_2_  += L_U_temp_;
-		L_W_temp_.matrix_mult(P_U_3_,L_W_0_2_m2_);
-		L_U_temp_  = L_W_temp_*E_;
-		L_U_5_2_  += L_U_temp_;
-		L_U_5_2_  += L_U_temp_;
-		L_W_temp_.matrix_mult(P_U_2_c2_,E_);
-		L_W_temp_ -= P_U_3_;
-		L_U_temp_  = L_W_temp_*E_;
-		L_U_5_2_  += L_U_temp_;
-		L_U_5_2_  += L_U_temp_;
+		Short_Cycle_Engine<uint64_t> engine(*this);
+		engine.count();
 	}
+	
+	Short_Cycle_Pool::use(prev);
+	sum_edges();
+	counted_ = 1;
+	top_ = 0;
+}
 
-	P_U_2_c2_.delete_data(); 
+// A closed non-backtracking walk of length k is fixed by its first k-1
+// steps, of which there are at most dU*(dW-1)*(dU-1)*(dW-1)*...
+double Short_Cycle_Counter::walk_bound( int k ) const
+{
+	double bound = dU_;
+	for( int ss = 2; ss < k; ss++ ) bound *= (ss%2 == 0 ? dW_-1 : dU_-1);
+	return bound;
+}
 
-	L_W_5_2_.matrix_mult(ET_,L_U_4_2_);
-	L_W_temp_.matrix_mult(L_W_0_2_m1_,L_W_3_2_);
-	L_W_5_2_ -= L_W_temp_;
-	L_W_temp_ = P_W_5_*ET_;
-	L_W_5_2_ -= L_W_temp_;
-	if( g_ == 4 )
-	{
-		L_W_temp_.matrix_mult(L_W_0_4_,L_W_1_2_);
-		L_W_5_2_  -= L_W_temp_;
-		L_W_temp_  = L_W_3_2_;
-		L_U_temp_.matrix_mult(P_W_3_,L_U_0_2_m2_);
-		L_W_temp_ += L_U_temp_;
-		L_W_temp_ += L_U_temp_;
-		L_U_temp_.matrix_mult(P_W_2_,ET_);
-		L_W_temp_ += L_U_temp_;
-		L_W_temp_ += L_U_temp_;
-		L_W_5_2_  += L_W_temp_;	
-	}	
-	
-	P_W_2_c2_.delete_data();
-	
-	// Compute P_U_7 and P_W_7.
-	P_U_7_.matrix_mult(P_U_6_,E_); 
-	P_U_7_ -= L_U_1_6_; 
-	P_U_7_ -= L_U_3_4_; 
-	P_U_7_ -= L_U_5_2_;	
-	L_U_3_4_.delete_data();
-	
-	P_W_7_.transpose(P_U_7_);
-	
-	// Compute L_U_0_8 and L_W_0_8.
-	L_U_0_8_.mx_mult_diag(P_U_7_,ET_);
-	L_W_0_8_.mx_mult_diag(P_W_7_,E_);
+// The mean and standard deviation of the n elements of x.
+static void mx_dist( const double* x, int n, double* mu, double* sdev )
+{
+	double t = 0.0;
+	for( int ii = 0; ii < n; ii++ ) t += x[ii];
+	*mu = t/(n+0.0);
 	
-	temp = L_U_0_8_.int_trace();
-	if( g_ == 4 ) 
+	t = *sdev = 0.0;
+	for( int jj = 0; jj < n; jj++ )
 	{
-		Ng4_ = temp/8;
-		L_U_0_8_.diagonal(Ng4_per_u_);
+		t += x[jj]-*mu;
+		*sdev += (x[jj]-*mu)*(x[jj]-*mu); 
 	}
 	
-	else if( temp && g_ != 6 ) g_ = 8;	 
+	*sdev = sqrt((*sdev-t*t/(n+0.0))/(n-1.0));
 }
 
-void Short_Cycle_Counter::count_ten_cycles_g_6( void )
-{	
-	L_U_0_4_.delete_data(); 
-	L_W_0_4_.delete_data();
-
-	// Compute L_U_2_6, L_W_2_6.
-	L_U_2_g_.mx_mult_zero(E_,L_W_1_6_);
-	L_W_2_g_.mx_mult_zero(ET_,L_U_1_6_);
-
-	// Compute L_U_6_2, L_W_6_2.
-	L_U_g_2_.mx_mult_zero(E_,L_W_5_2_);  
-	L_U_temp_.matrix_mult(L_U_0_2_m1_,L_U_4_2_); 
-	L_U_g_2_ -= L_U_temp_;
-	L_U_temp_ = P_U_4_*P_U_2_; 
-	L_U_g_2_ += L_U_temp_;
-	L_U_4_2_.delete_data(); 
-	P_U_4_.delete_data();
-	
-	L_W_g_2_.mx_mult_zero(ET_,L_U_5_2_);  
-	L_W_temp_.matrix_mult(L_W_0_2_m1_,L_W_4_2_); 
-	L_W_g_2_ -= L_W_temp_;
-	L_W_temp_ = P_W_4_*P_W_2_; 
-	L_W_g_2_ += L_W_temp_;
-	L_W_4_2_.delete_data();  
-	P_W_4_.delete_data(); 
-	
-	// Compute P_U_8.
-	P_U_g2_.matrix_mult(P_U_7_,ET_); 
-	P_U_g2_ -= L_U_0_8_; 
-	P_U_g2_ -= L_U_2_g_; 
-	P_U_g2_ -= L_U_g_2_;
-
-	// Compute L_U_1_8.
-	L_U_1_g2_.matrix_mult(E_,L_W_0_8_);  
-	L_U_temp_ = 2.0*P_U_7_; L_U_temp_ *= E_;  
-	L_U_1_g2_ -= L_U_temp_;
-	
-	// Compute L_U_3_6.
-	L_U_3_g_.matrix_mult(E_,L_W_2_g_); 
-	L_U_temp_.matrix_mult(L_U_0_2_m1_,L_U_1_6_); 
-	L_U_3_g_ -= L_U_temp_; 
-	L_U_temp_ = P_U_3_.mx_choose_3(6.0);
-	L_U_3_g_ -= L_U_temp_;
-	P_U_3_.delete_data();
-	L_U_1_6_.delete_data(); 
-
-	// Compute L_U_7_2.
-	L_U_g1_2_.matrix_mult(E_,L_W_g_2_); 
-	L_U_temp_ = P_U_7_*E_; 
-	L_U_g1_2_ -= L_U_temp_; 
-	L_U_temp_ = L_U_5_2_*E_; 
-	L_U_g1_2_ += L_U_temp_;
-	L_U_temp_.matrix_mult(L_U_0_2_m1_,L_U_5_2_); 
-	L_U_g1_2_ -= L_U_temp_; 
-	L_U_temp_.matrix_mult(L_U_0_6_,L_U_1_2_); 
-	L_U_g1_2_ -= L_U_temp_;
-	L_U_temp_ = 2.0*P_U_5_; 
-	L_U_temp_ *= E_; 
-	L_U_g1_2_ += L_U_temp_; 
-	L_U_temp_.matrix_mult(P_U_5_,L_W_0_2_m2_);
-	L_U_temp_ *= 2.0; 
-	L_U_temp_ *= E_;
-	L_U_g1_2_ += L_U_temp_;
-	L_U_5_2_.delete_data();
-	P_U_5_.delete_data();
-
-	// Compute P_U_9.
-	P_U_g3_.matrix_mult(P_U_g2_,E_); 
-	P_U_g3_ -= L_U_1_g2_; 
-	P_U_g3_ -= L_U_3_g_; 
-	P_U_g3_ -= L_U_g1_2_;
-
-	// Compute L_U_0_10.
-	L_U_0_g4_.mx_mult_diag(P_U_g3_,ET_);
+void Short_Cycle_Counter::cycle_dist( double* mu_g,  double* sdev_g, 
+									  double* mu_g2, double* sdev_g2,
+									  double* mu_g4, double* sdev_g4 )
+{
+	mx_dist(Ng_per_u_,U_,mu_g,sdev_g);
+	mx_dist(Ng2_per_u_,U_,mu_g2,sdev_g2);
+	mx_dist(Ng4_per_u_,U_,mu_g4,sdev_g4);
 }
 
-// Count 12 cycles when the girth is known to be 8.
-void Short_Cycle_Counter::count_twelve_cycles_g_8( void )
+void Short_Cycle_Counter::cycle_dist_w( double* mu_g,  double* sdev_g, 
+										double* mu_g2, double* sdev_g2,
+										double* mu_g4, double* sdev_g4 )
 {
-	L_U_0_6_.delete_data();
-	// Compute the matrices that weren't computed in count_ten_cycles_g_6().
-	P_W_7_.transpose(P_U_7_);
-
-	P_W_g2_.matrix_mult(P_W_7_,E_); 
-	P_W_g2_ -= L_W_0_8_; 
-	P_W_g2_ -= L_W_2_g_; 
-	P_W_g2_ -= L_W_g_2_;
-	L_W_1_g2_.matrix_mult(ET_,L_U_0_8_);
-	//THIS LINE CAUSES ERROR, SPLITTING INTO TWO LINES FIXES IT, INVESTIGATE LATER?
-	//L_W_temp_ = 2.0*P_W_7_; 
-	L_W_temp_ = P_W_7_;
-	L_W_temp_ *= 2.0; 
-	L_W_temp_ *= ET_;
-	L_W_1_g2_ -= L_W_temp_;
-	L_W_g1_2_.matrix_mult(ET_,L_U_g_2_); 
-	L_W_temp_ = P_W_7_*ET_; 
-	L_W_g1_2_ -= L_W_temp_; 
-	L_W_temp_ = L_W_5_2_*ET_; 
-	L_W_g1_2_ += L_W_temp_;
-	L_W_temp_.matrix_mult(L_W_0_2_m1_,L_W_5_2_); 
-	L_W_g1_2_ -= L_W_temp_; 
-	L_W_temp_.matrix_mult(L_W_0_6_,L_W_1_2_); 
-	L_W_g1_2_ -= L_W_temp_;
-	L_W_temp_ = 2.0*P_W_5_; 
-	L_W_temp_ *= ET_; 
-	L_W_g1_2_ += L_W_temp_; 
-	L_W_temp_.matrix_mult(P_W_5_,L_U_0_2_m2_);
-	L_W_temp_ *= 2.0; 
-	L_W_temp_ *= ET_; 
-	L_W_g1_2_ += L_W_temp_;
-	L_W_0_6_.delete_data();
-	P_W_7_.delete_data();
-	L_W_1_2_.delete_data();
-	P_W_5_.delete_data(); 
-	L_U_0_2_m2_.delete_data();
-	L_W_3_g_.matrix_mult(ET_,L_U_2_g_); 
-	L_W_temp_.matrix_mult(L_W_0_2_m1_,L_W_1_6_);
-	L_W_3_g_ -= L_W_temp_;
-	L_W_temp_ = P_W_3_.mx_choose_3(6.0); 
-	L_W_3_g_ -= L_W_temp_;
-	P_W_g3_.matrix_mult(P_W_g2_,ET_); 
-	P_W_g3_ -= L_W_1_g2_; 
-	P_W_g3_ -= L_W_3_g_; 
-	P_W_g3_ -= L_W_g1_2_;
-	L_W_0_g4_.mx_mult_diag(P_W_g3_,E_);
-	P_W_g2_.delete_data();
-	L_W_1_6_.delete_data();
-	// Copy the needed matrices from count_ten_cycles_g_6() results.
-	P_U_g1_    = P_U_g3_;
-	P_W_g1_    = P_W_g3_;
-	L_U_0_g2_  = L_U_0_g4_;
-	L_W_0_g2_  = L_W_0_g4_;
-	L_U_gm2_2_ = L_U_g_2_;
-	L_W_gm2_2_ = L_W_g_2_; 
-	L_U_gm1_2_ = L_U_g1_2_;
-	L_W_gm1_2_ = L_W_g1_2_;
-	L_U_1_g_   = L_U_1_g2_;
-	L_W_1_g_   = L_W_1_g2_;
-	
-	P_W_g3_.delete_data(); 
-	L_W_g1_2_.delete_data(); 
-	L_W_1_g2_.delete_data(); 
-	L_W_0_g4_.delete_data();
-
-	// Compute L_U_2_8, L_W_2_8.
-	L_U_2_g_.mx_mult_zero(E_,L_W_1_g_);
-	
-	L_W_2_g_.mx_mult_zero(ET_,L_U_1_g_);
-	L_W_1_g_.delete_data();
-
-	// Compute L_U_8_2, L_W_8_2.
-	L_U_g_2_.mx_mult_zero(E_,L_W_gm1_2_);  
-	L_U_temp_.matrix_mult(L_U_0_2_m1_,L_U_gm2_2_); 
-	L_U_g_2_ -= L_U_temp_;
-	L_U_temp_ = P_U_6_*P_U_2_; 
-	L_U_g_2_ += L_U_temp_;
-	L_W_gm1_2_.delete_data();
-	L_U_gm2_2_.delete_data();
-	P_U_2_.delete_data();
-	P_U_6_.delete_data();
-	
-	L_W_g_2_.mx_mult_zero(ET_,L_U_gm1_2_);  
-	L_W_temp_.matrix_mult(L_W_0_2_m1_,L_W_gm2_2_); 
-	L_W_g_2_ -= L_W_temp_;
-	L_W_temp_ = P_W_6_*P_W_2_; 
-	L_W_g_2_ += L_W_temp_;
-	L_W_0_2_m1_.delete_data();  
-	L_W_gm2_2_.delete_data();
-	P_W_2_.delete_data();  
-	P_W_6_.delete_data(); 
-	
-	// Compute P_U_10.
-	P_U_g2_.matrix_mult(P_U_g1_,ET_); 
-	P_U_g2_ -= L_U_0_g2_; 
-	P_U_g2_ -= L_U_2_g_; 
-	P_U_g2_ -= L_U_g_2_;
-	L_U_2_g_.delete_data(); 
-	L_U_g_2_.delete_data(); 
-	
-	// Compute L_U_1_10.
-	L_U_1_g2_.matrix_mult(E_,L_W_0_g2_);  
-	L_U_temp_ = 2.0*P_U_g1_; 
-	L_U_temp_ *= E_;  
-	L_U_1_g2_ -= L_U_temp_;
-	L_W_0_g2_.delete_data(); 
-
-	// Compute L_U_3_8.
-	L_U_3_g_.matrix_mult(E_,L_W_2_g_);  
-	L_U_temp_.matrix_mult(L_U_0_2_m1_,L_U_1_g_); 
-	L_U_3_g_ -= L_U_temp_; 
-	L_W_2_g_.delete_data(); 
-	L_U_1_g_.delete_data();
-
-	// Compute L_U_9_2.
-	L_U_g1_2_.matrix_mult(E_,L_W_g_2_); 
-	L_U_temp_ = P_U_g1_*E_; 
-	L_U_g1_2_ -= L_U_temp_; 
-	L_U_temp_ = L_U_gm1_2_*E_; 
-	L_U_g1_2_ += L_U_temp_;
-	L_U_temp_.matrix_mult(L_U_0_2_m1_,L_U_gm1_2_); 
-	L_U_g1_2_ -= L_U_temp_; 
-	L_U_temp_.matrix_mult(L_U_0_8_,L_U_1_2_); 
-	L_U_g1_2_ -= L_U_temp_;
-	L_U_temp_ = 2.0*P_U_7_; 
-	L_U_temp_ *= E_; 
-	L_U_g1_2_ += L_U_temp_; 
-	L_U_temp_.matrix_mult(P_U_7_,L_W_0_2_m2_);
-	L_U_temp_ *= 2.0; 
-	L_U_temp_ *= E_; 
-	L_U_g1_2_ += L_U_temp_;
-	L_W_g_2_.delete_data(); 
-	P_U_g1_.delete_data(); 
-	L_U_gm1_2_.delete_data(); 
-	L_U_0_2_m1_.delete_data();
-	L_U_1_2_.delete_data(); 
-	P_U_7_.delete_data(); 
-	L_W_0_2_m2_.delete_data(); 
-
-	// Compute P_U_11.
-	P_U_g3_.matrix_mult(P_U_g2_,E_); 
-	P_U_g3_ -= L_U_1_g2_; 
-	P_U_g3_ -= L_U_3_g_; 
-	P_U_g3_ -= L_U_g1_2_;
-	P_U_g2_.delete_data(); 
-	L_U_1_g2_.delete_data(); 
-	L_U_3_g_.delete_data(); 
-	L_U_g1_2_.delete_data(); 
-
-	// Compute L_U_0_12.
-	L_U_0_g4_.mx_mult_diag(P_U_g3_,ET_);
-	P_U_g3_.delete_data();
+	mx_dist(Ng_per_w_,W_,mu_g,sdev_g);
+	mx_dist(Ng2_per_w_,W_,mu_g2,sdev_g2);
+	mx_dist(Ng4_per_w_,W_,mu_g4,sdev_g4);
 }
 
-// Assumes that count_six_eight_cycles has been called.
-void Short_Cycle_Counter::count_longer_cycles( void )
+int Short_Cycle_Counter::add_edge( int u, int w )
 {
-	int temp;
-	
-	// Set the maximum girth.
-	int max_girth = 2*(U_ > W_ ? U_ : W_);
-	g_ = max_girth+2;
-	
-	// Free as much memory as possible.  Memory is freed for all matrices
-	// not longer needed.
-	L_U_0_2_m2_.delete_data(); 
-	L_W_1_2_.delete_data(); 
-	L_U_0_4_.delete_data(); 
-	L_W_0_4_.delete_data(); 
-	P_U_4_.delete_data(); 
-	P_W_4_.delete_data();
-	P_U_5_.delete_data();
-	P_W_5_.delete_data(); 
-	L_U_0_6_.delete_data(); 
-	L_W_0_6_.delete_data();
-	P_U_6_.delete_data(); 
-	P_W_6_.delete_data(); 
-	L_U_1_6_.delete_data(); 
-	L_W_1_6_.delete_data();
-	L_U_0_8_.delete_data(); 
-	L_W_0_8_.delete_data();
-	
-	// Starting with the assumption that g_ = 10, initialize the
-	// search for the girth.
-	
-	// Compute L_U_6_2, L_W_6_2.  L_U_4_2, L_W_4_2 not needed after this.
-	L_U_gm4_2_.matrix_mult(E_,L_W_5_2_);  
-	L_U_temp_.matrix_mult(L_U_0_2_m1_,L_U_4_2_); 
-	L_U_gm4_2_ -= L_U_temp_;
-	L_U_4_2_.delete_data(); 
-	
-	L_W_gm4_2_.matrix_mult(ET_,L_U_5_2_); 
-	L_W_temp_.matrix_mult(L_W_0_2_m1_,L_W_4_2_); 
-	L_W_gm4_2_ -= L_W_temp_;
-	L_W_4_2_.delete_data();
+	if( u < 0 || u >= U_ || w < 0 || w >= W_ || E_.find(u,w) >= 0 ) return 0;
+	keep_counts();
+	E_.insert(u,w);
+	ET_.insert(w,u);
+	move_edges(E_.find(u,w),1);
+	update(u,w,1);
+	return 1;
+}
 
-	// Compute P_U_8, P_W_8.  P_U_7, P_W_7 not needed after this.
-	P_U_gm2_.matrix_mult(P_U_7_,ET_); 
-	P_U_gm2_ -= L_U_gm4_2_;
-	P_U_7_.delete_data();
-	
-	P_W_gm2_.matrix_mult(P_W_7_,E_);  
-	P_W_gm2_ -= L_W_gm4_2_;
-	P_W_7_.delete_data();
+int Short_Cycle_Counter::remove_edge( int u, int w )
+{
+	if( u < 0 || u >= U_ || w < 0 || w >= W_ || E_.find(u,w) < 0 ) return 0;
+	keep_counts();
+	move_edges(E_.find(u,w),-1);
+	E_.erase(u,w);
+	ET_.erase(w,u);
+	update(u,w,-1);
+	return 1;
+}
 
-	// Compute L_U_7_2, L_W_7_2.  L_U_5_2, L_W_5_2 not needed after this.
-	L_U_gm3_2_.matrix_mult(E_,L_W_gm4_2_);  
-	L_U_temp_.matrix_mult(L_U_0_2_m1_,L_U_5_2_); 
-	L_U_gm3_2_ -= L_U_temp_;
-	L_U_5_2_.delete_data();
-	
-	L_W_gm3_2_.matrix_mult(ET_,L_U_gm4_2_); 
-	L_W_temp_.matrix_mult(L_W_0_2_m1_,L_W_5_2_); 
-	L_W_gm3_2_ -= L_W_temp_;
-	L_W_5_2_.delete_data();
-	
-	// Compute P_U_9, P_W_9.
-	P_U_gm1_.matrix_mult(P_U_gm2_,E_);  
-	P_U_gm1_ -= L_U_gm3_2_;
-	
-	P_W_gm1_.matrix_mult(P_W_gm2_,ET_); 
-	P_W_gm1_ -= L_W_gm3_2_;
-	
-	// Search for the girth.
-	for( int gtry = 10; gtry <= max_girth; gtry += 2 )
+// Keep the counts of the last count() for update(), once.  An acyclic
+// graph has a single length, 1000000, kept.
+void Short_Cycle_Counter::keep_counts( void )
+{
+	if( !counted_ || !exact_ || top_ > 0 ) return;
+	int n = (g_ < 1000000 ? 3 : 1);
+	lo_  = g_;
+	top_ = (g_ < 1000000 ? g_+4 : g_);
+	N_len_.assign(n,0);
+	per_u_len_.assign(n*(size_t)U_,0.0);
+	per_edge_len_.assign(n*(size_t)E_.nnz(),0.0);
+	if( n == 1 ) return;
+	
+	int64_t N[3] = { Ng_, Ng2_, Ng4_ };
+	double* per_u[3] = { Ng_per_u_, Ng2_per_u_, Ng4_per_u_ };
+	std::vector<double>* per_edge[3] = { &Ng_per_edge_, &Ng2_per_edge_, &Ng4_per_edge_ };
+	for( int kk = 0; kk < 3; kk++ )
 	{
-		// Assume g_ = grty and calculate L_U_0_g_, L_W_0_g_.
-		L_U_0_g_.mx_mult_diag(P_U_gm1_,ET_);
-		L_W_0_g_.mx_mult_diag(P_W_gm1_,E_);
-		
-		if( temp = L_U_0_g_.int_trace() )
-		{
-			// Cycles of length gtry exist.
-			g_  = gtry;
-			Ng_ = temp/g_;
-			L_U_0_g_.diagonal(Ng_per_u_);
-
-			// The following no longer needed.
-			P_U_gm3_.delete_data(); 
-			P_W_gm3_.delete_data(); 
-			L_U_gm6_2_.delete_data();
-			L_W_gm6_2_.delete_data(); 
-			L_U_gm5_2_.delete_data(); 
-			L_W_gm5_2_.delete_data();
-			
-			break; 
-		}
-		
-		else
-		{
-			// Prepare for next recursion by updating P_U_gm1_, P_W_gm1_, P_U_gm2_, P_W_gm2_.
-			L_U_gm6_2_ = L_U_gm4_2_;
-			L_W_gm6_2_ = L_W_gm4_2_;
-			L_U_gm5_2_ = L_U_gm3_2_;
-			L_W_gm5_2_ = L_W_gm3_2_;
-			P_U_gm3_   = P_U_gm1_;
-			P_W_gm3_   = P_W_gm1_;
-		
-			// Compute L_U_gm4_2, L_W_gm4_2.
-			L_U_gm4_2_.matrix_mult(E_,L_W_gm5_2_);  
-			L_U_temp_.matrix_mult(L_U_0_2_m1_,L_U_gm6_2_); 
-			L_U_gm4_2_ -= L_U_temp_;
-		
-			L_W_gm4_2_.matrix_mult(ET_,L_U_gm5_2_); 
-			L_W_temp_.matrix_mult(L_W_0_2_m1_,L_W_gm6_2_); 
-			L_W_gm4_2_ -= L_W_temp_;
-		
-			// Compute P_U_gm2, P_W_gm2.
-			P_U_gm2_.matrix_mult(P_U_gm3_,ET_); 
-			P_U_gm2_ -= L_U_gm4_2_;
-		
-			P_W_gm2_.matrix_mult(P_W_gm3_,E_);  
-			P_W_gm2_ -= L_W_gm4_2_;
-
-			// Compute L_U_gm3_2, L_W_gm3_2.
-			L_U_gm3_2_.matrix_mult(E_,L_W_gm4_2_);  
-			L_U_temp_.matrix_mult(L_U_0_2_m1_,L_U_gm5_2_); 
-			L_U_gm3_2_ -= L_U_temp_;
-			
-			L_W_gm3_2_.matrix_mult(ET_,L_U_gm4_2_); 
-			L_W_temp_.matrix_mult(L_W_0_2_m1_,L_W_gm5_2_); 
-			L_W_gm3_2_ -= L_W_temp_;
-	
-			// Compute P_U_gm1, P_W_gm1.
-			P_U_gm1_.matrix_mult(P_U_gm2_,E_);  
-			P_U_gm1_ -= L_U_gm3_2_;
-			
-			P_W_gm1_.matrix_mult(P_W_gm2_,ET_); 
-			P_W_gm1_ -= L_W_gm3_2_;		
-		}
+		N_len_[kk] = N[kk];
+		memcpy(&per_u_len_[kk*(size_t)U_],per_u[kk],U_*sizeof(double));
+		std::copy(per_edge[kk]->begin(),per_edge[kk]->end(),per_edge_len_.begin()+kk*(size_t)E_.nnz());
 	}
-	
-	// Check if g > max_girth.  If so, this must be
-	// a tree so set g_ to 1000000 and exit.
-	if( g_ == max_girth+2 )
+}
+
+// The edge at position pos of E_ is added (sign 1) or about to be
+// removed (-1); the per edge counts kept for each length move with the
+// edges after it.
+void Short_Cycle_Counter::move_edges( int pos, int sign )
+{
+	if( top_ == 0 ) return;
+	int nnz = E_.nnz()-(sign > 0);
+	for( int kk = (int)N_len_.size()-1; kk >= 0; kk-- )
 	{
-		g_ = 1000000;
-		Ng_ = Ng2_ = Ng4_ = 0;
-		return;
+		std::vector<double>::iterator at = per_edge_len_.begin()+kk*(size_t)nnz+pos;
+		if( sign > 0 ) per_edge_len_.insert(at,0.0);
+		else per_edge_len_.erase(at);
 	}
+}
 
-	// If g = max_girth then there can be no cycles
-	// of length g+2 or g+4.
-	else if( g_ == max_girth )
+// The cycles made or broken by the edge are those through it.  They are
+// counted up to length top_ in the graph with the edge, after which the
+// girth is the shortest length with a cycle.  The first edge to close a
+// cycle, of length c, in an acyclic graph sets lo_ to c and top_ to c+4.
+void Short_Cycle_Counter::update( int u, int w, int sign )
+{
+	find_degrees();
+	if( !counted_ ) return;
+	if( !exact_ ) 
 	{
-		Ng2_ = Ng4_ = 0;
+		count();
 		return;
 	}
 	
-	// Compute Ng2 via L_U_0_g2.
-	
-	// Compute L_U_gm2_2, L_W_gm2_2.  L_U_gm4_2, L_W_gm4_2 no longer needed.
-	L_U_gm2_2_.matrix_mult(E_,L_W_gm3_2_);  
-	L_U_temp_.matrix_mult(L_U_0_2_m1_,L_U_gm4_2_); 
-	L_U_gm2_2_ -= L_U_temp_; 
-	L_U_gm4_2_.delete_data();
-	
-	L_W_gm2_2_.matrix_mult(ET_,L_U_gm3_2_); 
-	L_W_temp_.matrix_mult(L_W_0_2_m1_,L_W_gm4_2_); 
-	L_W_gm2_2_ -= L_W_temp_; 
-	L_W_gm4_2_.delete_data();
-	
-	// Compute P_U_g, P_W_g.
-	P_U_g_.matrix_mult(P_U_gm1_,ET_); 
-	P_U_g_ -= L_U_0_g_; 
-	P_U_g_ -= L_U_gm2_2_;
-	
-	P_W_g_.matrix_mult(P_W_gm1_,E_);  
-	P_W_g_ -= L_W_0_g_; 
-	P_W_g_ -= L_W_gm2_2_;
-	
-	// Compute L_U_1_g, L_W_1_g.  L_W_0_g_ is no longer needed.
-	L_U_1_g_.matrix_mult(E_,L_W_0_g_);  
-	L_U_temp_ = 2.0*P_U_gm1_; 
-	L_U_temp_ *= E_; 
-	L_U_1_g_ -= L_U_temp_;
-	
-	L_W_1_g_.matrix_mult(ET_,L_U_0_g_); 
-	L_W_temp_ = 2.0*P_W_gm1_; 
-	L_W_temp_ *= ET_; 
-	L_W_1_g_ -= L_W_temp_;
-	L_W_0_g_.delete_data();
-	
-	// Compute L_U_gm1_2, L_W_gm1_2.  L_U_gm3_2, L_W_gm3_2, P_W_gm1
-	// are no longer needed.
-	L_U_gm1_2_.matrix_mult(E_,L_W_gm2_2_); 
-	L_U_temp_ = P_U_gm1_*E_; 
-	L_U_gm1_2_ -= L_U_temp_;
-	L_U_temp_.matrix_mult(L_U_0_2_m1_,L_U_gm3_2_);
-	L_U_gm1_2_ -= L_U_temp_;
-	L_U_gm3_2_.delete_data();
-	
-	L_W_gm1_2_.matrix_mult(ET_,L_U_gm2_2_); 
-	L_W_temp_ = P_W_gm1_*ET_; 
-	L_W_gm1_2_ -= L_W_temp_;
-	L_W_temp_.matrix_mult(L_W_0_2_m1_,L_W_gm3_2_); 
-	L_W_gm1_2_ -= L_W_temp_;
-	P_W_gm1_.delete_data(); 
-	L_W_gm3_2_.delete_data();
-
-	// Compute P_U_g1, P_W_g1.  P_U_g, P_W_g no longer needed.
-	P_U_g1_.matrix_mult(P_U_g_,E_);  
-	P_U_g1_ -= L_U_1_g_; 
-	P_U_g1_ -= L_U_gm1_2_;
-	P_U_g_.delete_data(); 
-	
-	P_W_g1_.matrix_mult(P_W_g_,ET_); 
-	P_W_g1_ -= L_W_1_g_; 
-	P_W_g1_ -= L_W_gm1_2_;
-	P_W_g_.delete_data();
-	
-	// Compute L_U_0_g2, L_W_0_g2.  P_W_g1 no longer needed.
-	L_U_0_g2_.mx_mult_diag(P_U_g1_,ET_);
-	L_W_0_g2_.mx_mult_diag(P_W_g1_,E_);
-	P_W_g1_.delete_data();
-	
-	Ng2_ = L_U_0_g2_.int_trace()/(g_+2);
-	L_U_0_g2_.diagonal(Ng2_per_u_);
-	
-	// If g = max_girth-2, there can exist no
-	// cycles of length g+4 so exit.
-	if( g_ == max_girth-2 )
+	int nnz = E_.nnz();
+	int c = paths_.shortest(E_,ET_,u,w,(top_ < 1000000 ? top_ : 2*(U_ < W_ ? U_ : W_)));
+	if( c > 0 && top_ == 1000000 )
 	{
-		Ng4_ = 0;
-		return;
+		lo_  = c;
+		top_ = c+4;
+		N_len_.assign(3,0);
+		per_u_len_.assign(3*(size_t)U_,0.0);
+		per_edge_len_.assign(3*(size_t)nnz,0.0);
 	}
 	
-	// Compute Ng4 via L_U_0_g4.  Free memory ASAP.
-	
-	// Compute L_U_2_g, L_W_2_g.
-	L_U_2_g_.mx_mult_zero(E_,L_W_1_g_);
-	L_W_2_g_.mx_mult_zero(ET_,L_U_1_g_);	
-	L_W_1_g_.delete_data();
-	
-	// Compute L_U_g_2, L_W_g_2.
-	L_U_g_2_.mx_mult_zero(E_,L_W_gm1_2_); 
-	L_U_temp_ = P_U_gm2_*P_U_2_; 
-	L_U_g_2_ += L_U_temp_;
-	L_U_temp_.matrix_mult(L_U_0_2_m1_,L_U_gm2_2_); 
-	L_U_g_2_ -= L_U_temp_;
-	P_U_2_.delete_data(); 
-	P_U_gm2_.delete_data();
-	L_W_gm1_2_.delete_data(); 
-	L_U_gm2_2_.delete_data();
-	
-	L_W_g_2_.mx_mult_zero(ET_,L_U_gm1_2_); 
-	L_W_temp_ = P_W_gm2_*P_W_2_; 
-	L_W_g_2_ += L_W_temp_;
-	L_W_temp_.matrix_mult(L_W_0_2_m1_,L_W_gm2_2_); 
-	L_W_g_2_ -= L_W_temp_;
-	P_W_2_.delete_data(); 
-	P_W_gm2_.delete_data(); 
-	L_W_0_2_m1_.delete_data(); 
-	L_W_gm2_2_.delete_data();
-
-	// Compute P_U_g2.
-	P_U_g2_.matrix_mult(P_U_g1_,ET_); 
-	P_U_g2_ -= L_U_0_g2_; 
-	P_U_g2_ -= L_U_2_g_; 
-	P_U_g2_ -= L_U_g_2_;
-	L_U_2_g_.delete_data();
-	
-	// Compute L_U_1_g2.
-	L_U_1_g2_.matrix_mult(E_,L_W_0_g2_); 
-	L_U_temp_ = 2.0*P_U_g1_; 
-	L_U_temp_ *= E_; 
-	L_U_1_g2_ -= L_U_temp_;
-	L_W_0_g2_.delete_data(); 
-	
-	// Compute L_U_3_g.
-	L_U_3_g_.matrix_mult(E_,L_W_2_g_); 
-	L_U_temp_.matrix_mult(L_U_0_2_m1_,L_U_1_g_); 
-	L_U_3_g_ -= L_U_temp_;
-	L_W_2_g_.delete_data(); 
-	L_U_1_g_.delete_data();
-	
-	// Compute L_U_g1_2.
-	L_U_g1_2_.matrix_mult(E_,L_W_g_2_); 
-	L_U_temp_ = P_U_g1_*E_; 
-	L_U_g1_2_ -= L_U_temp_; 
-	L_U_temp_ = L_U_gm1_2_*E_; 
-	L_U_g1_2_ += L_U_temp_; 
-	L_U_temp_.matrix_mult(L_U_0_2_m1_,L_U_gm1_2_); 
-	L_U_g1_2_ -= L_U_temp_;
-	L_U_temp_.matrix_mult(L_U_0_g_,L_U_1_2_); 
-	L_U_g1_2_ -= L_U_temp_; 
-	L_U_temp_ = 2.0*P_U_gm1_; 
-	L_U_temp_ *= E_;
-	L_U_g1_2_ += L_U_temp_; 
-	L_U_temp_.matrix_mult(P_U_gm1_,L_W_0_2_m2_); 
-	L_U_temp_ *= 2.0; 
-	L_U_temp_ *= E_;
-	L_U_g1_2_ += L_U_temp_;
-	L_U_0_2_m1_.delete_data();
-	L_W_0_2_m2_.delete_data();
-	L_U_1_2_.delete_data();
-	L_W_g_2_.delete_data(); 
-	P_U_g1_.delete_data();
-	L_U_gm1_2_.delete_data(); 
-	P_U_gm1_.delete_data(); 
-	
-	// Compute P_U_g3.
-	P_U_g3_.matrix_mult(P_U_g2_,E_); 
-	P_U_g3_ -= L_U_1_g2_; 
-	P_U_g3_ -= L_U_3_g_; 
-	P_U_g3_ -= L_U_g1_2_;
-	P_U_g2_.delete_data(); 
-	L_U_1_g2_.delete_data(); 
-	L_U_3_g_.delete_data(); 
-	L_U_g1_2_.delete_data();
-	
-	// Compute L_U_0_g4.
-	L_U_0_g4_.mx_mult_diag(P_U_g3_,ET_);
-	P_U_g3_.delete_data();
-	
-	Ng4_ = L_U_0_g4_.int_trace()/(g_+4);
-	L_U_0_g4_.diagonal(Ng4_per_u_);
-}
-
-void Short_Cycle_Counter::process_P_U_2( void )
-{
-	P_U_2_.matrix_mult(E_,ET_);
-	
-	P_U_2_c2_.copy_size(P_U_2_);
-	L_U_0_2_m1_.copy_size(P_U_2_);
-	L_U_0_2_m2_.copy_size(P_U_2_);
-	
-	P_U_2_c2_.reset_data();
-	L_U_0_2_m1_.reset_data();
-	L_U_0_2_m2_.reset_data();	
-				
-	for( int rr = 0, oo = 0; rr < P_U_2_.i_nr(); rr++, oo += P_U_2_.i_nc() )
+	else if( c > 0 && c < lo_ )
 	{
-		for( int cc = 0, pp = oo; cc < P_U_2_.i_nc(); cc++, pp++ )
-		{
-			double val = P_U_2_[pp];
-			if( val > 1 ) P_U_2_c2_.set_el(pp,val*(val-1.0)/2.0);
-
-			if( rr == cc )
-			{
-				P_U_2_.set_el(pp,0); P_U_2_c2_.set_el(pp,0);
-				if( val > 1 )
-				{
-					L_U_0_2_m1_.set_el(pp,val-1.0);
-					if( val > 2 ) L_U_0_2_m2_.set_el(pp,val-2.0);
-				} 				
-			}
-		}
+		// Shorter lengths are inserted before the others, with counts 0.
+		int more = (lo_-c)/2;
+		N_len_.insert(N_len_.begin(),more,0);
+		per_u_len_.insert(per_u_len_.begin(),more*(size_t)U_,0.0);
+		per_edge_len_.insert(per_edge_len_.begin(),more*(size_t)nnz,0.0);
+		lo_ = c;
 	}
-}
-
-void Short_Cycle_Counter::process_P_W_2( void )
-{
-	P_W_2_.matrix_mult(ET_,E_);
 	
-	P_W_2_c2_.copy_size(P_W_2_);
-	L_W_0_2_m1_.copy_size(P_W_2_);
-	L_W_0_2_m2_.copy_size(P_W_2_);
+	if( c > 0 ) paths_.count(lo_,top_,&N_len_[0],&per_u_len_[0],&per_edge_len_[0],sign);
+	if( top_ == 1000000 )
+	{
+		Ng_per_edge_.assign(nnz,0.0);
+		Ng2_per_edge_.assign(nnz,0.0);
+		Ng4_per_edge_.assign(nnz,0.0);
+		sum_edges();
+		return;
+	}
 	
-	P_W_2_c2_.reset_data();
-	L_W_0_2_m1_.reset_data();
-	L_W_0_2_m2_.reset_data();	
-				
-	for( int rr = 0, oo = 0; rr < P_W_2_.i_nr(); rr++, oo += P_W_2_.i_nc() )
+	int kk = 0;
+	while( lo_+2*kk <= top_ && N_len_[kk] == 0 ) kk++;
+	if( lo_+2*kk+4 > top_ )
 	{
-		for( int cc = 0, pp = oo; cc < P_W_2_.i_nc(); cc++, pp++ )
-		{
-			double val = P_W_2_[pp];
-			if( val > 1 )
-			{
-				P_W_2_c2_.set_el(pp,val*(val-1.0)/2.0);
-			}
-
-			if( rr == cc )
-			{
-				P_W_2_.set_el(pp,0); P_W_2_c2_.set_el(pp,0);
-				if( val > 1 )
-				{
-					L_W_0_2_m1_.set_el(pp,val-1.0);
-					if( val > 2 ) L_W_0_2_m2_.set_el(pp,val-2.0);
-				} 				
-			}
-		}
+		count();
+		return;
 	}
+	
+	g_   = lo_+2*kk;
+	Ng_  = N_len_[kk];
+	Ng2_ = N_len_[kk+1];
+	Ng4_ = N_len_[kk+2];
+	memcpy(Ng_per_u_,&per_u_len_[kk*(size_t)U_],U_*sizeof(double));
+	memcpy(Ng2_per_u_,&per_u_len_[(kk+1)*(size_t)U_],U_*sizeof(double));
+	memcpy(Ng4_per_u_,&per_u_len_[(kk+2)*(size_t)U_],U_*sizeof(double));
+	
+	std::vector<double>::const_iterator first = per_edge_len_.begin()+kk*(size_t)nnz;
+	Ng_per_edge_.assign(first,first+nnz);
+	Ng2_per_edge_.assign(first+nnz,first+2*nnz);
+	Ng4_per_edge_.assign(first+2*nnz,first+3*nnz);
+	sum_edges();
 }
 
-void Short_Cycle_Counter::cycle_dist( double* mu_g,  double* sdev_g, 
-									  double* mu_g2, double* sdev_g2,
-									  double* mu_g4, double* sdev_g4 )
+// A cycle through w takes two of its edges, so the sum over the edges of
+// w counts it twice, as on the diagonal of L_{(0,k)}^\mathcal{W}.
+void Short_Cycle_Counter::sum_edges( void )
 {
-	// Compute the means.
-	double t_g = 0.0, t_g2 = 0.0, t_g4 = 0.0;
-	for( int ii = 0; ii < U_; ii++ )
+	memset(Ng_per_w_,0,W_*sizeof(double));
+	memset(Ng2_per_w_,0,W_*sizeof(double));
+	memset(Ng4_per_w_,0,W_*sizeof(double));
+	const int* col_idx = E_.col_idx();
+	for( int pp = 0; pp < E_.nnz(); pp++ )
 	{
-		t_g  += Ng_per_u_[ii];
-		t_g2 += Ng2_per_u_[ii];
-		t_g4 += Ng4_per_u_[ii];
+		Ng_per_w_[col_idx[pp]]  += Ng_per_edge_[pp];
+		Ng2_per_w_[col_idx[pp]] += Ng2_per_edge_[pp];
+		Ng4_per_w_[col_idx[pp]] += Ng4_per_edge_[pp];
 	}
-	
-	*mu_g  = t_g/(U_+0.0);
-	*mu_g2 = t_g2/(U_+0.0);
-	*mu_g4 = t_g4/(U_+0.0);
-	
-	// Compute the standard deviations.
-	t_g = t_g2 = t_g4 = *sdev_g = *sdev_g2 = *sdev_g4 = 0.0;
-	for( int jj = 0; jj < U_; jj++ )
-	{
-		t_g  += Ng_per_u_[jj]-*mu_g;
-		t_g2 += Ng2_per_u_[jj]-*mu_g2;
-		t_g4 += Ng4_per_u_[jj]-*mu_g4;
-
-		*sdev_g  += (Ng_per_u_[jj]-*mu_g)*(Ng_per_u_[jj]-*mu_g); 
-		*sdev_g2 += (Ng2_per_u_[jj]-*mu_g2)*(Ng2_per_u_[jj]-*mu_g2);
-		*sdev_g4 += (Ng4_per_u_[jj]-*mu_g4)*(Ng4_per_u_[jj]-*mu_g4);
-	}
-
-	*sdev_g  = sqrt((*sdev_g-t_g*t_g/(U_+0.0))/(U_-1.0));
-	*sdev_g2 = sqrt((*sdev_g2-t_g2*t_g2/(U_+0.0))/(U_-1.0));
-	*sdev_g4 = sqrt((*sdev_g4-t_g4*t_g4/(U_+0.0))/(U_-1.0));
-}
\ No newline at end of file
+}
@@ -36,28 +36,63 @@
 // Short_Cycle_Counter.h implements the short cycle counting
 // algorithm described in Halford and Chugg's paper
 // "An Algorithm for Counting Short Cycles in Bipartite Graphs".
+// The matrix recursions are carried out by Short_Cycle_Engine using
+// 32 bit unsigned elements when every count that is read out is bounded
+// below 2^32, and 64 bit elements otherwise.
 
 #ifndef SHORT_CYCLE_COUNTER
 #define SHORT_CYCLE_COUNTER
 
+#include <stdint.h>
+#include <vector>
 #include "Short_Cycle_Matrix.h"
+#include "Short_Cycle_Sparse_Matrix.h"
+#include "Short_Cycle_Pool.h"
+#include "Short_Cycle_Tasks.h"
+#include "Short_Cycle_Girth.h"
+#include "Short_Cycle_Paths.h"
 
-typedef Short_Cycle_Matrix SCM;
+typedef Short_Cycle_Sparse_Matrix SCSM;
+
+template <class T> class Short_Cycle_Engine;
 
 class Short_Cycle_Counter
 {
   public:
 	// Constructors.
 	Short_Cycle_Counter( void );
-	Short_Cycle_Counter( const Short_Cycle_Matrix& E );
+	Short_Cycle_Counter( const Short_Cycle_Matrix<double>& E );
+	Short_Cycle_Counter( const Short_Cycle_Sparse_Matrix& E );
 	~Short_Cycle_Counter( void );
-	void initialize( const Short_Cycle_Matrix& E );
+	
+	// A counter may be initialized any number of times.  The matrix
+	// buffers of one count are pooled and reused by the next as long as
+	// the graph dimensions are unchanged.
+	void initialize( const Short_Cycle_Matrix<double>& E );
+	void initialize( const Short_Cycle_Sparse_Matrix& E );
+	
+	// Initialize from a binary Tanner graph file without copying it (see
+	// Short_Cycle_Sparse_Matrix.h).  Returns 0, leaving the counter
+	// unchanged, if the file is not one.
+	int read_binary_file( const char* filename );
 
 	// Accessors for girth and number cycles.
-	int girth( void ) { return g_;   };
-	int Ng( void )    { return Ng_;  };
-	int Ng2( void )   { return Ng2_; };
-	int Ng4( void )   { return Ng4_; };
+	int girth( void )    { return g_;   };
+	int64_t Ng( void )   { return Ng_;  };
+	int64_t Ng2( void )  { return Ng2_; };
+	int64_t Ng4( void )  { return Ng4_; };
+	
+	// The number of cycles of length g, g+2 and g+4 through each edge,
+	// in the order of the nonzeros of the incidence matrix, i.e., that of
+	// the edge (u,w) is at position p of E.row_ptr()[u] <= p <
+	// E.row_ptr()[u+1] with E.col_idx()[p] == w.  Set by count() and kept
+	// up to date by add_edge() and remove_edge().
+	const std::vector<double>& Ng_per_edge( void ) const  { return Ng_per_edge_;  };
+	const std::vector<double>& Ng2_per_edge( void ) const { return Ng2_per_edge_; };
+	const std::vector<double>& Ng4_per_edge( void ) const { return Ng4_per_edge_; };
+	
+	// Returns 0 if some count could exceed 2^64 and may be wrong.
+	int exact( void )    { return exact_; };
 	
 	// Compute the mean and standard deviation of the
 	// cycle 
@@ -65,27 +100,99 @@ class Short_Cycle_Counter
 					 double* mu_g2, double* sdev_g2,
 					 double* mu_g4, double* sdev_g4 );
 	
+	// The same over the vertices of W.
+	void cycle_dist_w( double* mu_g,  double* sdev_g, 
+					   double* mu_g2, double* sdev_g2,
+					   double* mu_g4, double* sdev_g4 );
+	
+	// The counts per vertex of U (|U| elements) and of W (|W| elements)
+	// from which the distributions are found.  Like the diagonals of
+	// L_{(0,k)}, they count each cycle through a vertex twice, once in
+	// each direction.
+	const double* Ng_per_u( void ) const  { return Ng_per_u_;  };
+	const double* Ng2_per_u( void ) const { return Ng2_per_u_; };
+	const double* Ng4_per_u( void ) const { return Ng4_per_u_; };
+	const double* Ng_per_w( void ) const  { return Ng_per_w_;  };
+	const double* Ng2_per_w( void ) const { return Ng2_per_w_; };
+	const double* Ng4_per_w( void ) const { return Ng4_per_w_; };
+	
 	// Count cycles of length g, g+2 and g+4.  This method
 	// determines g.
 	void count( void );
 	
+	// Add or remove the edge between vertex u of U and vertex w of W.
+	// After a count() the girth and counts are updated from the cycles
+	// through the edge alone (see Short_Cycle_Paths).  The counts of the
+	// lengths from the girth of the last count() up to 4 more are kept,
+	// with those of any shorter lengths added since, so an edge that is
+	// added and then removed costs two local searches.  The graph is
+	// counted again if a removal raises the girth g to where g+4 is beyond
+	// the lengths kept, or if the counts are inexact.  Each returns 0, and
+	// changes nothing, if the edge is already present (absent) or out of
+	// range.
+	int add_edge( int u, int w );
+	int remove_edge( int u, int w );
+	
+	// The number of threads used by count().  0, the default, uses one
+	// thread per hardware thread.
+	void set_threads( int n_threads ) { threads_.set_threads(n_threads); };
+	int threads( void ) const { return threads_.threads(); };
+	
+	// Limit the RAM held by the matrices of count() to about bytes, 0 (the
+	// default) for no limit.  Beyond it matrices are mapped from scratch
+	// files in directory dir (TMPDIR or /tmp if NULL) and paged to disk.
+	void set_memory_budget( size_t bytes, const char* dir = NULL ) { pool_.set_budget(bytes,dir); };
+	
+	// Allocate the matrices of count() from pool, e.g., one shared by
+	// counters running in parallel, instead of the counter's own pool.
+	// NULL, the default, restores the counter's pool.
+	void set_pool( Short_Cycle_Pool* pool ) { shared_ = pool; };
+	
+	// Form the rows of the U side matrices of the last stage of count(),
+	// which gives N_{g+4} per vertex in U, rows at a time.  The blocks
+	// run in parallel and bound the memory of that stage by about
+	// rows*|U| elements per matrix.  0, the default, forms whole matrices.
+	void set_block_rows( int rows ) { rows_ = (rows > 0 ? rows : 0); };
+	int block_rows( void ) const { return rows_; };
+	
+	// How the girth is found before the recursions; see Short_Cycle_Girth.
+	void set_girth_method( Short_Cycle_Girth::Method method ) { girth_.set_method(method); };
+	
+	// An upper bound on the diagonal elements of L_{(0,k)}^\mathcal{U},
+	// i.e., on the number of non-backtracking walks of length k-1
+	// leaving a vertex in U.
+	double walk_bound( int k ) const;
+	
   private:
-	// Cycle counting helpers.  
-	void process_P_U_2( void );
-	void process_P_W_2( void );
-
-	int  count_four_cycles( void );
-	void count_six_eight_cycles( void );
-	void count_ten_cycles_g_6( void );
-	void count_twelve_cycles_g_8( void );
-	void count_longer_cycles( void );
+	void reset( int U, int W );				   // For a new graph.
+	void find_degrees( void );				   // dU_ and dW_.
+	void keep_counts( void );				   // Before an edge is changed.
+	void move_edges( int pos, int sign );
+	void update( int u, int w, int sign );	   // After an edge is changed.
+	void sum_edges( void );					   // The counts per vertex of W.
+	
+	template <class T> friend class Short_Cycle_Engine;
 	
 	int U_;				// |\mathcal{U}|
 	int W_;				// |\mathcal{W}|
+	int dU_;			// Maximum degree in \mathcal{U}
+	int dW_;			// Maximum degree in \mathcal{W}
 	int g_;				// girth
-	int Ng_;			// N_g
-	int Ng2_;			// N_{g+2}
-	int Ng4_;			// N_{g+4}
+	int64_t Ng_;		// N_g
+	int64_t Ng2_;		// N_{g+2}
+	int64_t Ng4_;		// N_{g+4}
+	int exact_;			// Cleared if a count may have overflowed.
+	int rows_;			// See set_block_rows().
+	int counted_;		// Set once the counts are those of E_.
+	
+	// The counts of cycles of lengths lo_, lo_+2, ..., top_, in all, per
+	// vertex in U and per edge (|U| and nnz elements per length), kept by
+	// update().  None are shorter than lo_.  top_ is 0 until update()
+	// first needs them.
+	int lo_, top_;
+	std::vector<int64_t> N_len_;
+	std::vector<double> per_u_len_;
+	std::vector<double> per_edge_len_;
 	
 	// Vectors that store the number of cycles of length
 	// g, g+2 and g+4 incident on each vertex in U.
@@ -93,63 +200,28 @@ class Short_Cycle_Counter
 	double* Ng2_per_u_;
 	double* Ng4_per_u_;
 	
-	// Matrices required by the cycle counter.  Note that
-	// the memory required by each matrix is allocated only when
-	// the matrix is first required and freed as soon as possible
-	// in order to minimize the memory footprint.
-	
-	SCM L_U_temp_, L_W_temp_;
-	SCM E_, ET_;
-	
-	// Matrices used to count short cycles (4,6,8).
-	SCM P_U_2_, P_W_2_;				 // P_2^\mathcal{U,W}
-	SCM P_U_2_c2_, P_W_2_c2_;		 // \binom{P_2^\mathcal{U,W}}{2}
-	SCM P_U_3_, P_W_3_;				 // P_3^\mathcal{U,W}
-	SCM P_U_4_, P_W_4_;				 // P_4^\mathcal{U,W}
-	SCM P_U_5_, P_W_5_;				 // P_5^\mathcal{U,W}
-	SCM P_U_6_, P_W_6_;				 // P_6^\mathcal{U,W}
-	SCM P_U_7_, P_W_7_;				 // P_7^\mathcal{U,W}
-	SCM L_U_0_2_m1_, L_W_0_2_m1_;    // \max{L_{(0,2)}^\mathcal{U,W}-1,0}
-	SCM	L_U_0_2_m2_, L_W_0_2_m2_;    // \max{L_{(0,2)}^\mathcal{U,W}-2,0}
-	SCM L_U_1_2_, L_W_1_2_;			 // L_{(1,2)}^\mathcal{U,W}
-	SCM L_U_0_4_, L_W_0_4_;			 // L_{(0,4)}^\mathcal{U,W}
-	SCM L_U_2_2_, L_W_2_2_;			 // L_{(2,2)}^\mathcal{U,W}
-	SCM L_U_1_4_, L_W_1_4_;			 // L_{(1,4)}^\mathcal{U,W}
-	SCM L_U_3_2_, L_W_3_2_;			 // L_{(3,2)}^\mathcal{U,W}
-	SCM L_U_0_6_, L_W_0_6_;			 // L_{(0,6)}^\mathcal{U,W}
-	SCM L_U_2_4_, L_W_2_4_;			 // L_{(2,4)}^\mathcal{U,W}
-	SCM L_U_4_2_, L_W_4_2_;			 // L_{(4,2)}^\mathcal{U,W}
-	SCM L_U_1_6_, L_W_1_6_;			 // L_{(1,6)}^\mathcal{U,W}
-	SCM L_U_3_4_;					 // L_{(3,4)}^\mathcal{U}
-	SCM L_U_5_2_, L_W_5_2_;			 // L_{(5,2)}^\mathcal{U,W}
-	SCM L_U_0_8_, L_W_0_8_;			 // L_{(0,8)}^\mathcal{U,W}
-	
-	SCM Big_Term_A_, Big_Term_B_, Big_Term_C_, Big_Term_D_;
-	
-	// Long cycle matrices.
-	SCM P_U_gm3_, P_W_gm3_;		 // P_{g-3}^\mathcal{U,W}
-	SCM P_U_gm2_, P_W_gm2_;		 // P_{g-2}^\mathcal{U,W}
-	SCM P_U_gm1_, P_W_gm1_;      // P_{g-1}^\mathcal{U,W}
-	SCM P_U_g_, P_W_g_;			 // P_g^\mathcal{U,W}
-	SCM P_U_g1_, P_W_g1_;		 // P_{g+1}^\mathcal{U,W}
-	SCM P_U_g2_, P_W_g2_;		 // P_{g+2}^\mathcal{U,W}
-	SCM P_U_g3_, P_W_g3_;		 // P_{g+3}^\mathcal{U,W}
-	SCM L_U_0_g_, L_W_0_g_;		 // L_{(0,g)}^\mathcal{U,W}
-	SCM L_U_0_g2_, L_W_0_g2_;    // L_{(0,g+2)}^\mathcal{U,W}
-	SCM L_U_0_g4_, L_W_0_g4_;    // L_{(0,g+4)}^\mathcal{U,W}
-	SCM L_U_1_g_, L_W_1_g_;      // L_{(1,g)}^\mathcal{U,W}
-	SCM L_U_1_g2_, L_W_1_g2_;    // L_{(1,g+2)}^\mathcal{U,W}
-	SCM L_U_2_g_, L_W_2_g_;      // L_{(2,g)}^\mathcal{U,W}
-	SCM L_U_3_g_, L_W_3_g_;		 // L_{(3,g)}^\mathcal{U,W}
-	SCM L_U_gm6_2_, L_W_gm6_2_;  // L_{(g-6,2)}^\mathcal{U,W}
-	SCM L_U_gm5_2_, L_W_gm5_2_;  // L_{(g-5,2)}^\mathcal{U,W}
-	SCM L_U_gm4_2_, L_W_gm4_2_;  // L_{(g-4,2)}^\mathcal{U,W}
-	SCM L_U_gm3_2_, L_W_gm3_2_;  // L_{(g-3,2)}^\mathcal{U,W}
-	SCM L_U_gm2_2_, L_W_gm2_2_;  // L_{(g-2,2)}^\mathcal{U,W}
-	SCM L_U_gm1_2_, L_W_gm1_2_;  // L_{(g-1,2)}^\mathcal{U,W}
-	SCM L_U_g_2_, L_W_g_2_;      // L_{(g,2)}^\mathcal{U,W}
-	SCM L_U_g1_2_, L_W_g1_2_;    // L_{(g+1,2)}^\mathcal{U,W}
+	// The same for W, the column sums of the counts per edge, which give
+	// them in every girth branch without the W side L_{(0,k)} matrices.
+	double* Ng_per_w_;
+	double* Ng2_per_w_;
+	double* Ng4_per_w_;
+	
+	// The same per edge.
+	std::vector<double> Ng_per_edge_;
+	std::vector<double> Ng2_per_edge_;
+	std::vector<double> Ng4_per_edge_;
+	
+	SCSM E_, ET_;		// The incidence matrix and its transpose.
+	
+	Short_Cycle_Pool pool_; // Matrix buffers reused across counts.
+	Short_Cycle_Pool* shared_; // See set_pool().
+	Short_Cycle_Thread_Pool threads_;
+	Short_Cycle_Girth girth_;	// Found before the recursions.
+	Short_Cycle_Paths paths_;	// Cycles through a changed edge.
+	
+	// Not copyable.
+	Short_Cycle_Counter( const Short_Cycle_Counter& );
+	Short_Cycle_Counter& operator=( const Short_Cycle_Counter& );
 };
 
 #endif
-
@@ -0,0 +1,257 @@
+/* Short_Cycle_Diag_Matrix.cpp
+
+   Copyright (c) 2005 Thomas R. Halford 
+   All rights reserved.
+ 
+   Developed by: Thomas R. Halford
+                 Communication Sciences Institute
+                 University of Southern California
+                 http://csi.usc.edu
+ 
+   Permission is hereby granted, free of charge, to any person obtaining a copy 
+   of this software and associated documentation files (the "Software"), to deal 
+   with the Software without restriction, including without limitation the rights 
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+   copies of the Software, and to permit persons to whom the Software is furnished 
+   to do so, subject to the following conditions:
+  
+    * Redistributions of source code must retain the above copyright notice, this 
+      list of conditions and the following disclaimers.
+    * Redistributions in binary form must reproduce the above copyright notice, 
+      this list of conditions and the following disclaimers in the documentation 
+      and/or other materials provided with the distribution.
+    * Neither the names of Thomas R. Halford, the Communication Sciences Institute, 
+      the University of Southern California nor the names of its contributors may 
+      be used to endorse or promote products derived from this Software without 
+      specific prior written permission. 
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+   INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+   PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE CONTRIBUTORS OR 
+   COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN 
+   AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION 
+   WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE SOFTWARE.
+*/
+
+#include <iostream>
+#include <string.h>
+#include "Short_Cycle_Matrix.h"
+#include "Short_Cycle_Sparse_Matrix.h"
+#include "Short_Cycle_Diag_Matrix.h"
+#include "Short_Cycle_Edge_Matrix.h"
+
+using namespace std;
+// Constructors.
+template <class T>
+Short_Cycle_Diag_Matrix<T>::Short_Cycle_Diag_Matrix( void )
+  : data_(NULL), i_n_(0), e_n_(0), set_(0), n_alloc_(0), pool_(NULL)
+{
+	return;
+}
+
+template <class T>
+Short_Cycle_Diag_Matrix<T>::Short_Cycle_Diag_Matrix( const Short_Cycle_Diag_Matrix& copy_mx )
+  : data_(NULL), set_(0), n_alloc_(0), pool_(NULL)
+{
+	*this = copy_mx;
+}
+
+template <class T>
+Short_Cycle_Diag_Matrix<T>::~Short_Cycle_Diag_Matrix( void )
+{
+	delete_data();
+}
+
+template <class T>
+Short_Cycle_Diag_Matrix<T>& Short_Cycle_Diag_Matrix<T>::operator=( const Short_Cycle_Diag_Matrix& copy_mx )
+{
+	if( this == &copy_mx ) return *this;
+	
+	// Copy the matrix dimensions and data.
+	e_n_ = copy_mx.e_n_;
+	i_n_ = copy_mx.i_n_;
+	allocate();
+	memcpy(data_,copy_mx.data_,i_n_*sizeof(T));
+	
+	return *this;
+}
+
+// Set the external and internal dimensions.
+template <class T>
+void Short_Cycle_Diag_Matrix<T>::set_e_n( int e_n )
+{
+	e_n_ = e_n;
+	i_n_ = Short_Cycle_Matrix<T>::internal_dim(e_n_);
+}
+
+// Reset the data to all zero elements.
+template <class T>
+void Short_Cycle_Diag_Matrix<T>::reset_data( void )
+{
+	allocate();
+	memset(data_,0,i_n_*sizeof(T));
+}
+
+// Free the matrix data.
+template <class T>
+void Short_Cycle_Diag_Matrix<T>::delete_data( void )
+{
+	if( set_ ) mx_free(data_,n_alloc_,pool_);
+	data_    = NULL;
+	n_alloc_ = 0;
+	pool_    = NULL;
+	set_     = 0;
+}
+
+// Allocate (uninitialized) memory for i_n_ elements, keeping the
+// current buffer if it already has that size.
+template <class T>
+void Short_Cycle_Diag_Matrix<T>::allocate( void )
+{
+	if( set_ && n_alloc_ == i_n_ ) return;
+	delete_data();
+	n_alloc_ = i_n_;
+	data_    = mx_alloc<T>(n_alloc_,pool_);
+	set_     = 1;
+}
+
+// Refer to elements r0 ... r1-1 of source, which are not freed through *this.
+template <class T>
+void Short_Cycle_Diag_Matrix<T>::view_rows( const Short_Cycle_Diag_Matrix& source, int r0, int r1 )
+{
+	delete_data();
+	e_n_  = (source.e_n_ < r1 ? source.e_n_ : r1)-r0;
+	i_n_  = r1-r0;
+	if( e_n_ < 0 ) e_n_ = 0;
+	data_ = source.data_+r0;
+}
+
+// Matrix trace.
+template <class T>
+T Short_Cycle_Diag_Matrix<T>::trace( void ) const
+{
+	T sum = 0;
+	for( int ii = 0; ii < e_n_; ii++ ) sum += data_[ii];
+	return sum;
+}
+
+// Matrix trace accumulated in 64 bits.
+template <class T>
+int64_t Short_Cycle_Diag_Matrix<T>::int_trace( void ) const
+{
+	int64_t sum = 0;
+	for( int ii = 0; ii < e_n_; ii++ ) sum += (int64_t)data_[ii];
+	return sum;
+}
+
+// Set the dimension for the diagonal of a product with left operand left.
+// That of a lifted product has an element per row of the full matrix.
+template <class T>
+void Short_Cycle_Diag_Matrix<T>::set_rows( const Short_Cycle_Matrix<T>& left )
+{
+	if( left.lift() ) set_e_n(left.e_nr()*left.lift());
+	else
+	{
+		e_n_ = left.e_nr();
+		i_n_ = left.i_nr();
+	}
+}
+
+// *this = (left \times right_t^T) o I, i.e., the r-th diagonal element
+// is the dot product of row r of left with row r of right_t.  Both rows
+// are read contiguously and no square result is formed.  The diagonal
+// of a lifted product repeats that of the generating rows.
+template <class T>
+void Short_Cycle_Diag_Matrix<T>::mx_mult_diag_t( const Short_Cycle_Matrix<T>& left,
+											  const Short_Cycle_Matrix<T>& right_t )
+{
+	// Set dimensions and allocate memory.
+	set_rows(left);
+	reset_data();
+	
+	int inner = left.i_nc();
+	for( int rr = 0; rr < left.e_nr(); rr++ )
+	{
+		const T* l = left.data()+(size_t)rr*inner;
+		const T* r = right_t.data()+(size_t)rr*right_t.i_nc();
+		T sum = 0;
+		for( int kk = 0; kk < inner; kk++ ) sum += l[kk]*r[kk];
+		data_[rr] = sum;
+	}
+	
+	for( int rr = left.e_nr(); rr < e_n_; rr++ ) data_[rr] = data_[rr-left.e_nr()];
+}
+
+// *this = (left \times right_t^T) o I where right_t is sparse.  The r-th
+// diagonal element is the sum of left(r,k) over the nonzeros right_t(r,k),
+// e.g., the diagonal of P \times E^T is gathered from the rows of E.
+template <class T>
+void Short_Cycle_Diag_Matrix<T>::mx_mult_diag_t( const Short_Cycle_Matrix<T>& left,
+											  const Short_Cycle_Sparse_Matrix& right_t )
+{
+	// Set dimensions and allocate memory.
+	set_rows(left);
+	reset_data();
+	
+	const int* row_ptr = right_t.row_ptr();
+	const int* col_idx = right_t.col_idx();
+	for( int rr = 0; rr < left.e_nr(); rr++ )
+	{
+		const T* l = left.data()+(size_t)rr*left.i_nc();
+		T sum = 0;
+		for( int pp = row_ptr[rr]; pp < row_ptr[rr+1]; pp++ ) sum += l[col_idx[pp]];
+		data_[rr] = sum;
+	}
+	
+	for( int rr = left.e_nr(); rr < e_n_; rr++ ) data_[rr] = data_[rr-left.e_nr()];
+}
+
+// The r-th diagonal element is the sum of row r of source.  Since
+// diag(A \times E^T) is the row sum of A o E, this gives the diagonal of
+// a product directly from an edge matrix.
+template <class T>
+void Short_Cycle_Diag_Matrix<T>::row_sum( const Short_Cycle_Edge_Matrix<T>& source )
+{
+	const Short_Cycle_Sparse_Matrix& pattern = source.pattern();
+	
+	// Set dimensions and allocate memory.
+	e_n_ = pattern.e_nr();
+	i_n_ = pattern.i_nr();
+	reset_data();
+	
+	const int* row_ptr = pattern.row_ptr();
+	const T* in = source.data();
+	for( int rr = 0; rr < e_n_; rr++ )
+	{
+		T sum = 0;
+		for( int pp = row_ptr[rr]; pp < row_ptr[rr+1]; pp++ ) sum += in[pp];
+		data_[rr] = sum;
+	}
+}
+
+template <class T>
+void Short_Cycle_Diag_Matrix<T>::diagonal( double* d ) const
+{
+	for( int ii = 0; ii < e_n_; ii++ ) d[ii] = (double)data_[ii];
+}
+
+template <class T>
+ostream& operator<<( ostream& os, const Short_Cycle_Diag_Matrix<T>& mx )
+{
+	for( int rr = 0; rr < mx.e_n(); rr++ )
+	{
+		for( int cc = 0; cc < mx.e_n(); cc++ ) os << (rr == cc ? mx[rr] : 0) << " ";
+		os << endl;
+	}
+
+	return os;
+}
+
+// Explicit instantiations for the supported element types.
+template class Short_Cycle_Diag_Matrix<double>;
+template class Short_Cycle_Diag_Matrix<uint32_t>;
+template class Short_Cycle_Diag_Matrix<uint64_t>;
+
+template ostream& operator<<( ostream&, const Short_Cycle_Diag_Matrix<double>& );
+template ostream& operator<<( ostream&, const Short_Cycle_Diag_Matrix<uint32_t>& );
+template ostream& operator<<( ostream&, const Short_Cycle_Diag_Matrix<uint64_t>& );
@@ -0,0 +1,114 @@
+/* Short_Cycle_Diag_Matrix.h
+
+   Copyright (c) 2005 Thomas R. Halford 
+   All rights reserved.
+ 
+   Developed by: Thomas R. Halford
+                 Communication Sciences Institute
+                 University of Southern California
+                 http://csi.usc.edu
+ 
+   Permission is hereby granted, free of charge, to any person obtaining a copy 
+   of this software and associated documentation files (the "Software"), to deal 
+   with the Software without restriction, including without limitation the rights 
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+   copies of the Software, and to permit persons to whom the Software is furnished 
+   to do so, subject to the following conditions:
+  
+    * Redistributions of source code must retain the above copyright notice, this 
+      list of conditions and the following disclaimers.
+    * Redistributions in binary form must reproduce the above copyright notice, 
+      this list of conditions and the following disclaimers in the documentation 
+      and/or other materials provided with the distribution.
+    * Neither the names of Thomas R. Halford, the Communication Sciences Institute, 
+      the University of Southern California nor the names of its contributors may 
+      be used to endorse or promote products derived from this Software without 
+      specific prior written permission. 
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+   INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+   PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE CONTRIBUTORS OR 
+   COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN 
+   AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION 
+   WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE SOFTWARE.
+*/
+
+// Short_Cycle_Diag_Matrix.h defines the diagonal matrix class used by
+// the short cycle counter for the L_{(0,k)} matrices.  Only the diagonal
+// is stored.  The internal dimension follows that of Short_Cycle_Matrix
+// so that diagonal and dense operands can be mixed.  The element type T
+// is that of Short_Cycle_Matrix.  The diagonal of a lifted matrix is
+// stored in full, as it also scales the columns of the matrices.
+ 
+#ifndef SHORT_CYCLE_DIAG_MATRIX
+#define SHORT_CYCLE_DIAG_MATRIX
+
+#include <iostream>
+#include <stdint.h>
+
+template <class T> class Short_Cycle_Matrix;
+class Short_Cycle_Sparse_Matrix;
+template <class T> class Short_Cycle_Edge_Matrix;
+
+template <class T>
+class Short_Cycle_Diag_Matrix
+{
+  public:
+	// Constructors.
+	Short_Cycle_Diag_Matrix( void );
+	Short_Cycle_Diag_Matrix( const Short_Cycle_Diag_Matrix& copy_mx );
+	~Short_Cycle_Diag_Matrix( void );
+	Short_Cycle_Diag_Matrix& operator=( const Short_Cycle_Diag_Matrix& copy_mx );
+	
+	// Accessors.
+	int set( void ) const { return set_; };
+	int i_n( void ) const { return i_n_; };
+	int e_n( void ) const { return e_n_; };
+	T operator[]( int p ) const { return data_[p]; };
+	const T* data( void ) const { return data_; };
+	
+	// Dimension setting methods.
+	void set_e_n( int e_n );	// Also sets the internal dimension.
+	
+	// Elementing setting methods.
+	void set_el( int p, T v ) { data_[p] = v; };
+	void reset_data( void );
+	
+	// Free the matrix memory.
+	void delete_data( void );
+	void allocate( void ); // Uninitialized memory for i_n_ elements.
+	
+	// Refer to elements r0 ... r1-1 of source without copying them.  As
+	// for Short_Cycle_Matrix::view_rows(), *this must only be read.
+	void view_rows( const Short_Cycle_Diag_Matrix& source, int r0, int r1 );
+	
+	// Matrix trace.
+	T trace( void ) const;
+	int64_t int_trace( void ) const; // The trace accumulated in 64 bits.
+	
+	// Matrix operations.
+	void mx_mult_diag_t( const Short_Cycle_Matrix<T>& left,
+						 const Short_Cycle_Matrix<T>& right_t );	 // *this = (left \times right_t^T) o I
+	void mx_mult_diag_t( const Short_Cycle_Matrix<T>& left,
+						 const Short_Cycle_Sparse_Matrix& right_t ); // *this = (left \times right_t^T) o I
+	void row_sum( const Short_Cycle_Edge_Matrix<T>& source );	 // *this = (source \times 1) as a diagonal
+	
+	// Place the matrix diagonal in d.  The external matrix dimension is used. 
+	void diagonal( double* d ) const;
+	
+  private:
+	void set_rows( const Short_Cycle_Matrix<T>& left );
+	
+	T*			data_;
+	int			i_n_;		// "Internal" matrix dimension.
+	int			e_n_;		// "External" matrix dimension.
+	int			set_;		// Flag indicating if memory allocated.
+	int			n_alloc_;	// Number of elements allocated.
+	Short_Cycle_Pool* pool_; // Pool data_ came from, if any.
+};
+
+// Output matrix for debugging.
+template <class T>
+std::ostream& operator<<( std::ostream& os, const Short_Cycle_Diag_Matrix<T>& mx );
+ 
+#endif
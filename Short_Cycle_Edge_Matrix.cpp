@@ -0,0 +1,334 @@
+/* Short_Cycle_Edge_Matrix.cpp
+
+   Copyright (c) 2005 Thomas R. Halford 
+   All rights reserved.
+ 
+   Developed by: Thomas R. Halford
+                 Communication Sciences Institute
+                 University of Southern California
+                 http://csi.usc.edu
+ 
+   Permission is hereby granted, free of charge, to any person obtaining a copy 
+   of this software and associated documentation files (the "Software"), to deal 
+   with the Software without restriction, including without limitation the rights 
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+   copies of the Software, and to permit persons to whom the Software is furnished 
+   to do so, subject to the following conditions:
+  
+    * Redistributions of source code must retain the above copyright notice, this 
+      list of conditions and the following disclaimers.
+    * Redistributions in binary form must reproduce the above copyright notice, 
+      this list of conditions and the following disclaimers in the documentation 
+      and/or other materials provided with the distribution.
+    * Neither the names of Thomas R. Halford, the Communication Sciences Institute, 
+      the University of Southern California nor the names of its contributors may 
+      be used to endorse or promote products derived from this Software without 
+      specific prior written permission. 
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+   INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+   PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE CONTRIBUTORS OR 
+   COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN 
+   AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION 
+   WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE SOFTWARE.
+*/
+
+#include <iostream>
+#include <string.h>
+#include "Short_Cycle_Matrix.h"
+#include "Short_Cycle_Sparse_Matrix.h"
+#include "Short_Cycle_Diag_Matrix.h"
+#include "Short_Cycle_Edge_Matrix.h"
+
+using namespace std;
+// Constructors.
+template <class T>
+Short_Cycle_Edge_Matrix<T>::Short_Cycle_Edge_Matrix( void )
+  : data_(NULL), pattern_(NULL), nnz_(0), set_(0), pool_(NULL)
+{
+	return;
+}
+
+template <class T>
+Short_Cycle_Edge_Matrix<T>::Short_Cycle_Edge_Matrix( const Short_Cycle_Edge_Matrix& copy_mx )
+  : data_(NULL), pattern_(NULL), nnz_(0), set_(0), pool_(NULL)
+{
+	*this = copy_mx;
+}
+
+template <class T>
+Short_Cycle_Edge_Matrix<T>::~Short_Cycle_Edge_Matrix( void )
+{
+	delete_data();
+}
+
+template <class T>
+Short_Cycle_Edge_Matrix<T>& Short_Cycle_Edge_Matrix<T>::operator=( const Short_Cycle_Edge_Matrix& copy_mx )
+{
+	if( this == &copy_mx ) return *this;
+	
+	// Copy the pattern and data.
+	allocate(copy_mx.nnz_);
+	pattern_ = copy_mx.pattern_;
+	memcpy(data_,copy_mx.data_,nnz_*sizeof(T));
+	
+	return *this;
+}
+
+// Set the pattern and reset the data to all zero elements.
+template <class T>
+void Short_Cycle_Edge_Matrix<T>::reset_data( const Short_Cycle_Sparse_Matrix& pattern )
+{
+	allocate(pattern.nnz());
+	pattern_ = &pattern;
+	memset(data_,0,nnz_*sizeof(T));
+}
+
+// Free the matrix data.
+template <class T>
+void Short_Cycle_Edge_Matrix<T>::delete_data( void )
+{
+	if( set_ ) mx_free(data_,nnz_,pool_);
+	data_ = NULL;
+	pool_ = NULL;
+	set_ = 0;
+}
+
+// Allocate (uninitialized) memory for nnz elements, keeping the
+// current buffer if it already has that size.
+template <class T>
+void Short_Cycle_Edge_Matrix<T>::allocate( int nnz )
+{
+	if( set_ && nnz_ == nnz ) return;
+	delete_data();
+	nnz_  = nnz;
+	data_ = mx_alloc<T>(nnz_,pool_);
+	set_  = 1;
+}
+
+// Refer to the elements of source from row r0, which are not freed
+// through *this.
+template <class T>
+void Short_Cycle_Edge_Matrix<T>::view_rows( const Short_Cycle_Edge_Matrix& source, 
+											const Short_Cycle_Sparse_Matrix& pattern, int r0 )
+{
+	delete_data();
+	pattern_ = &pattern;
+	nnz_     = pattern.nnz();
+	data_    = source.data_+source.pattern_->row_ptr()[r0];
+}
+
+// *this = source o pattern.
+template <class T>
+void Short_Cycle_Edge_Matrix<T>::sample( const Short_Cycle_Matrix<T>& source,
+									  const Short_Cycle_Sparse_Matrix& pattern )
+{
+	reset_data(pattern);
+	
+	const int* row_ptr = pattern.row_ptr();
+	const int* col_idx = pattern.col_idx();
+	for( int rr = 0; rr < pattern.e_nr(); rr++ )
+	{
+		for( int pp = row_ptr[rr]; pp < row_ptr[rr+1]; pp++ ) data_[pp] = source.lifted(rr,col_idx[pp]);
+	}
+}
+
+// *this = (left \times right_t^T) o pattern where right_t is sparse.  The
+// (r,c) element is the sum of left(r,k) over the nonzeros right_t(c,k).
+template <class T>
+void Short_Cycle_Edge_Matrix<T>::sddmm( const Short_Cycle_Matrix<T>& left,
+									 const Short_Cycle_Sparse_Matrix& right_t,
+									 const Short_Cycle_Sparse_Matrix& pattern )
+{
+	reset_data(pattern);
+	
+	const int* row_ptr = pattern.row_ptr();
+	const int* col_idx = pattern.col_idx();
+	const int* r_row_ptr = right_t.row_ptr();
+	const int* r_col_idx = right_t.col_idx();
+	int n = left.e_nc();
+	for( int rr = 0; rr < pattern.e_nr(); rr++ )
+	{
+		int shift;
+		const T* in = left.lifted_row(rr,shift);
+		for( int pp = row_ptr[rr]; pp < row_ptr[rr+1]; pp++ )
+		{
+			int cc = col_idx[pp];
+			T sum = 0;
+			for( int qq = r_row_ptr[cc]; qq < r_row_ptr[cc+1]; qq++ ) 
+			{
+				int kk = r_col_idx[qq]-shift;
+				sum += in[kk < 0 ? kk+n : kk];
+			}
+			
+			data_[pp] = sum;
+		}
+	}
+}
+
+// *this = (left \times right_t^T) o pattern where left is sparse.  The
+// (r,c) element is the sum of right_t(c,k) over the nonzeros left(r,k).
+template <class T>
+void Short_Cycle_Edge_Matrix<T>::sddmm( const Short_Cycle_Sparse_Matrix& left,
+									 const Short_Cycle_Matrix<T>& right_t,
+									 const Short_Cycle_Sparse_Matrix& pattern )
+{
+	reset_data(pattern);
+	
+	const int* row_ptr = pattern.row_ptr();
+	const int* col_idx = pattern.col_idx();
+	const int* l_row_ptr = left.row_ptr();
+	const int* l_col_idx = left.col_idx();
+	int n = right_t.e_nc();
+	for( int rr = 0; rr < pattern.e_nr(); rr++ )
+	{
+		for( int pp = row_ptr[rr]; pp < row_ptr[rr+1]; pp++ )
+		{
+			int shift;
+			const T* in = right_t.lifted_row(col_idx[pp],shift);
+			T sum = 0;
+			for( int qq = l_row_ptr[rr]; qq < l_row_ptr[rr+1]; qq++ ) 
+			{
+				int kk = l_col_idx[qq]-shift;
+				sum += in[kk < 0 ? kk+n : kk];
+			}
+			
+			data_[pp] = sum;
+		}
+	}
+}
+
+// *this = left \times right where right is diagonal, i.e., each
+// nonzero left(r,c) is replaced by the c-th diagonal element.
+template <class T>
+void Short_Cycle_Edge_Matrix<T>::matrix_mult( const Short_Cycle_Sparse_Matrix& left,
+										   const Short_Cycle_Diag_Matrix<T>& right )
+{
+	reset_data(left);
+	
+	const int* col_idx = left.col_idx();
+	for( int pp = 0; pp < nnz_; pp++ ) data_[pp] = right[col_idx[pp]];
+}
+
+// *this = left \times right where left is diagonal, i.e., the
+// rows of right are scaled by the diagonal of left.  right may be *this.
+template <class T>
+void Short_Cycle_Edge_Matrix<T>::matrix_mult( const Short_Cycle_Diag_Matrix<T>& left,
+										   const Short_Cycle_Edge_Matrix& right )
+{
+	if( this != &right ) reset_data(*right.pattern_);
+	
+	const int* row_ptr = pattern_->row_ptr();
+	for( int rr = 0; rr < pattern_->e_nr(); rr++ )
+	{
+		T val = left[rr];
+		for( int pp = row_ptr[rr]; pp < row_ptr[rr+1]; pp++ ) data_[pp] = val*right.data_[pp];
+	}
+}
+
+// *this = left \times right where right is diagonal, i.e., the
+// columns of left are scaled by the diagonal of right.  left may be *this.
+template <class T>
+void Short_Cycle_Edge_Matrix<T>::matrix_mult( const Short_Cycle_Edge_Matrix& left,
+										   const Short_Cycle_Diag_Matrix<T>& right )
+{
+	if( this != &left ) reset_data(*left.pattern_);
+	
+	const int* col_idx = pattern_->col_idx();
+	for( int pp = 0; pp < nnz_; pp++ ) data_[pp] = left.data_[pp]*right[col_idx[pp]];
+}
+
+template <class T>
+void Short_Cycle_Edge_Matrix<T>::operator+=( const Short_Cycle_Edge_Matrix& right )
+{
+	for( int pp = 0; pp < nnz_; pp++ ) data_[pp] += right.data_[pp];
+}
+
+template <class T>
+void Short_Cycle_Edge_Matrix<T>::operator-=( const Short_Cycle_Edge_Matrix& right )
+{
+	for( int pp = 0; pp < nnz_; pp++ ) data_[pp] -= right.data_[pp];
+}
+
+// Add the elements of right on the pattern.
+template <class T>
+void Short_Cycle_Edge_Matrix<T>::operator+=( const Short_Cycle_Matrix<T>& right )
+{
+	const int* row_ptr = pattern_->row_ptr();
+	const int* col_idx = pattern_->col_idx();
+	for( int rr = 0; rr < pattern_->e_nr(); rr++ )
+	{
+		for( int pp = row_ptr[rr]; pp < row_ptr[rr+1]; pp++ ) data_[pp] += right.lifted(rr,col_idx[pp]);
+	}
+}
+
+// Subtract the elements of right on the pattern.
+template <class T>
+void Short_Cycle_Edge_Matrix<T>::operator-=( const Short_Cycle_Matrix<T>& right )
+{
+	const int* row_ptr = pattern_->row_ptr();
+	const int* col_idx = pattern_->col_idx();
+	for( int rr = 0; rr < pattern_->e_nr(); rr++ )
+	{
+		for( int pp = row_ptr[rr]; pp < row_ptr[rr+1]; pp++ ) data_[pp] -= right.lifted(rr,col_idx[pp]);
+	}
+}
+
+// Multiplication by a constant.
+template <class T>
+void Short_Cycle_Edge_Matrix<T>::operator*=( T right )
+{
+	for( int pp = 0; pp < nnz_; pp++ ) data_[pp] *= right;
+}
+
+template <class T>
+Short_Cycle_Edge_Matrix<T> Short_Cycle_Edge_Matrix<T>::mx_choose_2( T mult_fac ) const
+{
+	Short_Cycle_Edge_Matrix out = *this;
+	for( int pp = 0; pp < nnz_; pp++ )
+	{
+		out.data_[pp] = mult_fac*mx_binom_2(data_[pp]);
+	}
+	
+	return out;
+}
+
+template <class T>
+Short_Cycle_Edge_Matrix<T> Short_Cycle_Edge_Matrix<T>::mx_choose_3( T mult_fac ) const
+{
+	Short_Cycle_Edge_Matrix out = *this;
+	for( int pp = 0; pp < nnz_; pp++ )
+	{
+		out.data_[pp] = mult_fac*mx_binom_3(data_[pp]);
+	}
+	
+	return out;
+}
+
+template <class T>
+ostream& operator<<( ostream& os, const Short_Cycle_Edge_Matrix<T>& mx )
+{
+	const int* row_ptr = mx.pattern().row_ptr();
+	const int* col_idx = mx.pattern().col_idx();
+	for( int rr = 0; rr < mx.pattern().e_nr(); rr++ )
+	{
+		for( int cc = 0, pp = row_ptr[rr]; cc < mx.pattern().e_nc(); cc++ )
+		{
+			if( pp < row_ptr[rr+1] && col_idx[pp] == cc ) os << mx[pp++] << " ";
+			else os << "0 ";
+		}
+		
+		os << endl;
+	}
+
+	return os;
+}
+
+// Explicit instantiations for the supported element types.
+template class Short_Cycle_Edge_Matrix<double>;
+template class Short_Cycle_Edge_Matrix<uint32_t>;
+template class Short_Cycle_Edge_Matrix<uint64_t>;
+
+template ostream& operator<<( ostream&, const Short_Cycle_Edge_Matrix<double>& );
+template ostream& operator<<( ostream&, const Short_Cycle_Edge_Matrix<uint32_t>& );
+template ostream& operator<<( ostream&, const Short_Cycle_Edge_Matrix<uint64_t>& );
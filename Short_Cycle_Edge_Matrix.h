@@ -0,0 +1,126 @@
+/* Short_Cycle_Edge_Matrix.h
+
+   Copyright (c) 2005 Thomas R. Halford 
+   All rights reserved.
+ 
+   Developed by: Thomas R. Halford
+                 Communication Sciences Institute
+                 University of Southern California
+                 http://csi.usc.edu
+ 
+   Permission is hereby granted, free of charge, to any person obtaining a copy 
+   of this software and associated documentation files (the "Software"), to deal 
+   with the Software without restriction, including without limitation the rights 
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+   copies of the Software, and to permit persons to whom the Software is furnished 
+   to do so, subject to the following conditions:
+  
+    * Redistributions of source code must retain the above copyright notice, this 
+      list of conditions and the following disclaimers.
+    * Redistributions in binary form must reproduce the above copyright notice, 
+      this list of conditions and the following disclaimers in the documentation 
+      and/or other materials provided with the distribution.
+    * Neither the names of Thomas R. Halford, the Communication Sciences Institute, 
+      the University of Southern California nor the names of its contributors may 
+      be used to endorse or promote products derived from this Software without 
+      specific prior written permission. 
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+   INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+   PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE CONTRIBUTORS OR 
+   COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN 
+   AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION 
+   WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE SOFTWARE.
+*/
+
+// Short_Cycle_Edge_Matrix.h defines the edge-indexed matrix class used by
+// the short cycle counter.  An edge matrix shares the sparsity pattern of
+// the incidence matrix E (or E^T) and stores one value per nonzero, in the
+// CSR order of the pattern.  The L_{(1,k)} matrices and all Hadamard
+// products with E are edge matrices.  The pattern is not owned and must
+// outlive the edge matrix.  The element type T is that of Short_Cycle_Matrix.
+// Edge matrices are stored in full; the dense operands of the sampled 
+// operations may be lifted.
+ 
+#ifndef SHORT_CYCLE_EDGE_MATRIX
+#define SHORT_CYCLE_EDGE_MATRIX
+
+#include <iostream>
+#include <stdint.h>
+
+template <class T> class Short_Cycle_Matrix;
+class Short_Cycle_Sparse_Matrix;
+template <class T> class Short_Cycle_Diag_Matrix;
+
+template <class T>
+class Short_Cycle_Edge_Matrix
+{
+  public:
+	// Constructors.
+	Short_Cycle_Edge_Matrix( void );
+	Short_Cycle_Edge_Matrix( const Short_Cycle_Edge_Matrix& copy_mx );
+	~Short_Cycle_Edge_Matrix( void );
+	Short_Cycle_Edge_Matrix& operator=( const Short_Cycle_Edge_Matrix& copy_mx );
+	
+	// Accessors.
+	int set( void ) const { return set_; };
+	int nnz( void ) const { return nnz_; };
+	const Short_Cycle_Sparse_Matrix& pattern( void ) const { return *pattern_; };
+	T operator[]( int p ) const { return data_[p]; };
+	const T* data( void ) const { return data_; };
+	
+	// Set the pattern and reset the data to all zero elements.
+	void reset_data( const Short_Cycle_Sparse_Matrix& pattern );
+	
+	// Free the matrix memory.
+	void delete_data( void );
+	void allocate( int nnz ); // Uninitialized memory for nnz elements.
+	
+	// Refer to the elements of source in its rows r0 and on, where pattern
+	// holds those rows of the pattern of source (see
+	// Short_Cycle_Sparse_Matrix::copy_rows()), without copying them.  As
+	// for Short_Cycle_Matrix::view_rows(), *this must only be read.
+	void view_rows( const Short_Cycle_Edge_Matrix& source, 
+					const Short_Cycle_Sparse_Matrix& pattern, int r0 );
+	
+	// Sampled matrix operations, i.e., only the elements on the pattern are computed.
+	void sample( const Short_Cycle_Matrix<T>& source,
+				 const Short_Cycle_Sparse_Matrix& pattern );	// *this = source o pattern
+	void sddmm( const Short_Cycle_Matrix<T>& left,
+				const Short_Cycle_Sparse_Matrix& right_t,
+				const Short_Cycle_Sparse_Matrix& pattern );		// *this = (left \times right_t^T) o pattern
+	void sddmm( const Short_Cycle_Sparse_Matrix& left,
+				const Short_Cycle_Matrix<T>& right_t,
+				const Short_Cycle_Sparse_Matrix& pattern );		// *this = (left \times right_t^T) o pattern
+	
+	// Matrix operations with a diagonal operand.
+	void matrix_mult( const Short_Cycle_Sparse_Matrix& left,
+					  const Short_Cycle_Diag_Matrix<T>& right );	// *this = left \times right
+	void matrix_mult( const Short_Cycle_Diag_Matrix<T>& left,
+					  const Short_Cycle_Edge_Matrix& right );	// *this = left \times right
+	void matrix_mult( const Short_Cycle_Edge_Matrix& left,
+					  const Short_Cycle_Diag_Matrix<T>& right );	// *this = left \times right
+	
+	// Elementwise operations.  The dense operands are sampled on the pattern.
+	void operator+=( const Short_Cycle_Edge_Matrix& right );	// *this = *this + right
+	void operator-=( const Short_Cycle_Edge_Matrix& right );	// *this = *this - right
+	void operator+=( const Short_Cycle_Matrix<T>& right );		// *this = *this + right o pattern
+	void operator-=( const Short_Cycle_Matrix<T>& right );		// *this = *this - right o pattern
+	void operator*=( T right );								// *this = right*(*this)
+	
+	Short_Cycle_Edge_Matrix mx_choose_2( T mult_fac ) const;
+	Short_Cycle_Edge_Matrix mx_choose_3( T mult_fac ) const;
+	
+  private:
+	T*			data_;
+	const Short_Cycle_Sparse_Matrix* pattern_;
+	int			nnz_;		// Number of stored elements.
+	int			set_;		// Flag indicating if memory allocated.
+	Short_Cycle_Pool* pool_; // Pool data_ came from, if any.
+};
+
+// Output matrix for debugging.
+template <class T>
+std::ostream& operator<<( std::ostream& os, const Short_Cycle_Edge_Matrix<T>& mx );
+ 
+#endif
@@ -0,0 +1,1487 @@
+/* Short_Cycle_Engine.cpp
+
+   Copyright (c) 2005 Thomas R. Halford 
+   All rights reserved.
+ 
+   Developed by: Thomas R. Halford
+                 Communication Sciences Institute
+                 University of Southern California
+                 http://csi.usc.edu
+ 
+   Permission is hereby granted, free of charge, to any person obtaining a copy 
+   of this software and associated documentation files (the "Software"), to deal 
+   with the Software without restriction, including without limitation the rights 
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+   copies of the Software, and to permit persons to whom the Software is furnished 
+   to do so, subject to the following conditions:
+  
+    * Redistributions of source code must retain the above copyright notice, this 
+      list of conditions and the following disclaimers.
+    * Redistributions in binary form must reproduce the above copyright notice, 
+      this list of conditions and the following disclaimers in the documentation 
+      and/or other materials provided with the distribution.
+    * Neither the names of Thomas R. Halford, the Communication Sciences Institute, 
+      the University of Southern California nor the names of its contributors may 
+      be used to endorse or promote products derived from this Software without 
+      specific prior written permission. 
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+   INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+   PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE CONTRIBUTORS OR 
+   COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN 
+   AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION 
+   WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE SOFTWARE.
+*/
+
+
+#include <math.h>
+#include "Short_Cycle_Counter.h"
+#include "Short_Cycle_Engine.h"
+
+template <class T>
+Short_Cycle_Engine<T>::Short_Cycle_Engine( Short_Cycle_Counter& counter )
+ : counter_(counter), U_(counter.U_), W_(counter.W_), g_(counter.g_),
+   Ng_(counter.Ng_), Ng2_(counter.Ng2_), Ng4_(counter.Ng4_),
+   Ng_per_u_(counter.Ng_per_u_), Ng2_per_u_(counter.Ng2_per_u_), Ng4_per_u_(counter.Ng4_per_u_),
+   Ng_per_edge_(counter.Ng_per_edge_), Ng2_per_edge_(counter.Ng2_per_edge_), Ng4_per_edge_(counter.Ng4_per_edge_),
+   E_(counter.E_), ET_(counter.ET_), threads_(&counter.threads_), 
+   rows_(counter.E_.lift() ? 0 : counter.rows_), 
+   girth_(counter.girth_.girth()), max_cycle_(counter.girth_.max_cycle()), overflow_(0)
+{
+	return;
+}
+
+// Returns 1 if the diagonal of L_{(0,k)}^\mathcal{U} is guaranteed to be
+// representable in T.  Returns 0 if it is not and a wider type exists, in
+// which case the count is abandoned.  The widest type always continues
+// but the counter is flagged as possibly inexact.
+template <class T>
+int Short_Cycle_Engine<T>::check_bound( int k )
+{
+	if( counter_.walk_bound(k) < ldexp(1.0,8*(int)sizeof(T)) ) return 1;
+	if( sizeof(T) < sizeof(uint64_t) )
+	{
+		overflow_ = 1;
+		return 0;
+	}
+	
+	counter_.exact_ = 0;
+	return 1;
+}
+
+// L_{(0,k)}^\mathcal{U} is the row sum of P_{k-1}^\mathcal{U} o E, whose
+// element at edge (u,w) counts the paths of length k-1 from u to w, i.e.,
+// the cycles of length k through the edge.  The counts of different
+// lengths, and of different rows, are written by different nodes.
+template <class T>
+void Short_Cycle_Engine<T>::edge_counts( int k, const SCM& P )
+{
+	if( k < girth_ || k > girth_+4 ) return;
+	SCEM etemp;
+	etemp.sample(P,E_);
+	edge_counts(k,etemp);
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::edge_counts( int k, const SCEM& e, int first )
+{
+	if( k < girth_ || k > girth_+4 ) return;
+	std::vector<double>& out = (k == girth_ ? Ng_per_edge_ : k == girth_+2 ? Ng2_per_edge_ : Ng4_per_edge_);
+	for( int pp = 0; pp < e.nnz(); pp++ ) out[first+pp] = (double)e[pp];
+}
+
+// Returns 0 if the count was abandoned because T is too narrow.
+template <class T>
+int Short_Cycle_Engine<T>::count( void )
+{
+	g_   = 1000000;
+	Ng_  = 0;
+	Ng2_ = 0;
+	Ng4_ = 0;
+	if( girth_ == 1000000 ) return 1; // No cycles.
+	
+	// Count 4 cycles first to determine girth.
+	if( count_four_cycles() )
+	{
+		// girth == 4
+		count_six_eight_cycles();
+	}
+	
+	else
+	{
+		// Count 6 and 8 cycles to determine the girth.
+		count_six_eight_cycles();
+		if( g_ == 6 )
+		{
+			Ng_  = L_U_0_6_.int_trace()/6;
+			L_U_0_6_.diagonal(Ng_per_u_);
+			
+			Ng2_ = L_U_0_8_.int_trace()/8;
+			L_U_0_8_.diagonal(Ng2_per_u_);
+		
+			// Count the 10 cycles with girth = 6.
+			Short_Cycle_Task_Graph graph;
+			count_ten_cycles_g_6(graph);
+			graph.keep(L_U_0_g4_);
+			graph.run(threads_);
+			Ng4_ = L_U_0_g4_.int_trace()/10;
+			L_U_0_g4_.diagonal(Ng4_per_u_);
+		}
+		
+		else if( g_ == 8 )
+		{
+			Ng_ = L_U_0_8_.int_trace()/8;
+			L_U_0_8_.diagonal(Ng_per_u_);
+			// Count 10 and 12 cycles when the girth = 8.
+			Short_Cycle_Task_Graph graph;
+			count_ten_cycles_g_6(graph); 
+			count_twelve_cycles_g_8(graph);
+			graph.keep(L_U_0_g2_).keep(L_U_0_g4_);
+			graph.run(threads_);
+			Ng2_ = L_U_0_g2_.int_trace()/10;
+			L_U_0_g2_.diagonal(Ng2_per_u_);
+			Ng4_ = L_U_0_g4_.int_trace()/12;
+			L_U_0_g4_.diagonal(Ng4_per_u_);
+		}
+		
+		else count_longer_cycles();
+	}
+	
+	// All counts up to length g+4 have been read when g <= 8.
+	if( g_ <= 8 && !check_bound(g_+4) ) return 0;
+	return !overflow_;
+}
+
+// Returns 1 if the girth is 4, 0 otherwise.
+template <class T>
+int Short_Cycle_Engine<T>::count_four_cycles( void )
+{
+	// P_U_2, P_W_2 and the matrices derived from them are computed
+	// together for speed.  Every matrix is used again by 
+	// count_six_eight_cycles().
+	Short_Cycle_Task_Graph graph;
+	graph.add("P_U_2",this,&SCE::process_P_U_2).out(P_U_2_).out(P_U_2_c2_).out(L_U_0_2_m1_).out(L_U_0_2_m2_);
+	graph.add("P_W_2",this,&SCE::process_P_W_2).out(P_W_2_).out(P_W_2_c2_).out(L_W_0_2_m1_).out(L_W_0_2_m2_);
+	graph.add("L_U_1_2",this,&SCE::compute_L_U_1_2).out(L_U_1_2_).in(L_W_0_2_m1_);
+	graph.add("L_W_1_2",this,&SCE::compute_L_W_1_2).out(L_W_1_2_).in(L_U_0_2_m1_);
+	graph.add("P_U_3",this,&SCE::compute_P_U_3).out(P_U_3_).in(P_U_2_).in(L_U_1_2_);
+	graph.add("P_W_3",this,&SCE::compute_P_W_3).out(P_W_3_).in(P_U_3_);
+	graph.add("L_U_0_4",this,&SCE::compute_L_U_0_4).out(L_U_0_4_).in(P_U_3_);
+	graph.add("L_W_0_4",this,&SCE::compute_L_W_0_4).out(L_W_0_4_).in(P_W_3_);
+	graph.keep_all();
+	graph.run(threads_);
+
+	int64_t temp = L_U_0_4_.int_trace();
+	if( temp == 0 ) return 0;
+	else
+	{
+		g_  = 4;
+		Ng_ = temp/4;
+		L_U_0_4_.diagonal(Ng_per_u_);
+		return 1;
+	}
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_U_1_2( void )
+{
+	L_U_1_2_.matrix_mult(E_,L_W_0_2_m1_);
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_W_1_2( void )
+{
+	L_W_1_2_.matrix_mult(ET_,L_U_0_2_m1_);
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_P_U_3( void )
+{
+	P_U_3_.matrix_mult(P_U_2_,E_);
+	P_U_3_ -= L_U_1_2_;
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_P_W_3( void )
+{
+	P_W_3_.transpose(P_U_3_);
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_U_0_4( void )
+{
+	L_U_0_4_.mx_mult_diag_t(P_U_3_,E_);
+	edge_counts(4,P_U_3_);
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_W_0_4( void )
+{
+	L_W_0_4_.mx_mult_diag_t(P_W_3_,ET_);
+}
+
+// The g = 4 terms are added inside the nodes, which declare the inputs
+// of those terms for every girth so that the inputs are freed either way.
+// The girth is updated once the graph has run.
+template <class T>
+void Short_Cycle_Engine<T>::count_six_eight_cycles( void )
+{
+	Short_Cycle_Task_Graph graph;
+	graph.add("L_U_2_2",this,&SCE::compute_L_U_2_2).out(L_U_2_2_).in(L_W_1_2_);
+	graph.add("L_W_2_2",this,&SCE::compute_L_W_2_2).out(L_W_2_2_).in(L_U_1_2_);
+	graph.add("P_U_4",this,&SCE::compute_P_U_4).out(P_U_4_).in(P_U_3_).in(L_U_2_2_).in(L_U_0_4_);
+	graph.add("P_W_4",this,&SCE::compute_P_W_4).out(P_W_4_).in(P_W_3_).in(L_W_2_2_).in(L_W_0_4_);
+	graph.add("L_U_1_4",this,&SCE::compute_L_U_1_4).out(L_U_1_4_).in(L_W_0_4_).in(P_U_3_);
+	graph.add("L_W_1_4",this,&SCE::compute_L_W_1_4).out(L_W_1_4_).in(L_U_0_4_).in(P_W_3_);
+	graph.add("L_U_3_2",this,&SCE::compute_L_U_3_2).out(L_U_3_2_).in(P_U_3_).in(L_W_0_2_m1_);
+	graph.add("L_W_3_2",this,&SCE::compute_L_W_3_2).out(L_W_3_2_).in(P_W_3_).in(L_U_0_2_m1_);
+	graph.add("P_U_5",this,&SCE::compute_P_U_5).out(P_U_5_).in(P_U_4_).in(L_U_3_2_).in(L_U_1_4_);
+	graph.add("P_W_5",this,&SCE::compute_P_W_5).out(P_W_5_).in(P_U_5_);
+	graph.add("L_U_0_6",this,&SCE::compute_L_U_0_6).out(L_U_0_6_).in(P_U_5_);
+	graph.add("L_W_0_6",this,&SCE::compute_L_W_0_6).out(L_W_0_6_).in(P_W_5_);
+	graph.add("L_U_2_4",this,&SCE::compute_L_U_2_4).out(L_U_2_4_).in(L_W_1_4_).in(P_U_2_);
+	graph.add("L_W_2_4",this,&SCE::compute_L_W_2_4).out(L_W_2_4_).in(L_U_1_4_).in(P_W_2_);
+	graph.add("L_U_4_2",this,&SCE::compute_L_U_4_2).out(L_U_4_2_).in(L_W_3_2_).in(L_U_0_2_m1_).in(L_U_2_2_).in(P_U_2_c2_);
+	graph.add("L_W_4_2",this,&SCE::compute_L_W_4_2).out(L_W_4_2_).in(L_U_3_2_).in(L_W_0_2_m1_).in(L_W_2_2_).in(P_W_2_c2_);
+	graph.add("P_U_6",this,&SCE::compute_P_U_6).out(P_U_6_).in(P_U_5_).in(L_U_2_4_).in(L_U_4_2_).in(L_U_0_6_);
+	graph.add("P_W_6",this,&SCE::compute_P_W_6).out(P_W_6_).in(P_W_5_).in(L_W_2_4_).in(L_W_4_2_).in(L_W_0_6_);
+	graph.add("L_U_1_6",this,&SCE::compute_L_U_1_6).out(L_U_1_6_).in(L_W_0_6_).in(P_U_5_)
+		 .in(P_U_3_).in(P_U_2_c2_).in(P_W_2_c2_);
+	graph.add("L_W_1_6",this,&SCE::compute_L_W_1_6).out(L_W_1_6_).in(L_U_0_6_).in(P_W_5_)
+		 .in(P_W_3_).in(P_W_2_c2_).in(P_U_2_c2_);
+	
+	// L_U_3_4 and L_U_1_4 are both 0 if g_ > 4.
+	if( g_ == 4 )
+	{
+		graph.add("L_U_3_4",this,&SCE::compute_L_U_3_4).out(L_U_3_4_).in(L_W_2_4_).in(L_U_0_2_m1_).in(L_U_1_4_)
+			 .in(P_U_3_).in(P_U_2_c2_).in(P_W_2_c2_);
+	}
+	
+	graph.add("L_U_5_2",this,&SCE::compute_L_U_5_2).out(L_U_5_2_).in(L_W_4_2_).in(L_U_0_2_m1_).in(L_U_3_2_).in(P_U_5_)
+		 .in(P_U_3_).in(L_U_0_4_).in(L_U_1_2_).in(L_W_0_2_m2_).in(P_U_2_c2_);
+	graph.add("L_W_5_2",this,&SCE::compute_L_W_5_2).out(L_W_5_2_).in(L_U_4_2_).in(L_W_0_2_m1_).in(L_W_3_2_).in(P_W_5_)
+		 .in(L_W_0_4_).in(L_W_1_2_).in(P_W_2_).in(P_W_3_).in(L_U_0_2_m2_);
+	
+	// When g = 4 only the diagonal of P_U_7 is needed.
+	if( g_ == 4 )
+	{
+		graph.add("L_U_0_8",this,&SCE::compute_L_U_0_8).out(L_U_0_8_).in(P_U_6_).in(L_U_1_6_).in(L_U_3_4_).in(L_U_5_2_);
+	}
+	
+	else
+	{
+		graph.add("P_U_7",this,&SCE::compute_P_U_7).out(P_U_7_).in(P_U_6_).in(L_U_5_2_).in(L_U_1_6_);
+		graph.add("P_W_7",this,&SCE::compute_P_W_7).out(P_W_7_).in(P_U_7_);
+		graph.add("L_U_0_8",this,&SCE::compute_L_U_0_8).out(L_U_0_8_).in(P_U_7_);
+		graph.add("L_W_0_8",this,&SCE::compute_L_W_0_8).out(L_W_0_8_).in(P_W_7_);
+		
+		// The matrices used by the counts for girths of 6, 8 and 10 or more.
+		graph.keep(P_U_2_).keep(P_W_2_).keep(P_U_3_).keep(P_W_3_).keep(P_U_4_).keep(P_W_4_)
+			 .keep(P_U_5_).keep(P_W_5_).keep(P_U_6_).keep(P_W_6_).keep(P_U_7_).keep(P_W_7_)
+			 .keep(L_U_0_2_m1_).keep(L_W_0_2_m1_).keep(L_U_0_2_m2_).keep(L_W_0_2_m2_)
+			 .keep(L_U_1_2_).keep(L_W_1_2_).keep(L_U_4_2_).keep(L_W_4_2_).keep(L_U_5_2_).keep(L_W_5_2_)
+			 .keep(L_U_1_6_).keep(L_W_1_6_).keep(L_W_0_6_).keep(L_W_0_8_);
+	}
+	
+	graph.keep(L_U_0_6_).keep(L_U_0_8_);
+	graph.run(threads_);
+	
+	int64_t temp = L_U_0_6_.int_trace();
+	if( g_ == 4 ) 
+	{
+		Ng2_ = temp/6; 
+		L_U_0_6_.diagonal(Ng2_per_u_);
+	}
+	
+	else if( temp > 0 ) g_ = 6;
+	
+	temp = L_U_0_8_.int_trace();
+	if( g_ == 4 ) 
+	{
+		Ng4_ = temp/8;
+		L_U_0_8_.diagonal(Ng4_per_u_);
+	}
+	
+	else if( temp && g_ != 6 ) g_ = 8;     
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_U_2_2( void )
+{
+	L_U_2_2_.mx_mult_zero(E_,L_W_1_2_);
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_W_2_2( void )
+{
+	L_W_2_2_.mx_mult_zero(ET_,L_U_1_2_);
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_P_U_4( void )
+{
+	P_U_4_.matrix_mult_sym_sub(P_U_3_,ET_,L_U_2_2_);
+	P_U_4_ -= L_U_0_4_; 
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_P_W_4( void )
+{
+	P_W_4_.matrix_mult_sym_sub(P_W_3_,E_,L_W_2_2_);
+	P_W_4_ -= L_W_0_4_; 
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_U_1_4( void )
+{
+	SCEM etemp;
+	L_U_1_4_.matrix_mult(E_,L_W_0_4_);  
+	etemp.sample(P_U_3_,E_);
+	L_U_1_4_ -= etemp;
+	L_U_1_4_ -= etemp;
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_W_1_4( void )
+{
+	SCEM etemp;
+	L_W_1_4_.matrix_mult(ET_,L_U_0_4_); 
+	etemp.sample(P_W_3_,ET_);
+	L_W_1_4_ -= etemp;
+	L_W_1_4_ -= etemp;
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_U_3_2( void )
+{
+	SCEM etemp;
+	L_U_3_2_.matrix_mult(P_U_3_,L_W_0_2_m1_); 
+	etemp.sample(P_U_3_,E_);
+	L_U_3_2_ -= etemp;
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_W_3_2( void )
+{
+	SCEM etemp;
+	L_W_3_2_.matrix_mult(P_W_3_,L_U_0_2_m1_); 
+	etemp.sample(P_W_3_,ET_);
+	L_W_3_2_ -= etemp;
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_P_U_5( void )
+{
+	P_U_5_.matrix_mult_sub(P_U_4_,E_,L_U_3_2_);
+	P_U_5_ -= L_U_1_4_; 
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_P_W_5( void )
+{
+	P_W_5_.transpose(P_U_5_); 
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_U_0_6( void )
+{
+	L_U_0_6_.mx_mult_diag_t(P_U_5_,E_);
+	edge_counts(6,P_U_5_);
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_W_0_6( void )
+{
+	L_W_0_6_.mx_mult_diag_t(P_W_5_,ET_);
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_U_2_4( void )
+{
+	L_U_2_4_.mx_mult_zero(E_,L_W_1_4_);  
+	if( g_ == 4 ) L_U_2_4_ -= P_U_2_.mx_choose_3(6);
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_W_2_4( void )
+{
+	L_W_2_4_.mx_mult_zero(ET_,L_U_1_4_); 
+	if( g_ == 4 ) L_W_2_4_ -= P_W_2_.mx_choose_3(6);
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_U_4_2( void )
+{
+	L_U_4_2_.mx_mult_zero_sub(E_,L_W_3_2_,mx_prod(L_U_0_2_m1_,L_U_2_2_));
+	if( g_ == 4 )
+	{
+		L_U_4_2_ += P_U_2_c2_;
+		L_U_4_2_ += P_U_2_c2_;
+	}
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_W_4_2( void )
+{
+	L_W_4_2_.mx_mult_zero_sub(ET_,L_U_3_2_,mx_prod(L_W_0_2_m1_,L_W_2_2_));
+	if( g_ == 4 )
+	{
+		L_W_4_2_ += P_W_2_c2_;
+		L_W_4_2_ += P_W_2_c2_;
+	}
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_P_U_6( void )
+{
+	P_U_6_.matrix_mult_sym_sub(P_U_5_,ET_,L_U_2_4_ + L_U_4_2_);
+	P_U_6_ -= L_U_0_6_; 
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_P_W_6( void )
+{
+	P_W_6_.matrix_mult_sym_sub(P_W_5_,E_,L_W_2_4_ + L_W_4_2_);
+	P_W_6_ -= L_W_0_6_; 
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_U_1_6( void )
+{
+	SCEM etemp;
+	L_U_1_6_.matrix_mult(E_,L_W_0_6_); 
+	etemp.sample(P_U_5_,E_);
+	etemp *= 2;
+	L_U_1_6_  -= etemp;
+	if( g_ == 4 )
+	{
+		etemp.sample(P_U_3_,E_);
+		etemp = etemp.mx_choose_2(2);
+		L_U_1_6_  -= etemp;
+		etemp.sddmm(P_U_2_c2_,ET_,E_);
+		etemp -= P_U_3_;
+		etemp *= 2;
+		L_U_1_6_  += etemp;
+		etemp.sddmm(E_,P_W_2_c2_,E_); // P_W_2_c2 is symmetric.
+		etemp -= P_U_3_;
+		etemp *= 2;
+		L_U_1_6_  += etemp;
+	}
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_W_1_6( void )
+{
+	SCEM etemp;
+	L_W_1_6_.matrix_mult(ET_,L_U_0_6_); 
+	etemp.sample(P_W_5_,ET_);
+	etemp *= 2;
+	L_W_1_6_  -= etemp;
+	if( g_ == 4 )
+	{
+		etemp.sample(P_W_3_,ET_);
+		etemp = etemp.mx_choose_2(2);
+		L_W_1_6_  -= etemp;
+		etemp.sddmm(P_W_2_c2_,E_,ET_);
+		etemp -= P_W_3_;
+		etemp *= 2;
+		L_W_1_6_  += etemp;
+		etemp.sddmm(ET_,P_U_2_c2_,ET_); // P_U_2_c2 is symmetric.
+		etemp -= P_W_3_;
+		etemp *= 2;
+		L_W_1_6_  += etemp;
+	}
+}
+
+// Only computed when g = 4.
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_U_3_4( void )
+{
+	SCEM etemp;
+	L_U_3_4_.matrix_mult(E_,L_W_2_4_); 
+	etemp.matrix_mult(L_U_0_2_m1_,L_U_1_4_); 
+	L_U_3_4_  -= etemp;
+	etemp.sample(P_U_3_,E_);
+	etemp = etemp.mx_choose_2(4);
+	L_U_3_4_  -= etemp;
+	etemp.sddmm(P_U_2_c2_,ET_,E_);
+	etemp -= P_U_3_;
+	etemp *= 4;
+	L_U_3_4_  += etemp;
+	etemp.sddmm(E_,P_W_2_c2_,E_);
+	etemp -= P_U_3_;
+	etemp *= 6;
+	L_U_3_4_  += etemp;
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_U_5_2( void )
+{
+	SCEM etemp;
+	L_U_5_2_.matrix_mult_sub(E_,L_W_4_2_,mx_prod(L_U_0_2_m1_,L_U_3_2_));
+	etemp.sample(P_U_5_,E_);
+	L_U_5_2_ -= etemp;
+	if( g_ == 4 )
+	{
+		etemp.sample(P_U_3_,E_);
+		L_U_5_2_  += etemp;
+		L_U_5_2_  += etemp; 
+		etemp.matrix_mult(L_U_0_4_,L_U_1_2_);
+		L_U_5_2_  -= etemp;
+		etemp.sample(L_U_3_2_,E_);
+		L_U_5_2_  += etemp;
+		etemp.sample(P_U_3_,E_);
+		etemp.matrix_mult(etemp,L_W_0_2_m2_);
+		L_U_5_2_  += etemp;
+		L_U_5_2_  += etemp;
+		etemp.sddmm(P_U_2_c2_,ET_,E_);
+		etemp -= P_U_3_;
+		L_U_5_2_  += etemp;
+		L_U_5_2_  += etemp;
+	}
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_W_5_2( void )
+{
+	SCEM etemp;
+	L_W_5_2_.matrix_mult_sub(ET_,L_U_4_2_,mx_prod(L_W_0_2_m1_,L_W_3_2_));
+	etemp.sample(P_W_5_,ET_);
+	L_W_5_2_ -= etemp;
+	if( g_ == 4 )
+	{
+		SCM temp;
+		etemp.matrix_mult(L_W_0_4_,L_W_1_2_);
+		L_W_5_2_  -= etemp;
+		temp.matrix_mult(P_W_2_,ET_);
+		L_W_5_2_  += L_W_3_2_ + 2*mx_prod(P_W_3_,L_U_0_2_m2_) + 2*temp;
+	}   
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_P_U_7( void )
+{
+	P_U_7_.matrix_mult_sub(P_U_6_,E_,L_U_5_2_);
+	P_U_7_ -= L_U_1_6_; 
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_P_W_7( void )
+{
+	P_W_7_.transpose(P_U_7_);
+}
+
+// When g = 4 P_U_7 is not formed.  Its diagonal is the row sum of 
+// P_U_7 o E, which is computed directly on the edges of E.
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_U_0_8( void )
+{
+	if( g_ == 4 )
+	{
+		SCEM etemp;
+		etemp.sddmm(P_U_6_,ET_,E_);
+		etemp -= L_U_1_6_;
+		etemp -= L_U_3_4_;
+		etemp -= L_U_5_2_;
+		L_U_0_8_.row_sum(etemp);
+		edge_counts(8,etemp);
+	}
+	
+	else 
+	{
+		L_U_0_8_.mx_mult_diag_t(P_U_7_,E_);
+		edge_counts(8,P_U_7_);
+	}
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_W_0_8( void )
+{
+	L_W_0_8_.mx_mult_diag_t(P_W_7_,ET_);
+}
+
+// Add the nodes that compute L_U_0_10.  When g = 8 P_U_9 is formed as
+// well for count_twelve_cycles_g_8().
+template <class T>
+void Short_Cycle_Engine<T>::count_ten_cycles_g_6( Short_Cycle_Task_Graph& graph )
+{   
+	if( g_ == 6 && rows_ > 0 )
+	{
+		graph.add("L_W_2_6",this,&SCE::compute_L_W_2_6).out(L_W_2_g_).in(L_U_1_6_);
+		graph.add("L_W_6_2",this,&SCE::compute_L_W_6_2).out(L_W_g_2_).in(L_U_5_2_).in(L_W_0_2_m1_).in(L_W_4_2_)
+			 .in(P_W_4_).in(P_W_2_);
+		Row_Stage stage = { 6, &P_U_4_, &P_U_5_, &P_U_7_, &L_U_4_2_, &L_U_5_2_, &L_W_5_2_,
+							&L_U_1_6_, &L_W_1_6_, &L_U_0_6_, &L_U_0_8_, &L_W_0_8_ };
+		add_row_blocks(graph,stage);
+		return;
+	}
+	
+	graph.add("L_U_2_6",this,&SCE::compute_L_U_2_6).out(L_U_2_g_).in(L_W_1_6_);
+	graph.add("L_W_2_6",this,&SCE::compute_L_W_2_6).out(L_W_2_g_).in(L_U_1_6_);
+	graph.add("L_U_6_2",this,&SCE::compute_L_U_6_2).out(L_U_g_2_).in(L_W_5_2_).in(L_U_0_2_m1_).in(L_U_4_2_)
+		 .in(P_U_4_).in(P_U_2_);
+	graph.add("L_W_6_2",this,&SCE::compute_L_W_6_2).out(L_W_g_2_).in(L_U_5_2_).in(L_W_0_2_m1_).in(L_W_4_2_)
+		 .in(P_W_4_).in(P_W_2_);
+	graph.add("P_U_8",this,&SCE::compute_P_U_8).out(P_U_g2_).in(P_U_7_).in(L_U_2_g_).in(L_U_g_2_).in(L_U_0_8_);
+	graph.add("L_U_1_8",this,&SCE::compute_L_U_1_8).out(L_U_1_g2_).in(L_W_0_8_).in(P_U_7_);
+	graph.add("L_U_3_6",this,&SCE::compute_L_U_3_6).out(L_U_3_g_).in(L_W_2_g_).in(L_U_0_2_m1_).in(L_U_1_6_).in(P_U_3_);
+	graph.add("L_U_7_2",this,&SCE::compute_L_U_7_2).out(L_U_g1_2_).in(L_W_g_2_).in(P_U_7_).in(L_U_5_2_)
+		 .in(L_U_0_2_m1_).in(L_U_0_6_).in(L_U_1_2_).in(P_U_5_).in(L_W_0_2_m2_);
+	graph.add("L_U_0_10",this,&SCE::compute_L_U_0_10).out(L_U_0_g4_).out(P_U_g3_)
+		 .in(P_U_g2_).in(L_U_1_g2_).in(L_U_3_g_).in(L_U_g1_2_);
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_U_2_6( void )
+{
+	L_U_2_g_.mx_mult_zero(E_,L_W_1_6_);
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_W_2_6( void )
+{
+	L_W_2_g_.mx_mult_zero(ET_,L_U_1_6_);
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_U_6_2( void )
+{
+	L_U_g_2_.mx_mult_zero_sub(E_,L_W_5_2_,mx_prod(L_U_0_2_m1_,L_U_4_2_) - P_U_4_*P_U_2_);
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_W_6_2( void )
+{
+	L_W_g_2_.mx_mult_zero_sub(ET_,L_U_5_2_,mx_prod(L_W_0_2_m1_,L_W_4_2_) - P_W_4_*P_W_2_);
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_P_U_8( void )
+{
+	P_U_g2_.matrix_mult_sym_sub(P_U_7_,ET_,L_U_2_g_ + L_U_g_2_);
+	P_U_g2_ -= L_U_0_8_; 
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_U_1_8( void )
+{
+	SCEM etemp;
+	L_U_1_g2_.matrix_mult(E_,L_W_0_8_);  
+	etemp.sample(P_U_7_,E_);
+	etemp *= 2;
+	L_U_1_g2_ -= etemp;
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_U_3_6( void )
+{
+	SCEM etemp;
+	L_U_3_g_.matrix_mult(E_,L_W_2_g_); 
+	etemp.matrix_mult(L_U_0_2_m1_,L_U_1_6_);
+	L_U_3_g_ -= etemp; 
+	L_U_3_g_ -= P_U_3_.mx_choose_3(6);
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_U_7_2( void )
+{
+	SCEM etemp;
+	L_U_g1_2_.matrix_mult(E_,L_W_g_2_); 
+	etemp.sample(P_U_7_,E_);
+	L_U_g1_2_ -= etemp; 
+	etemp.sample(L_U_5_2_,E_);
+	L_U_g1_2_ += etemp;
+	L_U_g1_2_ -= mx_prod(L_U_0_2_m1_,L_U_5_2_);
+	etemp.matrix_mult(L_U_0_6_,L_U_1_2_);
+	L_U_g1_2_ -= etemp;
+	etemp.sample(P_U_5_,E_);
+	etemp *= 2;
+	L_U_g1_2_ += etemp; 
+	etemp.matrix_mult(etemp,L_W_0_2_m2_);
+	L_U_g1_2_ += etemp;
+}
+
+// Compute P_U_9 and L_U_0_10.  P_U_9 itself is only needed when
+// g = 8; otherwise L_U_0_10 is the row sum of P_U_9 o E.
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_U_0_10( void )
+{
+	if( g_ == 8 )
+	{
+		P_U_g3_.matrix_mult_sub(P_U_g2_,E_,L_U_3_g_ + L_U_g1_2_);
+		P_U_g3_ -= L_U_1_g2_; 
+		L_U_0_g4_.mx_mult_diag_t(P_U_g3_,E_);
+		edge_counts(10,P_U_g3_);
+	}
+	
+	else
+	{
+		SCEM etemp;
+		etemp.sddmm(P_U_g2_,ET_,E_);
+		etemp -= L_U_1_g2_;
+		etemp -= L_U_3_g_;
+		etemp -= L_U_g1_2_;
+		L_U_0_g4_.row_sum(etemp);
+		edge_counts(10,etemp);
+	}
+}
+
+// Add the nodes that compute L_U_0_12 when the girth is known to be 8.
+// They follow the nodes of count_ten_cycles_g_6().
+template <class T>
+void Short_Cycle_Engine<T>::count_twelve_cycles_g_8( Short_Cycle_Task_Graph& graph )
+{
+	// The W side matrices that count_ten_cycles_g_6() does not compute.
+	graph.add("P_W_8",this,&SCE::compute_P_W_8).out(P_W_g2_).in(P_W_7_).in(L_W_2_g_).in(L_W_g_2_).in(L_W_0_8_);
+	graph.add("L_W_1_8",this,&SCE::compute_L_W_1_8).out(L_W_1_g2_).in(L_U_0_8_).in(P_W_7_);
+	graph.add("L_W_7_2",this,&SCE::compute_L_W_7_2).out(L_W_g1_2_).in(L_U_g_2_).in(P_W_7_).in(L_W_5_2_)
+		 .in(L_W_0_2_m1_).in(L_W_0_6_).in(L_W_1_2_).in(P_W_5_).in(L_U_0_2_m2_);
+	graph.add("L_W_3_6",this,&SCE::compute_L_W_3_6).out(L_W_3_g_).in(L_U_2_g_).in(L_W_0_2_m1_).in(L_W_1_6_).in(P_W_3_);
+	graph.add("L_W_0_10",this,&SCE::compute_L_W_0_10).out(L_W_0_g4_)
+		 .in(P_W_g2_).in(L_W_1_g2_).in(L_W_3_g_).in(L_W_g1_2_);
+	
+	// Shift the length 10 results down by two.
+	graph.copy("P_U_9",P_U_g1_,P_U_g3_);
+	graph.copy("L_U_0_10",L_U_0_g2_,L_U_0_g4_);
+	graph.copy("L_W_0_10",L_W_0_g2_,L_W_0_g4_);
+	graph.copy("L_U_6_2",L_U_gm2_2_,L_U_g_2_);
+	graph.copy("L_W_6_2",L_W_gm2_2_,L_W_g_2_);
+	graph.copy("L_U_7_2",L_U_gm1_2_,L_U_g1_2_);
+	graph.copy("L_W_7_2",L_W_gm1_2_,L_W_g1_2_);
+	graph.copy("L_U_1_8",L_U_1_g_,L_U_1_g2_);
+	graph.copy("L_W_1_8",L_W_1_g_,L_W_1_g2_);
+	
+	if( rows_ > 0 )
+	{
+		graph.add("L_W_2_8",this,&SCE::compute_L_W_2_8).out(L_W_2_g_).in(L_U_1_g_);
+		graph.add("L_W_8_2",this,&SCE::compute_L_W_8_2).out(L_W_g_2_).in(L_U_gm1_2_).in(L_W_0_2_m1_).in(L_W_gm2_2_)
+			 .in(P_W_6_).in(P_W_2_);
+		Row_Stage stage = { 8, &P_U_6_, &P_U_7_, &P_U_g1_, &L_U_gm2_2_, &L_U_gm1_2_, &L_W_gm1_2_,
+							&L_U_1_g_, &L_W_1_g_, &L_U_0_8_, &L_U_0_g2_, &L_W_0_g2_ };
+		add_row_blocks(graph,stage);
+		return;
+	}
+	
+	graph.add("L_U_2_8",this,&SCE::compute_L_U_2_8).out(L_U_2_g_).in(L_W_1_g_);
+	graph.add("L_W_2_8",this,&SCE::compute_L_W_2_8).out(L_W_2_g_).in(L_U_1_g_);
+	graph.add("L_U_8_2",this,&SCE::compute_L_U_8_2).out(L_U_g_2_).in(L_W_gm1_2_).in(L_U_0_2_m1_).in(L_U_gm2_2_)
+		 .in(P_U_6_).in(P_U_2_);
+	graph.add("L_W_8_2",this,&SCE::compute_L_W_8_2).out(L_W_g_2_).in(L_U_gm1_2_).in(L_W_0_2_m1_).in(L_W_gm2_2_)
+		 .in(P_W_6_).in(P_W_2_);
+	graph.add("P_U_10",this,&SCE::compute_P_U_10).out(P_U_g2_).in(P_U_g1_).in(L_U_2_g_).in(L_U_g_2_).in(L_U_0_g2_);
+	graph.add("L_U_1_10",this,&SCE::compute_L_U_1_10).out(L_U_1_g2_).in(L_W_0_g2_).in(P_U_g1_);
+	graph.add("L_U_3_8",this,&SCE::compute_L_U_3_8).out(L_U_3_g_).in(L_W_2_g_).in(L_U_0_2_m1_).in(L_U_1_g_);
+	graph.add("L_U_9_2",this,&SCE::compute_L_U_9_2).out(L_U_g1_2_).in(L_W_g_2_).in(P_U_g1_).in(L_U_gm1_2_)
+		 .in(L_U_0_2_m1_).in(L_U_0_8_).in(L_U_1_2_).in(P_U_7_).in(L_W_0_2_m2_);
+	graph.add("L_U_0_12",this,&SCE::compute_L_U_0_12).out(L_U_0_g4_)
+		 .in(P_U_g2_).in(L_U_1_g2_).in(L_U_3_g_).in(L_U_g1_2_);
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_P_W_8( void )
+{
+	P_W_g2_.matrix_mult_sym_sub(P_W_7_,E_,L_W_2_g_ + L_W_g_2_);
+	P_W_g2_ -= L_W_0_8_; 
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_W_1_8( void )
+{
+	SCEM etemp;
+	L_W_1_g2_.matrix_mult(ET_,L_U_0_8_);
+	etemp.sample(P_W_7_,ET_);
+	etemp *= 2;
+	L_W_1_g2_ -= etemp;
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_W_7_2( void )
+{
+	SCEM etemp;
+	L_W_g1_2_.matrix_mult(ET_,L_U_g_2_); 
+	etemp.sample(P_W_7_,ET_);
+	L_W_g1_2_ -= etemp; 
+	etemp.sample(L_W_5_2_,ET_);
+	L_W_g1_2_ += etemp;
+	L_W_g1_2_ -= mx_prod(L_W_0_2_m1_,L_W_5_2_);
+	etemp.matrix_mult(L_W_0_6_,L_W_1_2_);
+	L_W_g1_2_ -= etemp;
+	etemp.sample(P_W_5_,ET_);
+	etemp *= 2;
+	L_W_g1_2_ += etemp; 
+	etemp.matrix_mult(etemp,L_U_0_2_m2_);
+	L_W_g1_2_ += etemp;
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_W_3_6( void )
+{
+	SCEM etemp;
+	L_W_3_g_.matrix_mult(ET_,L_U_2_g_); 
+	etemp.matrix_mult(L_W_0_2_m1_,L_W_1_6_);
+	L_W_3_g_ -= etemp;
+	L_W_3_g_ -= P_W_3_.mx_choose_3(6);
+}
+
+// Only the diagonal of P_W_9 is needed, i.e., the row sum of P_W_9 o E^T.
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_W_0_10( void )
+{
+	SCEM etemp;
+	etemp.sddmm(P_W_g2_,E_,ET_);
+	etemp -= L_W_1_g2_;
+	etemp -= L_W_3_g_;
+	etemp -= L_W_g1_2_;
+	L_W_0_g4_.row_sum(etemp);
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_U_2_8( void )
+{
+	L_U_2_g_.mx_mult_zero(E_,L_W_1_g_);
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_W_2_8( void )
+{
+	L_W_2_g_.mx_mult_zero(ET_,L_U_1_g_);
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_U_8_2( void )
+{
+	L_U_g_2_.mx_mult_zero_sub(E_,L_W_gm1_2_,mx_prod(L_U_0_2_m1_,L_U_gm2_2_) - P_U_6_*P_U_2_);
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_W_8_2( void )
+{
+	L_W_g_2_.mx_mult_zero_sub(ET_,L_U_gm1_2_,mx_prod(L_W_0_2_m1_,L_W_gm2_2_) - P_W_6_*P_W_2_);
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_P_U_10( void )
+{
+	P_U_g2_.matrix_mult_sym_sub(P_U_g1_,ET_,L_U_2_g_ + L_U_g_2_);
+	P_U_g2_ -= L_U_0_g2_; 
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_U_1_10( void )
+{
+	SCEM etemp;
+	L_U_1_g2_.matrix_mult(E_,L_W_0_g2_);  
+	etemp.sample(P_U_g1_,E_);
+	etemp *= 2;
+	L_U_1_g2_ -= etemp;
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_U_3_8( void )
+{
+	SCEM etemp;
+	L_U_3_g_.matrix_mult(E_,L_W_2_g_);  
+	etemp.matrix_mult(L_U_0_2_m1_,L_U_1_g_);
+	L_U_3_g_ -= etemp; 
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_U_9_2( void )
+{
+	SCEM etemp;
+	L_U_g1_2_.matrix_mult(E_,L_W_g_2_); 
+	etemp.sample(P_U_g1_,E_);
+	L_U_g1_2_ -= etemp; 
+	etemp.sample(L_U_gm1_2_,E_);
+	L_U_g1_2_ += etemp;
+	L_U_g1_2_ -= mx_prod(L_U_0_2_m1_,L_U_gm1_2_);
+	etemp.matrix_mult(L_U_0_8_,L_U_1_2_);
+	L_U_g1_2_ -= etemp;
+	etemp.sample(P_U_7_,E_);
+	etemp *= 2;
+	L_U_g1_2_ += etemp; 
+	etemp.matrix_mult(etemp,L_W_0_2_m2_);
+	L_U_g1_2_ += etemp;
+}
+
+// Compute L_U_0_12 as the row sum of P_U_11 o E without forming P_U_11.
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_U_0_12( void )
+{
+	SCEM etemp;
+	etemp.sddmm(P_U_g2_,ET_,E_);
+	etemp -= L_U_1_g2_;
+	etemp -= L_U_3_g_;
+	etemp -= L_U_g1_2_;
+	L_U_0_g4_.row_sum(etemp);
+	edge_counts(12,etemp);
+}
+
+// Assumes that count_six_eight_cycles has been called and that the girth
+// is at least 10.  The girth is known (see Short_Cycle_Girth), so the
+// recursions run through the lengths below it without testing their
+// traces for cycles.
+template <class T>
+void Short_Cycle_Engine<T>::count_longer_cycles( void )
+{
+	// No cycle is longer than max_girth.
+	int max_girth = max_cycle_;
+	
+	// Free the matrices that count_six_eight_cycles() kept for the
+	// girths of 6 and 8.
+	P_U_3_.delete_data();
+	P_W_3_.delete_data();
+	L_U_0_2_m2_.delete_data(); 
+	L_W_1_2_.delete_data(); 
+	P_U_4_.delete_data(); 
+	P_W_4_.delete_data();
+	P_U_5_.delete_data();
+	P_W_5_.delete_data(); 
+	L_U_0_6_.delete_data(); 
+	L_W_0_6_.delete_data();
+	P_U_6_.delete_data(); 
+	P_W_6_.delete_data(); 
+	L_U_1_6_.delete_data(); 
+	L_W_1_6_.delete_data();
+	L_U_0_8_.delete_data(); 
+	L_W_0_8_.delete_data();
+	
+	// Starting with the assumption that g_ = 10, initialize the
+	// search for the girth, i.e., compute L_U_6_2, P_U_8, L_U_7_2 and
+	// P_U_9 (and the W side) from L_U_4_2, L_U_5_2 and P_U_7.
+	Short_Cycle_Task_Graph start;
+	start.copy("L_U_4_2",L_U_gm6_2_,L_U_4_2_);
+	start.copy("L_W_4_2",L_W_gm6_2_,L_W_4_2_);
+	start.copy("L_U_5_2",L_U_gm5_2_,L_U_5_2_);
+	start.copy("L_W_5_2",L_W_gm5_2_,L_W_5_2_);
+	start.copy("P_U_7",P_U_gm3_,P_U_7_);
+	start.copy("P_W_7",P_W_gm3_,P_W_7_);
+	search_girth(start);
+	start.run(threads_);
+	
+	// Advance to g = girth_.  The path matrices are exact modulo 2^w, so
+	// only L_U_0_g, which is read, needs to fit in T.
+	for( int gtry = 10; gtry < girth_; gtry += 2 )
+	{
+		// Prepare for next recursion by updating P_U_gm1_, P_W_gm1_, P_U_gm2_, P_W_gm2_.
+		Short_Cycle_Task_Graph step;
+		step.copy("L_U_gm4_2",L_U_gm6_2_,L_U_gm4_2_);
+		step.copy("L_W_gm4_2",L_W_gm6_2_,L_W_gm4_2_);
+		step.copy("L_U_gm3_2",L_U_gm5_2_,L_U_gm3_2_);
+		step.copy("L_W_gm3_2",L_W_gm5_2_,L_W_gm3_2_);
+		step.copy("P_U_gm1",P_U_gm3_,P_U_gm1_);
+		step.copy("P_W_gm1",P_W_gm3_,P_W_gm1_);
+		search_girth(step);
+		step.run(threads_);
+	}
+	
+	g_ = girth_;
+	if( !check_bound(g_) ) return;
+	L_U_0_g_.mx_mult_diag_t(P_U_gm1_,E_);
+	edge_counts(g_,P_U_gm1_);
+	L_W_0_g_.mx_mult_diag_t(P_W_gm1_,ET_);
+	Ng_ = L_U_0_g_.int_trace()/g_;
+	L_U_0_g_.diagonal(Ng_per_u_);
+	
+	// If g = max_girth then there can be no cycles
+	// of length g+2 or g+4.
+	if( g_ >= max_girth )
+	{
+		Ng2_ = Ng4_ = 0;
+		return;
+	}
+	
+	// If g = max_girth-2, there can exist no cycles of length g+4.  The
+	// bounds are checked before the graph is run; a count that is 
+	// abandoned is discarded whole.
+	int g4 = g_ < max_girth-2;
+	if( !check_bound(g_+2) ) return;
+	if( g4 && !check_bound(g_+4) ) return;
+	
+	// Compute Ng2 via L_U_0_g2.  P_W_g1 is only needed for its diagonal, 
+	// the row sum of P_W_g1 o E^T, so it is not formed.
+	Short_Cycle_Task_Graph graph;
+	graph.add("L_U_gm2_2",this,&SCE::compute_L_U_gm2_2).out(L_U_gm2_2_).in(L_W_gm3_2_).in(L_U_0_2_m1_).in(L_U_gm4_2_);
+	graph.add("L_W_gm2_2",this,&SCE::compute_L_W_gm2_2).out(L_W_gm2_2_).in(L_U_gm3_2_).in(L_W_0_2_m1_).in(L_W_gm4_2_);
+	graph.add("P_U_g",this,&SCE::compute_P_U_g).out(P_U_g_).in(P_U_gm1_).in(L_U_gm2_2_).in(L_U_0_g_);
+	graph.add("P_W_g",this,&SCE::compute_P_W_g).out(P_W_g_).in(P_W_gm1_).in(L_W_gm2_2_).in(L_W_0_g_);
+	graph.add("L_U_1_g",this,&SCE::compute_L_U_1_g).out(L_U_1_g_).in(L_W_0_g_).in(P_U_gm1_);
+	graph.add("L_W_1_g",this,&SCE::compute_L_W_1_g).out(L_W_1_g_).in(L_U_0_g_).in(P_W_gm1_);
+	graph.add("L_U_gm1_2",this,&SCE::compute_L_U_gm1_2).out(L_U_gm1_2_).in(L_W_gm2_2_).in(P_U_gm1_)
+		 .in(L_U_0_2_m1_).in(L_U_gm3_2_);
+	graph.add("L_W_gm1_2",this,&SCE::compute_L_W_gm1_2).out(L_W_gm1_2_).in(L_U_gm2_2_).in(P_W_gm1_)
+		 .in(L_W_0_2_m1_).in(L_W_gm3_2_);
+	graph.add("P_U_g1",this,&SCE::compute_P_U_g1).out(P_U_g1_).in(P_U_g_).in(L_U_gm1_2_).in(L_U_1_g_);
+	graph.add("L_U_0_g2",this,&SCE::compute_L_U_0_g2).out(L_U_0_g2_).in(P_U_g1_);
+	graph.add("L_W_0_g2",this,&SCE::compute_L_W_0_g2).out(L_W_0_g2_).in(P_W_g_).in(L_W_1_g_).in(L_W_gm1_2_);
+	graph.keep(L_U_0_g2_);
+	
+	// Compute Ng4 via L_U_0_g4.
+	if( g4 && rows_ > 0 )
+	{
+		graph.add("L_W_2_g",this,&SCE::compute_L_W_2_g).out(L_W_2_g_).in(L_U_1_g_);
+		graph.add("L_W_g_2",this,&SCE::compute_L_W_g_2).out(L_W_g_2_).in(L_U_gm1_2_).in(L_W_0_2_m1_).in(L_W_gm2_2_)
+			 .in(P_W_gm2_).in(P_W_2_);
+		Row_Stage stage = { g_, &P_U_gm2_, &P_U_gm1_, &P_U_g1_, &L_U_gm2_2_, &L_U_gm1_2_, &L_W_gm1_2_,
+							&L_U_1_g_, &L_W_1_g_, &L_U_0_g_, &L_U_0_g2_, &L_W_0_g2_ };
+		add_row_blocks(graph,stage);
+		graph.keep(L_U_0_g4_);
+	}
+	
+	else if( g4 )
+	{
+		graph.add("L_U_2_g",this,&SCE::compute_L_U_2_g).out(L_U_2_g_).in(L_W_1_g_);
+		graph.add("L_W_2_g",this,&SCE::compute_L_W_2_g).out(L_W_2_g_).in(L_U_1_g_);
+		graph.add("L_U_g_2",this,&SCE::compute_L_U_g_2).out(L_U_g_2_).in(L_W_gm1_2_).in(L_U_0_2_m1_).in(L_U_gm2_2_)
+			 .in(P_U_gm2_).in(P_U_2_);
+		graph.add("L_W_g_2",this,&SCE::compute_L_W_g_2).out(L_W_g_2_).in(L_U_gm1_2_).in(L_W_0_2_m1_).in(L_W_gm2_2_)
+			 .in(P_W_gm2_).in(P_W_2_);
+		graph.add("P_U_g2",this,&SCE::compute_P_U_g2).out(P_U_g2_).in(P_U_g1_).in(L_U_2_g_).in(L_U_g_2_).in(L_U_0_g2_);
+		graph.add("L_U_1_g2",this,&SCE::compute_L_U_1_g2).out(L_U_1_g2_).in(L_W_0_g2_).in(P_U_g1_);
+		graph.add("L_U_3_g",this,&SCE::compute_L_U_3_g).out(L_U_3_g_).in(L_W_2_g_).in(L_U_0_2_m1_).in(L_U_1_g_);
+		graph.add("L_U_g1_2",this,&SCE::compute_L_U_g1_2).out(L_U_g1_2_).in(L_W_g_2_).in(P_U_g1_).in(L_U_gm1_2_)
+			 .in(L_U_0_2_m1_).in(L_U_0_g_).in(L_U_1_2_).in(P_U_gm1_).in(L_W_0_2_m2_);
+		graph.add("L_U_0_g4",this,&SCE::compute_L_U_0_g4).out(L_U_0_g4_)
+			 .in(P_U_g2_).in(L_U_1_g2_).in(L_U_3_g_).in(L_U_g1_2_);
+		graph.keep(L_U_0_g4_);
+	}
+	
+	graph.run(threads_);
+	
+	Ng2_ = L_U_0_g2_.int_trace()/(g_+2);
+	L_U_0_g2_.diagonal(Ng2_per_u_);
+	if( !g4 )
+	{
+		Ng4_ = 0;
+		return;
+	}
+	
+	Ng4_ = L_U_0_g4_.int_trace()/(g_+4);
+	L_U_0_g4_.diagonal(Ng4_per_u_);
+}
+
+// Add the nodes that compute L_U_gm4_2, P_U_gm2, L_U_gm3_2 and P_U_gm1
+// (and the W side) from L_U_gm6_2, L_U_gm5_2 and P_U_gm3, i.e., that
+// advance the girth search by two.  Only the results are kept.
+template <class T>
+void Short_Cycle_Engine<T>::search_girth( Short_Cycle_Task_Graph& graph )
+{
+	graph.add("L_U_gm4_2",this,&SCE::compute_L_U_gm4_2).out(L_U_gm4_2_).in(L_W_gm5_2_).in(L_U_0_2_m1_).in(L_U_gm6_2_);
+	graph.add("L_W_gm4_2",this,&SCE::compute_L_W_gm4_2).out(L_W_gm4_2_).in(L_U_gm5_2_).in(L_W_0_2_m1_).in(L_W_gm6_2_);
+	graph.add("P_U_gm2",this,&SCE::compute_P_U_gm2).out(P_U_gm2_).in(P_U_gm3_).in(L_U_gm4_2_);
+	graph.add("P_W_gm2",this,&SCE::compute_P_W_gm2).out(P_W_gm2_).in(P_W_gm3_).in(L_W_gm4_2_);
+	graph.add("L_U_gm3_2",this,&SCE::compute_L_U_gm3_2).out(L_U_gm3_2_).in(L_W_gm4_2_).in(L_U_0_2_m1_).in(L_U_gm5_2_);
+	graph.add("L_W_gm3_2",this,&SCE::compute_L_W_gm3_2).out(L_W_gm3_2_).in(L_U_gm4_2_).in(L_W_0_2_m1_).in(L_W_gm5_2_);
+	graph.add("P_U_gm1",this,&SCE::compute_P_U_gm1).out(P_U_gm1_).in(P_U_gm2_).in(L_U_gm3_2_);
+	graph.add("P_W_gm1",this,&SCE::compute_P_W_gm1).out(P_W_gm1_).in(P_W_gm2_).in(L_W_gm3_2_);
+	graph.keep(L_U_gm4_2_).keep(L_W_gm4_2_).keep(P_U_gm2_).keep(P_W_gm2_)
+		 .keep(L_U_gm3_2_).keep(L_W_gm3_2_).keep(P_U_gm1_).keep(P_W_gm1_)
+		 .keep(L_U_0_2_m1_).keep(L_W_0_2_m1_);
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_U_gm4_2( void )
+{
+	L_U_gm4_2_.matrix_mult_sub(E_,L_W_gm5_2_,mx_prod(L_U_0_2_m1_,L_U_gm6_2_));
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_W_gm4_2( void )
+{
+	L_W_gm4_2_.matrix_mult_sub(ET_,L_U_gm5_2_,mx_prod(L_W_0_2_m1_,L_W_gm6_2_));
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_P_U_gm2( void )
+{
+	P_U_gm2_.matrix_mult_sym_sub(P_U_gm3_,ET_,L_U_gm4_2_);
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_P_W_gm2( void )
+{
+	P_W_gm2_.matrix_mult_sym_sub(P_W_gm3_,E_,L_W_gm4_2_);
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_U_gm3_2( void )
+{
+	L_U_gm3_2_.matrix_mult_sub(E_,L_W_gm4_2_,mx_prod(L_U_0_2_m1_,L_U_gm5_2_));
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_W_gm3_2( void )
+{
+	L_W_gm3_2_.matrix_mult_sub(ET_,L_U_gm4_2_,mx_prod(L_W_0_2_m1_,L_W_gm5_2_));
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_P_U_gm1( void )
+{
+	P_U_gm1_.matrix_mult_sub(P_U_gm2_,E_,L_U_gm3_2_);
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_P_W_gm1( void )
+{
+	P_W_gm1_.matrix_mult_sub(P_W_gm2_,ET_,L_W_gm3_2_);
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_U_gm2_2( void )
+{
+	L_U_gm2_2_.matrix_mult_sub(E_,L_W_gm3_2_,mx_prod(L_U_0_2_m1_,L_U_gm4_2_));
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_W_gm2_2( void )
+{
+	L_W_gm2_2_.matrix_mult_sub(ET_,L_U_gm3_2_,mx_prod(L_W_0_2_m1_,L_W_gm4_2_));
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_P_U_g( void )
+{
+	P_U_g_.matrix_mult_sym_sub(P_U_gm1_,ET_,L_U_gm2_2_);
+	P_U_g_ -= L_U_0_g_; 
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_P_W_g( void )
+{
+	P_W_g_.matrix_mult_sym_sub(P_W_gm1_,E_,L_W_gm2_2_);
+	P_W_g_ -= L_W_0_g_; 
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_U_1_g( void )
+{
+	SCEM etemp;
+	L_U_1_g_.matrix_mult(E_,L_W_0_g_);  
+	etemp.sample(P_U_gm1_,E_);
+	etemp *= 2;
+	L_U_1_g_ -= etemp;
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_W_1_g( void )
+{
+	SCEM etemp;
+	L_W_1_g_.matrix_mult(ET_,L_U_0_g_); 
+	etemp.sample(P_W_gm1_,ET_);
+	etemp *= 2;
+	L_W_1_g_ -= etemp;
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_U_gm1_2( void )
+{
+	SCEM etemp;
+	L_U_gm1_2_.matrix_mult(E_,L_W_gm2_2_); 
+	etemp.sample(P_U_gm1_,E_);
+	L_U_gm1_2_ -= etemp;
+	L_U_gm1_2_ -= mx_prod(L_U_0_2_m1_,L_U_gm3_2_);
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_W_gm1_2( void )
+{
+	SCEM etemp;
+	L_W_gm1_2_.matrix_mult(ET_,L_U_gm2_2_); 
+	etemp.sample(P_W_gm1_,ET_);
+	L_W_gm1_2_ -= etemp;
+	L_W_gm1_2_ -= mx_prod(L_W_0_2_m1_,L_W_gm3_2_);
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_P_U_g1( void )
+{
+	P_U_g1_.matrix_mult_sub(P_U_g_,E_,L_U_gm1_2_);
+	P_U_g1_ -= L_U_1_g_; 
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_U_0_g2( void )
+{
+	L_U_0_g2_.mx_mult_diag_t(P_U_g1_,E_);
+	edge_counts(g_+2,P_U_g1_);
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_W_0_g2( void )
+{
+	SCEM etemp;
+	etemp.sddmm(P_W_g_,E_,ET_);
+	etemp -= L_W_1_g_;
+	etemp -= L_W_gm1_2_;
+	L_W_0_g2_.row_sum(etemp);
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_U_2_g( void )
+{
+	L_U_2_g_.mx_mult_zero(E_,L_W_1_g_);
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_W_2_g( void )
+{
+	L_W_2_g_.mx_mult_zero(ET_,L_U_1_g_);   
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_U_g_2( void )
+{
+	L_U_g_2_.mx_mult_zero_sub(E_,L_W_gm1_2_,mx_prod(L_U_0_2_m1_,L_U_gm2_2_) - P_U_gm2_*P_U_2_);
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_W_g_2( void )
+{
+	L_W_g_2_.mx_mult_zero_sub(ET_,L_U_gm1_2_,mx_prod(L_W_0_2_m1_,L_W_gm2_2_) - P_W_gm2_*P_W_2_);
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_P_U_g2( void )
+{
+	P_U_g2_.matrix_mult_sym_sub(P_U_g1_,ET_,L_U_2_g_ + L_U_g_2_);
+	P_U_g2_ -= L_U_0_g2_; 
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_U_1_g2( void )
+{
+	SCEM etemp;
+	L_U_1_g2_.matrix_mult(E_,L_W_0_g2_); 
+	etemp.sample(P_U_g1_,E_);
+	etemp *= 2;
+	L_U_1_g2_ -= etemp;
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_U_3_g( void )
+{
+	SCEM etemp;
+	L_U_3_g_.matrix_mult(E_,L_W_2_g_); 
+	etemp.matrix_mult(L_U_0_2_m1_,L_U_1_g_);
+	L_U_3_g_ -= etemp;
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_U_g1_2( void )
+{
+	SCEM etemp;
+	L_U_g1_2_.matrix_mult(E_,L_W_g_2_); 
+	etemp.sample(P_U_g1_,E_);
+	L_U_g1_2_ -= etemp; 
+	etemp.sample(L_U_gm1_2_,E_);
+	L_U_g1_2_ += etemp; 
+	L_U_g1_2_ -= mx_prod(L_U_0_2_m1_,L_U_gm1_2_);
+	etemp.matrix_mult(L_U_0_g_,L_U_1_2_);
+	L_U_g1_2_ -= etemp; 
+	etemp.sample(P_U_gm1_,E_);
+	etemp *= 2;
+	L_U_g1_2_ += etemp; 
+	etemp.matrix_mult(etemp,L_W_0_2_m2_);
+	L_U_g1_2_ += etemp;
+}
+
+// L_U_0_g4 is the row sum of P_U_g3 o E, so P_U_g3 is not formed.
+template <class T>
+void Short_Cycle_Engine<T>::compute_L_U_0_g4( void )
+{
+	SCEM etemp;
+	etemp.sddmm(P_U_g2_,ET_,E_);
+	etemp -= L_U_1_g2_;
+	etemp -= L_U_3_g_;
+	etemp -= L_U_g1_2_;
+	L_U_0_g4_.row_sum(etemp);
+	edge_counts(g_+4,etemp);
+}
+
+// Calls engine->count_rows(r0,r1).
+template <class T>
+class Short_Cycle_Engine<T>::Row_Task : public Short_Cycle_Task
+{
+  public:
+	Row_Task( Short_Cycle_Engine* engine, int r0, int r1 ) : engine_(engine), r0_(r0), r1_(r1) {};
+	void run( void ) { engine_->count_rows(r0_,r1_); };
+	
+  private:
+	Short_Cycle_Engine* engine_;
+	int r0_, r1_;
+};
+
+// Add a node per block of rows_ rows of U, rounded up to a multiple of
+// SCM_PAD.  The blocks write disjoint elements of L_U_0_g4, which they
+// declare as read so that the graph runs them in parallel.
+template <class T>
+void Short_Cycle_Engine<T>::add_row_blocks( Short_Cycle_Task_Graph& graph, const Row_Stage& stage )
+{
+	stage_ = stage;
+	graph.add("L_U_0_g4",this,&SCE::clear_L_U_0_g4).out(L_U_0_g4_);
+	
+	int rows = (rows_+SCM_PAD-1)/SCM_PAD*SCM_PAD;
+	int n = SCM::internal_dim(U_);
+	for( int r0 = 0; r0 < U_; r0 += rows )
+	{
+		graph.add("L_U_0_g4 rows",new Row_Task(this,r0,(r0+rows < n ? r0+rows : n))).in(L_U_0_g4_)
+			 .in(*stage.P_U_gm2).in(*stage.P_U_gm1).in(*stage.P_U_g1)
+			 .in(*stage.L_U_gm2_2).in(*stage.L_U_gm1_2).in(*stage.L_W_gm1_2)
+			 .in(*stage.L_U_1_g).in(*stage.L_W_1_g)
+			 .in(*stage.L_U_0_g).in(*stage.L_U_0_g2).in(*stage.L_W_0_g2)
+			 .in(L_W_2_g_).in(L_W_g_2_).in(P_U_2_).in(L_U_0_2_m1_).in(L_U_1_2_).in(L_W_0_2_m2_);
+		if( stage.g == 6 ) graph.in(P_U_3_);
+	}
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::clear_L_U_0_g4( void )
+{
+	L_U_0_g4_.set_e_n(U_);
+	L_U_0_g4_.reset_data();
+}
+
+// out = Z(left \times right) - sub where the rows of out are rows r0 and
+// on of a square matrix.
+template <class T, class X>
+static void mx_mult_zero_sub_rows( Short_Cycle_Matrix<T>& out, const Short_Cycle_Sparse_Matrix& left,
+								   const Short_Cycle_Matrix<T>& right, const Mx_Expr<T,X>& sub, int r0 )
+{
+	Mx_Sub_Row<T,X> epilogue(sub.self());
+	Mx_Zero_Diag<T> zero(&epilogue,r0);
+	out.matrix_mult(left,right,&zero);
+}
+
+// Rows r0 ... r1-1 of L_U_0_g4.  The U side matrices of the stage are
+// formed for those rows only, as by compute_L_U_2_g() through
+// compute_L_U_0_g4() with E and the U side operands restricted to the
+// rows.  Row rr of the block is row r0+rr of U.
+template <class T>
+void Short_Cycle_Engine<T>::count_rows( int r0, int r1 )
+{
+	const Row_Stage& s = stage_;
+	SCSM E_B;
+	E_B.copy_rows(E_,r0,r1);
+	
+	// The rows of the operands.
+	SCM P_U_2, P_U_3, P_U_gm2, P_U_gm1, P_U_g1, L_U_gm2_2, L_U_gm1_2;
+	SCDM L_U_0_2_m1, L_U_0_g;
+	SCEM L_U_1_2, L_U_1_g;
+	P_U_2.view_rows(P_U_2_,r0,r1);
+	if( s.g == 6 ) P_U_3.view_rows(P_U_3_,r0,r1);
+	P_U_gm2.view_rows(*s.P_U_gm2,r0,r1);
+	P_U_gm1.view_rows(*s.P_U_gm1,r0,r1);
+	P_U_g1.view_rows(*s.P_U_g1,r0,r1);
+	L_U_gm2_2.view_rows(*s.L_U_gm2_2,r0,r1);
+	L_U_gm1_2.view_rows(*s.L_U_gm1_2,r0,r1);
+	L_U_0_2_m1.view_rows(L_U_0_2_m1_,r0,r1);
+	L_U_0_g.view_rows(*s.L_U_0_g,r0,r1);
+	L_U_1_2.view_rows(L_U_1_2_,E_B,r0);
+	L_U_1_g.view_rows(*s.L_U_1_g,E_B,r0);
+	
+	// P_U_g2, with the diagonal of the block at column r0+rr.
+	SCM L_U_2_g, L_U_g_2, P_U_g2;
+	Mx_Zero_Diag<T> zero(NULL,r0);
+	L_U_2_g.matrix_mult(E_B,*s.L_W_1_g,&zero);
+	mx_mult_zero_sub_rows(L_U_g_2,E_B,*s.L_W_gm1_2,mx_prod(L_U_0_2_m1,L_U_gm2_2) - P_U_gm2*P_U_2,r0);
+	P_U_g2.matrix_mult_sub(P_U_g1,ET_,L_U_2_g + L_U_g_2);
+	for( int rr = 0; rr < E_B.e_nr(); rr++ ) 
+		P_U_g2.dec_el((size_t)rr*P_U_g2.i_nc()+r0+rr,(*s.L_U_0_g2)[r0+rr]);
+	L_U_2_g.delete_data();
+	L_U_g_2.delete_data();
+	
+	SCEM L_U_1_g2, etemp;
+	L_U_1_g2.matrix_mult(E_B,*s.L_W_0_g2);
+	etemp.sample(P_U_g1,E_B);
+	etemp *= 2;
+	L_U_1_g2 -= etemp;
+	
+	SCM L_U_3_g;
+	L_U_3_g.matrix_mult(E_B,L_W_2_g_);
+	etemp.matrix_mult(L_U_0_2_m1,L_U_1_g);
+	L_U_3_g -= etemp;
+	if( s.g == 6 ) L_U_3_g -= P_U_3.mx_choose_3(6);
+	
+	SCM L_U_g1_2;
+	L_U_g1_2.matrix_mult(E_B,L_W_g_2_);
+	etemp.sample(P_U_g1,E_B);
+	L_U_g1_2 -= etemp;
+	etemp.sample(L_U_gm1_2,E_B);
+	L_U_g1_2 += etemp;
+	L_U_g1_2 -= mx_prod(L_U_0_2_m1,L_U_gm1_2);
+	etemp.matrix_mult(L_U_0_g,L_U_1_2);
+	L_U_g1_2 -= etemp;
+	etemp.sample(P_U_gm1,E_B);
+	etemp *= 2;
+	L_U_g1_2 += etemp;
+	etemp.matrix_mult(etemp,L_W_0_2_m2_);
+	L_U_g1_2 += etemp;
+	
+	SCDM L_U_0_g4;
+	etemp.sddmm(P_U_g2,ET_,E_B);
+	etemp -= L_U_1_g2;
+	etemp -= L_U_3_g;
+	etemp -= L_U_g1_2;
+	L_U_0_g4.row_sum(etemp);
+	edge_counts(s.g+4,etemp,E_.row_ptr()[r0]);
+	for( int rr = 0; rr < E_B.e_nr(); rr++ ) L_U_0_g4_.set_el(r0+rr,L_U_0_g4[rr]);
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::process_P_U_2( void )
+{
+	P_U_2_.matrix_mult_sym(E_,ET_);
+	
+	L_U_0_2_m1_.set_e_n(E_.e_nr());
+	L_U_0_2_m2_.set_e_n(E_.e_nr());
+	L_U_0_2_m1_.reset_data();
+	L_U_0_2_m2_.reset_data();	
+	
+	// The diagonal, the vertex degrees, is moved into the m1 and m2 matrices
+	// and zeroed so that the binomial coefficients are formed by one branch
+	// free pass.  Only the generating rows are stored if P is lifted.
+	const int* row_ptr = E_.row_ptr();
+	for( int rr = 0; rr < E_.e_nr(); rr++ )
+	{
+		T val = (T)(row_ptr[rr+1]-row_ptr[rr]);
+		if( val > 1 ) L_U_0_2_m1_.set_el(rr,val-1);
+		if( val > 2 ) L_U_0_2_m2_.set_el(rr,val-2);
+	}
+	
+	size_t pp = 0;
+	for( int rr = 0; rr < P_U_2_.e_nr(); rr++, pp += P_U_2_.i_nc()+1 ) P_U_2_.set_el(pp,0);
+	
+	P_U_2_c2_ = P_U_2_.mx_choose_2(1);
+}
+
+template <class T>
+void Short_Cycle_Engine<T>::process_P_W_2( void )
+{
+	P_W_2_.matrix_mult_sym(ET_,E_);
+	
+	L_W_0_2_m1_.set_e_n(ET_.e_nr());
+	L_W_0_2_m2_.set_e_n(ET_.e_nr());
+	L_W_0_2_m1_.reset_data();
+	L_W_0_2_m2_.reset_data();	
+	
+	// The diagonal, the vertex degrees, is moved into the m1 and m2 matrices
+	// and zeroed so that the binomial coefficients are formed by one branch
+	// free pass.  Only the generating rows are stored if P is lifted.
+	const int* row_ptr = ET_.row_ptr();
+	for( int rr = 0; rr < ET_.e_nr(); rr++ )
+	{
+		T val = (T)(row_ptr[rr+1]-row_ptr[rr]);
+		if( val > 1 ) L_W_0_2_m1_.set_el(rr,val-1);
+		if( val > 2 ) L_W_0_2_m2_.set_el(rr,val-2);
+	}
+	
+	size_t pp = 0;
+	for( int rr = 0; rr < P_W_2_.e_nr(); rr++, pp += P_W_2_.i_nc()+1 ) P_W_2_.set_el(pp,0);
+	
+	P_W_2_c2_ = P_W_2_.mx_choose_2(1);
+}
+
+// Explicit instantiations for the supported element types.
+template class Short_Cycle_Engine<uint32_t>;
+template class Short_Cycle_Engine<uint64_t>;
@@ -0,0 +1,290 @@
+/* Short_Cycle_Engine.h
+
+   Copyright (c) 2005 Thomas R. Halford 
+   All rights reserved.
+ 
+   Developed by: Thomas R. Halford
+                 Communication Sciences Institute
+                 University of Southern California
+                 http://csi.usc.edu
+ 
+   Permission is hereby granted, free of charge, to any person obtaining a copy 
+   of this software and associated documentation files (the "Software"), to deal 
+   with the Software without restriction, including without limitation the rights 
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+   copies of the Software, and to permit persons to whom the Software is furnished 
+   to do so, subject to the following conditions:
+  
+    * Redistributions of source code must retain the above copyright notice, this 
+      list of conditions and the following disclaimers.
+    * Redistributions in binary form must reproduce the above copyright notice, 
+      this list of conditions and the following disclaimers in the documentation 
+      and/or other materials provided with the distribution.
+    * Neither the names of Thomas R. Halford, the Communication Sciences Institute, 
+      the University of Southern California nor the names of its contributors may 
+      be used to endorse or promote products derived from this Software without 
+      specific prior written permission. 
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+   INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+   PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE CONTRIBUTORS OR 
+   COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN 
+   AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION 
+   WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE SOFTWARE.
+*/
+
+// Short_Cycle_Engine.h implements the matrix recursions of the short
+// cycle counting algorithm for a given matrix element type T.  The
+// engine is created by Short_Cycle_Counter::count() and writes the
+// girth and cycle counts back into the counter.  Unsigned arithmetic
+// is exact modulo 2^w so only the L_{(0,k)} diagonals that are read
+// out must be representable in T; see check_bound().
+//
+// Each stage of the recursions is a Short_Cycle_Task_Graph whose nodes
+// are the compute_*() methods, one per matrix, and which runs on the
+// thread pool of the counter.  The graph frees each matrix after its last
+// use.  The U and W side recursions are largely independent and run in
+// parallel.  The girth and the counts are read out between the graphs.
+//
+// The last U side stage, which gives L_{(0,g+4)}^\mathcal{U}, may instead
+// be run in blocks of U rows (see Short_Cycle_Counter::set_block_rows()).
+// Every matrix of the W side and every diagonal it reads is complete by
+// then, so each block forms its rows of the U side matrices of the stage
+// from the rows of the earlier ones and the blocks are independent.
+
+#ifndef SHORT_CYCLE_ENGINE
+#define SHORT_CYCLE_ENGINE
+
+#include <stdint.h>
+#include <vector>
+#include "Short_Cycle_Matrix.h"
+#include "Short_Cycle_Sparse_Matrix.h"
+#include "Short_Cycle_Diag_Matrix.h"
+#include "Short_Cycle_Edge_Matrix.h"
+#include "Short_Cycle_Tasks.h"
+
+class Short_Cycle_Counter;
+
+template <class T>
+class Short_Cycle_Engine
+{
+  public:
+	Short_Cycle_Engine( Short_Cycle_Counter& counter );
+	
+	// Count cycles of length g, g+2 and g+4.  Returns 0 if the count
+	// was abandoned because T is too narrow.
+	int count( void );
+	
+  private:
+	typedef Short_Cycle_Matrix<T> SCM;
+	typedef Short_Cycle_Sparse_Matrix SCSM;
+	typedef Short_Cycle_Diag_Matrix<T> SCDM;
+	typedef Short_Cycle_Edge_Matrix<T> SCEM;
+	typedef Short_Cycle_Engine<T> SCE;
+	
+	// Cycle counting helpers.  
+	int  count_four_cycles( void );
+	void count_six_eight_cycles( void );
+	void count_ten_cycles_g_6( Short_Cycle_Task_Graph& graph );
+	void count_twelve_cycles_g_8( Short_Cycle_Task_Graph& graph );
+	void count_longer_cycles( void );
+	void search_girth( Short_Cycle_Task_Graph& graph );
+	
+	// The task graph nodes.  Each computes the matrix it is named after.
+	void process_P_U_2( void );
+	void process_P_W_2( void );
+	void compute_L_U_1_2( void );
+	void compute_L_W_1_2( void );
+	void compute_P_U_3( void );
+	void compute_P_W_3( void );
+	void compute_L_U_0_4( void );
+	void compute_L_W_0_4( void );
+	
+	void compute_L_U_2_2( void );
+	void compute_L_W_2_2( void );
+	void compute_P_U_4( void );
+	void compute_P_W_4( void );
+	void compute_L_U_1_4( void );
+	void compute_L_W_1_4( void );
+	void compute_L_U_3_2( void );
+	void compute_L_W_3_2( void );
+	void compute_P_U_5( void );
+	void compute_P_W_5( void );
+	void compute_L_U_0_6( void );
+	void compute_L_W_0_6( void );
+	void compute_L_U_2_4( void );
+	void compute_L_W_2_4( void );
+	void compute_L_U_4_2( void );
+	void compute_L_W_4_2( void );
+	void compute_P_U_6( void );
+	void compute_P_W_6( void );
+	void compute_L_U_1_6( void );
+	void compute_L_W_1_6( void );
+	void compute_L_U_3_4( void );
+	void compute_L_U_5_2( void );
+	void compute_L_W_5_2( void );
+	void compute_P_U_7( void );
+	void compute_P_W_7( void );
+	void compute_L_U_0_8( void );
+	void compute_L_W_0_8( void );
+	
+	void compute_L_U_2_6( void );
+	void compute_L_W_2_6( void );
+	void compute_L_U_6_2( void );
+	void compute_L_W_6_2( void );
+	void compute_P_U_8( void );
+	void compute_L_U_1_8( void );
+	void compute_L_U_3_6( void );
+	void compute_L_U_7_2( void );
+	void compute_L_U_0_10( void );
+	
+	void compute_P_W_8( void );
+	void compute_L_W_1_8( void );
+	void compute_L_W_7_2( void );
+	void compute_L_W_3_6( void );
+	void compute_L_W_0_10( void );
+	void compute_L_U_2_8( void );
+	void compute_L_W_2_8( void );
+	void compute_L_U_8_2( void );
+	void compute_L_W_8_2( void );
+	void compute_P_U_10( void );
+	void compute_L_U_1_10( void );
+	void compute_L_U_3_8( void );
+	void compute_L_U_9_2( void );
+	void compute_L_U_0_12( void );
+	
+	void compute_L_U_gm4_2( void );
+	void compute_L_W_gm4_2( void );
+	void compute_P_U_gm2( void );
+	void compute_P_W_gm2( void );
+	void compute_L_U_gm3_2( void );
+	void compute_L_W_gm3_2( void );
+	void compute_P_U_gm1( void );
+	void compute_P_W_gm1( void );
+	void compute_L_U_gm2_2( void );
+	void compute_L_W_gm2_2( void );
+	void compute_P_U_g( void );
+	void compute_P_W_g( void );
+	void compute_L_U_1_g( void );
+	void compute_L_W_1_g( void );
+	void compute_L_U_gm1_2( void );
+	void compute_L_W_gm1_2( void );
+	void compute_P_U_g1( void );
+	void compute_L_U_0_g2( void );
+	void compute_L_W_0_g2( void );
+	void compute_L_U_2_g( void );
+	void compute_L_W_2_g( void );
+	void compute_L_U_g_2( void );
+	void compute_L_W_g_2( void );
+	void compute_P_U_g2( void );
+	void compute_L_U_1_g2( void );
+	void compute_L_U_3_g( void );
+	void compute_L_U_g1_2( void );
+	void compute_L_U_0_g4( void );
+	
+	// The matrices of the earlier stages read by the last U side stage.
+	struct Row_Stage
+	{
+		int g;
+		const SCM *P_U_gm2, *P_U_gm1, *P_U_g1;
+		const SCM *L_U_gm2_2, *L_U_gm1_2, *L_W_gm1_2;
+		const SCEM *L_U_1_g, *L_W_1_g;
+		const SCDM *L_U_0_g, *L_U_0_g2, *L_W_0_g2;
+	};
+	
+	// Add the nodes of the last U side stage in blocks of rows_ rows.
+	class Row_Task;
+	friend class Row_Task;
+	void add_row_blocks( Short_Cycle_Task_Graph& graph, const Row_Stage& stage );
+	void clear_L_U_0_g4( void );
+	void count_rows( int r0, int r1 ); // Rows r0 ... r1-1 of L_U_0_g4.
+	
+	// Check that the diagonal of L_{(0,k)} fits in T.
+	int check_bound( int k );
+	
+	// Write the cycles of length k through each edge, the elements of
+	// P_{k-1}^\mathcal{U} o E, to the counter if k is g, g+2 or g+4.  An
+	// edge matrix may hold the edges from first on.
+	void edge_counts( int k, const SCM& P );
+	void edge_counts( int k, const SCEM& e, int first = 0 );
+	
+	// The counter results are written through these references.
+	Short_Cycle_Counter& counter_;
+	int			U_;			// |\mathcal{U}|
+	int			W_;			// |\mathcal{W}|
+	int&		g_;			// girth
+	int64_t&	Ng_;		// N_g
+	int64_t&	Ng2_;		// N_{g+2}
+	int64_t&	Ng4_;		// N_{g+4}
+	double*		Ng_per_u_;
+	double*		Ng2_per_u_;
+	double*		Ng4_per_u_;
+	std::vector<double>& Ng_per_edge_;
+	std::vector<double>& Ng2_per_edge_;
+	std::vector<double>& Ng4_per_edge_;
+	const SCSM& E_;			// The incidence matrix and its transpose.
+	const SCSM& ET_;
+	Short_Cycle_Thread_Pool* threads_;
+	int			rows_;		// Rows per block of the last stage, 0 for none.
+	int			girth_;		// See Short_Cycle_Girth.
+	int			max_cycle_;
+	Row_Stage	stage_;
+	int			overflow_;	// Set if the count was abandoned.
+	
+	// Matrices required by the cycle counter.  Note that
+	// the memory required by each matrix is allocated only when
+	// the matrix is first required and freed as soon as possible
+	// in order to minimize the memory footprint.  Temporaries are
+	// local to the nodes.
+	
+	// Matrices used to count short cycles (4,6,8).
+	SCM P_U_2_, P_W_2_;				 // P_2^\mathcal{U,W}
+	SCM P_U_2_c2_, P_W_2_c2_;		 // \binom{P_2^\mathcal{U,W}}{2}
+	SCM P_U_3_, P_W_3_;				 // P_3^\mathcal{U,W}
+	SCM P_U_4_, P_W_4_;				 // P_4^\mathcal{U,W}
+	SCM P_U_5_, P_W_5_;				 // P_5^\mathcal{U,W}
+	SCM P_U_6_, P_W_6_;				 // P_6^\mathcal{U,W}
+	SCM P_U_7_, P_W_7_;				 // P_7^\mathcal{U,W}
+	SCDM L_U_0_2_m1_, L_W_0_2_m1_;   // \max{L_{(0,2)}^\mathcal{U,W}-1,0}
+	SCDM L_U_0_2_m2_, L_W_0_2_m2_;   // \max{L_{(0,2)}^\mathcal{U,W}-2,0}
+	SCEM L_U_1_2_, L_W_1_2_;		   // L_{(1,2)}^\mathcal{U,W}
+	SCDM L_U_0_4_, L_W_0_4_;         // L_{(0,4)}^\mathcal{U,W}
+	SCM L_U_2_2_, L_W_2_2_;			 // L_{(2,2)}^\mathcal{U,W}
+	SCEM L_U_1_4_, L_W_1_4_;		   // L_{(1,4)}^\mathcal{U,W}
+	SCM L_U_3_2_, L_W_3_2_;			 // L_{(3,2)}^\mathcal{U,W}
+	SCDM L_U_0_6_, L_W_0_6_;         // L_{(0,6)}^\mathcal{U,W}
+	SCM L_U_2_4_, L_W_2_4_;			 // L_{(2,4)}^\mathcal{U,W}
+	SCM L_U_4_2_, L_W_4_2_;			 // L_{(4,2)}^\mathcal{U,W}
+	SCEM L_U_1_6_, L_W_1_6_;		   // L_{(1,6)}^\mathcal{U,W}
+	SCM L_U_3_4_;					 // L_{(3,4)}^\mathcal{U}
+	SCM L_U_5_2_, L_W_5_2_;			 // L_{(5,2)}^\mathcal{U,W}
+	SCDM L_U_0_8_, L_W_0_8_;         // L_{(0,8)}^\mathcal{U,W}
+	
+	SCM Big_Term_A_, Big_Term_B_, Big_Term_C_, Big_Term_D_;
+	
+	// Long cycle matrices.
+	SCM P_U_gm3_, P_W_gm3_;		 // P_{g-3}^\mathcal{U,W}
+	SCM P_U_gm2_, P_W_gm2_;		 // P_{g-2}^\mathcal{U,W}
+	SCM P_U_gm1_, P_W_gm1_;      // P_{g-1}^\mathcal{U,W}
+	SCM P_U_g_, P_W_g_;			 // P_g^\mathcal{U,W}
+	SCM P_U_g1_;				 // P_{g+1}^\mathcal{U}
+	SCM P_U_g2_, P_W_g2_;		 // P_{g+2}^\mathcal{U,W}
+	SCM P_U_g3_;				 // P_{g+3}^\mathcal{U}
+	SCDM L_U_0_g_, L_W_0_g_;     // L_{(0,g)}^\mathcal{U,W}
+	SCDM L_U_0_g2_, L_W_0_g2_;   // L_{(0,g+2)}^\mathcal{U,W}
+	SCDM L_U_0_g4_, L_W_0_g4_;   // L_{(0,g+4)}^\mathcal{U,W}
+	SCEM L_U_1_g_, L_W_1_g_;      // L_{(1,g)}^\mathcal{U,W}
+	SCEM L_U_1_g2_, L_W_1_g2_;    // L_{(1,g+2)}^\mathcal{U,W}
+	SCM L_U_2_g_, L_W_2_g_;      // L_{(2,g)}^\mathcal{U,W}
+	SCM L_U_3_g_, L_W_3_g_;		 // L_{(3,g)}^\mathcal{U,W}
+	SCM L_U_gm6_2_, L_W_gm6_2_;  // L_{(g-6,2)}^\mathcal{U,W}
+	SCM L_U_gm5_2_, L_W_gm5_2_;  // L_{(g-5,2)}^\mathcal{U,W}
+	SCM L_U_gm4_2_, L_W_gm4_2_;  // L_{(g-4,2)}^\mathcal{U,W}
+	SCM L_U_gm3_2_, L_W_gm3_2_;  // L_{(g-3,2)}^\mathcal{U,W}
+	SCM L_U_gm2_2_, L_W_gm2_2_;  // L_{(g-2,2)}^\mathcal{U,W}
+	SCM L_U_gm1_2_, L_W_gm1_2_;  // L_{(g-1,2)}^\mathcal{U,W}
+	SCM L_U_g_2_, L_W_g_2_;      // L_{(g,2)}^\mathcal{U,W}
+	SCM L_U_g1_2_, L_W_g1_2_;    // L_{(g+1,2)}^\mathcal{U,W}
+};
+
+#endif
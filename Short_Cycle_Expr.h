@@ -0,0 +1,275 @@
+/* Short_Cycle_Expr.h
+
+   Copyright (c) 2005 Thomas R. Halford 
+   All rights reserved.
+ 
+   Developed by: Thomas R. Halford
+                 Communication Sciences Institute
+                 University of Southern California
+                 http://csi.usc.edu
+ 
+   Permission is hereby granted, free of charge, to any person obtaining a copy 
+   of this software and associated documentation files (the "Software"), to deal 
+   with the Software without restriction, including without limitation the rights 
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+   copies of the Software, and to permit persons to whom the Software is furnished 
+   to do so, subject to the following conditions:
+  
+    * Redistributions of source code must retain the above copyright notice, this 
+      list of conditions and the following disclaimers.
+    * Redistributions in binary form must reproduce the above copyright notice, 
+      this list of conditions and the following disclaimers in the documentation 
+      and/or other materials provided with the distribution.
+    * Neither the names of Thomas R. Halford, the Communication Sciences Institute, 
+      the University of Southern California nor the names of its contributors may 
+      be used to endorse or promote products derived from this Software without 
+      specific prior written permission. 
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+   INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+   PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE CONTRIBUTORS OR 
+   COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN 
+   AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION 
+   WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE SOFTWARE.
+*/
+
+// Short_Cycle_Expr.h defines lazily evaluated elementwise expressions of
+// Short_Cycle_Matrix operands.  An expression such as L - 2*(P o Q) is a
+// tree of small nodes that is evaluated in a single pass over the matrix
+// by the assignment operators of Short_Cycle_Matrix, so that no
+// temporary matrices are formed.  Every node X derives from
+// Mx_Expr<T,X> and provides at(r,c,p), the element in row r and
+// column c at internal index p, and shape(), a matrix of the same size.
+//
+// Mx_Row_Op is a per-row epilogue.  The sparse products apply it to each
+// output row while that row is still in cache, which is how a product
+// and the subtraction of an expression are fused by matrix_mult_sub().
+
+#ifndef SHORT_CYCLE_EXPR
+#define SHORT_CYCLE_EXPR
+
+#include <stddef.h>
+
+template <class T> class Short_Cycle_Matrix;
+template <class T> class Short_Cycle_Diag_Matrix;
+
+// Base of every expression node.
+template <class T, class X>
+class Mx_Expr
+{
+  public:
+	const X& self( void ) const { return static_cast<const X&>(*this); };
+};
+
+// Nodes are held by value, matrices by reference.
+template <class X> 
+struct Mx_Store { typedef X type; };
+
+template <class T> 
+struct Mx_Store< Short_Cycle_Matrix<T> > { typedef const Short_Cycle_Matrix<T>& type; };
+
+// Keeps a scalar argument out of template argument deduction.
+template <class T>
+struct Mx_Scalar { typedef T type; };
+
+// x + y
+template <class T, class X, class Y>
+class Mx_Sum : public Mx_Expr< T, Mx_Sum<T,X,Y> >
+{
+  public:
+	Mx_Sum( const X& x, const Y& y ) : x_(x), y_(y) {};
+	T at( int r, int c, size_t p ) const { return x_.at(r,c,p)+y_.at(r,c,p); };
+	const Short_Cycle_Matrix<T>& shape( void ) const { return x_.shape(); };
+	
+  private:
+	typename Mx_Store<X>::type x_;
+	typename Mx_Store<Y>::type y_;
+};
+
+// x - y
+template <class T, class X, class Y>
+class Mx_Diff : public Mx_Expr< T, Mx_Diff<T,X,Y> >
+{
+  public:
+	Mx_Diff( const X& x, const Y& y ) : x_(x), y_(y) {};
+	T at( int r, int c, size_t p ) const { return x_.at(r,c,p)-y_.at(r,c,p); };
+	const Short_Cycle_Matrix<T>& shape( void ) const { return x_.shape(); };
+	
+  private:
+	typename Mx_Store<X>::type x_;
+	typename Mx_Store<Y>::type y_;
+};
+
+// x o y (direct product)
+template <class T, class X, class Y>
+class Mx_Direct : public Mx_Expr< T, Mx_Direct<T,X,Y> >
+{
+  public:
+	Mx_Direct( const X& x, const Y& y ) : x_(x), y_(y) {};
+	T at( int r, int c, size_t p ) const { return x_.at(r,c,p)*y_.at(r,c,p); };
+	const Short_Cycle_Matrix<T>& shape( void ) const { return x_.shape(); };
+	
+  private:
+	typename Mx_Store<X>::type x_;
+	typename Mx_Store<Y>::type y_;
+};
+
+// s*x
+template <class T, class X>
+class Mx_Scale : public Mx_Expr< T, Mx_Scale<T,X> >
+{
+  public:
+	Mx_Scale( T s, const X& x ) : s_(s), x_(x) {};
+	T at( int r, int c, size_t p ) const { return s_*x_.at(r,c,p); };
+	const Short_Cycle_Matrix<T>& shape( void ) const { return x_.shape(); };
+	
+  private:
+	T s_;
+	typename Mx_Store<X>::type x_;
+};
+
+// D \times x, i.e., the rows of x scaled by the diagonal d.
+template <class T, class X>
+class Mx_Scale_Rows : public Mx_Expr< T, Mx_Scale_Rows<T,X> >
+{
+  public:
+	Mx_Scale_Rows( const T* d, const X& x ) : d_(d), x_(x) {};
+	T at( int r, int c, size_t p ) const { return d_[r]*x_.at(r,c,p); };
+	const Short_Cycle_Matrix<T>& shape( void ) const { return x_.shape(); };
+	
+  private:
+	const T* d_;
+	typename Mx_Store<X>::type x_;
+};
+
+// x \times D, i.e., the columns of x scaled by the diagonal d.
+template <class T, class X>
+class Mx_Scale_Cols : public Mx_Expr< T, Mx_Scale_Cols<T,X> >
+{
+  public:
+	Mx_Scale_Cols( const X& x, const T* d ) : d_(d), x_(x) {};
+	T at( int r, int c, size_t p ) const { return x_.at(r,c,p)*d_[c]; };
+	const Short_Cycle_Matrix<T>& shape( void ) const { return x_.shape(); };
+	
+  private:
+	const T* d_;
+	typename Mx_Store<X>::type x_;
+};
+
+// s*binom(x,2) and s*binom(x,3) elementwise.
+template <class T, class X>
+class Mx_Choose_2 : public Mx_Expr< T, Mx_Choose_2<T,X> >
+{
+  public:
+	Mx_Choose_2( T s, const X& x ) : s_(s), x_(x) {};
+	T at( int r, int c, size_t p ) const { return s_*mx_binom_2(x_.at(r,c,p)); };
+	const Short_Cycle_Matrix<T>& shape( void ) const { return x_.shape(); };
+	T scale( void ) const { return s_; };
+	const X& operand( void ) const { return x_; };
+	
+  private:
+	T s_;
+	typename Mx_Store<X>::type x_;
+};
+
+template <class T, class X>
+class Mx_Choose_3 : public Mx_Expr< T, Mx_Choose_3<T,X> >
+{
+  public:
+	Mx_Choose_3( T s, const X& x ) : s_(s), x_(x) {};
+	T at( int r, int c, size_t p ) const { return s_*mx_binom_3(x_.at(r,c,p)); };
+	const Short_Cycle_Matrix<T>& shape( void ) const { return x_.shape(); };
+	T scale( void ) const { return s_; };
+	const X& operand( void ) const { return x_; };
+	
+  private:
+	T s_;
+	typename Mx_Store<X>::type x_;
+};
+
+// Expression operators.  * is the direct product, as for Short_Cycle_Matrix.
+template <class T, class X, class Y>
+inline Mx_Sum<T,X,Y> operator+( const Mx_Expr<T,X>& x, const Mx_Expr<T,Y>& y )
+{
+	return Mx_Sum<T,X,Y>(x.self(),y.self());
+}
+
+template <class T, class X, class Y>
+inline Mx_Diff<T,X,Y> operator-( const Mx_Expr<T,X>& x, const Mx_Expr<T,Y>& y )
+{
+	return Mx_Diff<T,X,Y>(x.self(),y.self());
+}
+
+template <class T, class X, class Y>
+inline Mx_Direct<T,X,Y> operator*( const Mx_Expr<T,X>& x, const Mx_Expr<T,Y>& y )
+{
+	return Mx_Direct<T,X,Y>(x.self(),y.self());
+}
+
+template <class T, class X>
+inline Mx_Scale<T,X> operator*( typename Mx_Scalar<T>::type s, const Mx_Expr<T,X>& x )
+{
+	return Mx_Scale<T,X>(s,x.self());
+}
+
+// Products with a diagonal matrix.
+template <class T, class X>
+inline Mx_Scale_Rows<T,X> mx_prod( const Short_Cycle_Diag_Matrix<T>& d, const Mx_Expr<T,X>& x )
+{
+	return Mx_Scale_Rows<T,X>(d.data(),x.self());
+}
+
+template <class T, class X>
+inline Mx_Scale_Cols<T,X> mx_prod( const Mx_Expr<T,X>& x, const Short_Cycle_Diag_Matrix<T>& d )
+{
+	return Mx_Scale_Cols<T,X>(x.self(),d.data());
+}
+
+// Per-row epilogue of a product.
+template <class T>
+class Mx_Row_Op
+{
+  public:
+	virtual ~Mx_Row_Op( void ) {};
+	// out is row r of the result.  Only columns c0 and on are updated.
+	virtual void apply( int r, int c0, T* out ) const = 0;
+};
+
+// Subtract row r of an expression.
+template <class T, class X>
+class Mx_Sub_Row : public Mx_Row_Op<T>
+{
+  public:
+	Mx_Sub_Row( const X& x ) : x_(x), n_(x.shape().i_nc()) {};
+	void apply( int r, int c0, T* out ) const
+	{
+		size_t pp = (size_t)r*n_+c0;
+		for( int cc = c0; cc < n_; cc++, pp++ ) out[cc] -= x_.at(r,cc,pp);
+	};
+	
+  private:
+	typename Mx_Store<X>::type x_;
+	int n_;
+};
+
+// Zero the diagonal element of row r, then apply next (if any).  Row r
+// of a block of rows starting at row offset is row r+offset of the
+// whole matrix.
+template <class T>
+class Mx_Zero_Diag : public Mx_Row_Op<T>
+{
+  public:
+	Mx_Zero_Diag( const Mx_Row_Op<T>* next, int offset = 0 ) 
+	 : next_(next), offset_(offset) {};
+	void apply( int r, int c0, T* out ) const
+	{
+		if( r+offset_ >= c0 ) out[r+offset_] = 0;
+		if( next_ ) next_->apply(r,c0,out);
+	};
+	
+  private:
+	const Mx_Row_Op<T>* next_;
+	int offset_;
+};
+
+#endif
@@ -0,0 +1,359 @@
+/* Short_Cycle_Girth.cpp
+
+   Copyright (c) 2005 Thomas R. Halford 
+   All rights reserved.
+ 
+   Developed by: Thomas R. Halford
+                 Communication Sciences Institute
+                 University of Southern California
+                 http://csi.usc.edu
+ 
+   Permission is hereby granted, free of charge, to any person obtaining a copy 
+   of this software and associated documentation files (the "Software"), to deal 
+   with the Software without restriction, including without limitation the rights 
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+   copies of the Software, and to permit persons to whom the Software is furnished 
+   to do so, subject to the following conditions:
+  
+    * Redistributions of source code must retain the above copyright notice, this 
+      list of conditions and the following disclaimers.
+    * Redistributions in binary form must reproduce the above copyright notice, 
+      this list of conditions and the following disclaimers in the documentation 
+      and/or other materials provided with the distribution.
+    * Neither the names of Thomas R. Halford, the Communication Sciences Institute, 
+      the University of Southern California nor the names of its contributors may 
+      be used to endorse or promote products derived from this Software without 
+      specific prior written permission. 
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+   INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+   PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE CONTRIBUTORS OR 
+   COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN 
+   AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION 
+   WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE SOFTWARE.
+*/
+
+
+#include <stdint.h>
+#include "Short_Cycle_Girth.h"
+
+using namespace std;
+
+// A square Boolean matrix with each row packed into 64 bit words.
+struct Short_Cycle_Bits
+{
+	int n, nw;
+	vector<uint64_t> bits;
+	
+	Short_Cycle_Bits( int n_ = 0 ) : n(n_), nw((n_+63)/64), bits((size_t)n_*((n_+63)/64),0) {};
+	uint64_t* row( int r ) { return &bits[(size_t)r*nw]; };
+	const uint64_t* row( int r ) const { return &bits[(size_t)r*nw]; };
+	int get( int r, int c ) const { return (int)((row(r)[c/64] >> (c%64)) & 1); };
+	void set( int r, int c ) { row(r)[c/64] |= (uint64_t)1 << (c%64); };
+};
+
+// Rows first ... last-1 of out = left \times right over the Boolean
+// semiring, i.e., row r of out is the OR of the rows of right selected
+// by row r of left.
+class Short_Cycle_Bits_Product : public Short_Cycle_Task
+{
+  public:
+	Short_Cycle_Bits_Product( Short_Cycle_Bits& out, const Short_Cycle_Bits& left, 
+							  const Short_Cycle_Bits& right, int first, int last )
+	 : out_(out), left_(left), right_(right), first_(first), last_(last) {};
+	void run( void )
+	{
+		int nw = out_.nw;
+		for( int rr = first_; rr < last_; rr++ )
+		{
+			uint64_t* out = out_.row(rr);
+			const uint64_t* in = left_.row(rr);
+			for( int ww = 0; ww < nw; ww++ ) out[ww] = 0;
+			for( int kw = 0; kw < nw; kw++ )
+			{
+				uint64_t b = in[kw];
+				for( int kk = 64*kw; b; kk++, b >>= 1 )
+				{
+					if( !(b & 1) ) continue;
+					const uint64_t* src = right_.row(kk);
+					for( int ww = 0; ww < nw; ww++ ) out[ww] |= src[ww];
+				}
+			}
+		}
+	};
+	
+  private:
+	Short_Cycle_Bits& out_;
+	const Short_Cycle_Bits& left_;
+	const Short_Cycle_Bits& right_;
+	int first_, last_;
+};
+
+// out = left \times right over the Boolean semiring on pool.
+static void mx_bits_mult( Short_Cycle_Bits& out, const Short_Cycle_Bits& left, 
+						  const Short_Cycle_Bits& right, Short_Cycle_Thread_Pool* pool )
+{
+	int n_tasks = (left.n < 64 ? left.n : 64);
+	out = Short_Cycle_Bits(left.n);
+	Short_Cycle_Task_Graph graph;
+	for( int tt = 0; tt < n_tasks; tt++ )
+	{
+		graph.add("bits",new Short_Cycle_Bits_Product(out,left,right,(int)((long)left.n*tt/n_tasks),
+													  (int)((long)left.n*(tt+1)/n_tasks)));
+	}
+	
+	graph.run(pool);
+}
+
+// Searches from sources first ... last-1, which stops early once a
+// cycle of length 4, the shortest possible, is found.
+class Short_Cycle_Girth::Search : public Short_Cycle_Task
+{
+  public:
+	Search( Short_Cycle_Girth* girth, int task, int first, int last )
+	 : girth_(girth), task_(task), first_(first), last_(last) {};
+	void run( void )
+	{
+		int n = girth_->U_+girth_->W_;
+		vector<int> dist(n,-1), queue(n);
+		int best = 1000000;
+		for( int ii = first_; ii < last_ && best > 4; ii++ ) 
+			best = girth_->search(girth_->sources_[ii],best,&dist[0],&queue[0]);
+		girth_->best_[task_] = best;
+	};
+	
+  private:
+	Short_Cycle_Girth* girth_;
+	int task_, first_, last_;
+};
+
+Short_Cycle_Girth::Short_Cycle_Girth( void )
+ : E_(NULL), ET_(NULL), U_(0), W_(0), method_(SEARCH), g_(1000000), max_cycle_(0)
+{
+	return;
+}
+
+void Short_Cycle_Girth::compute( const Short_Cycle_Sparse_Matrix& E, const Short_Cycle_Sparse_Matrix& ET,
+								 Short_Cycle_Thread_Pool* pool )
+{
+	E_  = &E;
+	ET_ = &ET;
+	U_  = E.e_nr();
+	W_  = E.e_nc();
+	prune();
+	
+	// The vertices of a QC graph generated by the shifts of the first
+	// block of each row block are alike, so only those are searched from.
+	sources_.clear();
+	int n_u = 0, n_w = 0;
+	for( int uu = 0; uu < U_; uu++ ) 
+	{
+		n_u += core_[uu];
+		if( core_[uu] && uu < E.gen_nr() ) sources_.push_back(uu);
+	}
+	
+	for( int ww = 0; ww < W_; ww++ ) n_w += core_[U_+ww];
+	max_cycle_ = 2*(n_u < n_w ? n_u : n_w);
+	g_ = 1000000;
+	if( max_cycle_ == 0 ) return;
+	if( method_ == POWERS ) 
+	{
+		power_search(pool);
+		return;
+	}
+	
+	// At most 64 tasks, each searching from a run of the sources.
+	n_u = (int)sources_.size();
+	int n_tasks = (n_u < 64 ? n_u : 64);
+	best_.assign(n_tasks,1000000);
+	Short_Cycle_Task_Graph graph;
+	for( int tt = 0; tt < n_tasks; tt++ )
+	{
+		graph.add("girth",new Search(this,tt,(int)((long)n_u*tt/n_tasks),(int)((long)n_u*(tt+1)/n_tasks)));
+	}
+	
+	graph.run(pool);
+	for( int tt = 0; tt < n_tasks; tt++ ) 
+	{
+		if( best_[tt] < g_ ) g_ = best_[tt];
+	}
+}
+
+// Remove the vertices of degree 0 or 1, and then those left with
+// degree 0 or 1, and so on.  Vertex ww of W is vertex U_+ww.
+void Short_Cycle_Girth::prune( void )
+{
+	const int* row_ptr = E_->row_ptr();
+	const int* col_idx = E_->col_idx();
+	const int* t_row_ptr = ET_->row_ptr();
+	const int* t_col_idx = ET_->col_idx();
+	
+	vector<int> degree(U_+W_), stack;
+	core_.assign(U_+W_,1);
+	for( int uu = 0; uu < U_; uu++ ) degree[uu] = row_ptr[uu+1]-row_ptr[uu];
+	for( int ww = 0; ww < W_; ww++ ) degree[U_+ww] = t_row_ptr[ww+1]-t_row_ptr[ww];
+	for( int vv = 0; vv < U_+W_; vv++ ) 
+	{
+		if( degree[vv] < 2 ) 
+		{
+			core_[vv] = 0;
+			stack.push_back(vv);
+		}
+	}
+	
+	while( !stack.empty() )
+	{
+		int vv = stack.back();
+		stack.pop_back();
+		int first = (vv < U_ ? row_ptr[vv] : t_row_ptr[vv-U_]);
+		int last  = (vv < U_ ? row_ptr[vv+1] : t_row_ptr[vv-U_+1]);
+		for( int pp = first; pp < last; pp++ )
+		{
+			int xx = (vv < U_ ? U_+col_idx[pp] : t_col_idx[pp]);
+			if( core_[xx] && --degree[xx] < 2 )
+			{
+				core_[xx] = 0;
+				stack.push_back(xx);
+			}
+		}
+	}
+}
+
+// A breadth first search of the core from u.  The first edge from a
+// vertex x at depth d to a vertex y found before, necessarily at depth
+// d+1 as the graph is bipartite, closes a cycle of length at most 2d+2
+// through u, and the shortest cycle through u is found that way.  So the
+// search ends at the depth at which no shorter cycle than bound remains.
+int Short_Cycle_Girth::search( int u, int bound, int* dist, int* queue ) const
+{
+	const int* row_ptr = E_->row_ptr();
+	const int* col_idx = E_->col_idx();
+	const int* t_row_ptr = ET_->row_ptr();
+	const int* t_col_idx = ET_->col_idx();
+	
+	int head = 0, tail = 0;
+	queue[tail++] = u;
+	dist[u] = 0;
+	while( head < tail )
+	{
+		int vv = queue[head++];
+		int dv = dist[vv];
+		if( 2*dv+2 >= bound ) break;
+		
+		int first = (vv < U_ ? row_ptr[vv] : t_row_ptr[vv-U_]);
+		int last  = (vv < U_ ? row_ptr[vv+1] : t_row_ptr[vv-U_+1]);
+		for( int pp = first; pp < last; pp++ )
+		{
+			int xx = (vv < U_ ? U_+col_idx[pp] : t_col_idx[pp]);
+			if( !core_[xx] ) continue;
+			if( dist[xx] < 0 )
+			{
+				dist[xx] = dv+1;
+				queue[tail++] = xx;
+			}
+			
+			else if( dist[xx] == dv+1 )
+			{
+				bound = 2*dv+2;
+				break;
+			}
+		}
+	}
+	
+	for( int ii = 0; ii < tail; ii++ ) dist[queue[ii]] = -1;
+	return bound;
+}
+
+// 1 if B(e,f) = 1 and reach(f,e) = 1 for some e and f, where the
+// nonzeros of B are given in compressed row form.
+static int mx_closed_walk( const Short_Cycle_Bits& reach, const vector<int>& succ_ptr, 
+						   const vector<int>& succ_idx )
+{
+	for( int ee = 0; ee < reach.n; ee++ )
+	{
+		for( int pp = succ_ptr[ee]; pp < succ_ptr[ee+1]; pp++ ) 
+		{
+			if( reach.get(succ_idx[pp],ee) ) return 1;
+		}
+	}
+	
+	return 0;
+}
+
+// Directed edge 2e of the core is edge e from U to W and 2e+1 is its
+// reverse.  B(e,f) = 1 if f leaves the vertex e enters other than back
+// along e.  (I+B)^k has a 1 at (e,f) if a non-backtracking walk of at
+// most k steps leads from e to f, so a closed walk of length at most
+// k+1 exists if and only if B(e,f) = 1 and (I+B)^k(f,e) = 1 for some e
+// and f.  The shortest closed walk is a shortest cycle.
+void Short_Cycle_Girth::power_search( Short_Cycle_Thread_Pool* pool )
+{
+	const int* row_ptr = E_->row_ptr();
+	const int* col_idx = E_->col_idx();
+	
+	// The directed edges, by the vertex they leave.
+	vector<int> tail, head, out_ptr(U_+W_+1,0), out_idx;
+	for( int uu = 0; uu < U_; uu++ )
+	{
+		if( !core_[uu] ) continue;
+		for( int pp = row_ptr[uu]; pp < row_ptr[uu+1]; pp++ )
+		{
+			int ww = U_+col_idx[pp];
+			if( !core_[ww] ) continue;
+			tail.push_back(uu);
+			head.push_back(ww);
+			tail.push_back(ww);
+			head.push_back(uu);
+		}
+	}
+	
+	int n = (int)tail.size();
+	for( int ee = 0; ee < n; ee++ ) out_ptr[tail[ee]+1]++;
+	for( int vv = 0; vv < U_+W_; vv++ ) out_ptr[vv+1] += out_ptr[vv];
+	out_idx.resize(n);
+	vector<int> fill(out_ptr.begin(),out_ptr.end()-1);
+	for( int ee = 0; ee < n; ee++ ) out_idx[fill[tail[ee]]++] = ee;
+	
+	// The successors of each directed edge, i.e., the nonzeros of B.
+	vector<int> succ_ptr(n+1,0), succ_idx;
+	for( int ee = 0; ee < n; ee++ )
+	{
+		for( int pp = out_ptr[head[ee]]; pp < out_ptr[head[ee]+1]; pp++ )
+		{
+			if( head[out_idx[pp]] != tail[ee] ) succ_idx.push_back(out_idx[pp]);
+		}
+		
+		succ_ptr[ee+1] = (int)succ_idx.size();
+	}
+	
+	// powers[i] = (I+B)^(2^i), squared until a closed walk is found.
+	vector<Short_Cycle_Bits> powers(1,Short_Cycle_Bits(n));
+	for( int ee = 0; ee < n; ee++ )
+	{
+		powers[0].set(ee,ee);
+		for( int pp = succ_ptr[ee]; pp < succ_ptr[ee+1]; pp++ ) powers[0].set(ee,succ_idx[pp]);
+	}
+	
+	while( !mx_closed_walk(powers.back(),succ_ptr,succ_idx) )
+	{
+		powers.push_back(Short_Cycle_Bits());
+		mx_bits_mult(powers.back(),powers[powers.size()-2],powers[powers.size()-2],pool);
+	}
+	
+	// Binary search for the longest k with no closed walk of length at
+	// most k+1.  (I+B)^1 has none as the graph has no multiple edges.
+	int top = (int)powers.size()-1;
+	int k = 1 << (top-1);
+	Short_Cycle_Bits cur = powers[top-1], cand;
+	for( int ii = top-2; ii >= 0; ii-- )
+	{
+		mx_bits_mult(cand,cur,powers[ii],pool);
+		if( !mx_closed_walk(cand,succ_ptr,succ_idx) )
+		{
+			cur.bits.swap(cand.bits);
+			k += 1 << ii;
+		}
+	}
+	
+	g_ = k+2;
+}
@@ -0,0 +1,106 @@
+/* Short_Cycle_Girth.h
+
+   Copyright (c) 2005 Thomas R. Halford 
+   All rights reserved.
+ 
+   Developed by: Thomas R. Halford
+                 Communication Sciences Institute
+                 University of Southern California
+                 http://csi.usc.edu
+ 
+   Permission is hereby granted, free of charge, to any person obtaining a copy 
+   of this software and associated documentation files (the "Software"), to deal 
+   with the Software without restriction, including without limitation the rights 
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+   copies of the Software, and to permit persons to whom the Software is furnished 
+   to do so, subject to the following conditions:
+  
+    * Redistributions of source code must retain the above copyright notice, this 
+      list of conditions and the following disclaimers.
+    * Redistributions in binary form must reproduce the above copyright notice, 
+      this list of conditions and the following disclaimers in the documentation 
+      and/or other materials provided with the distribution.
+    * Neither the names of Thomas R. Halford, the Communication Sciences Institute, 
+      the University of Southern California nor the names of its contributors may 
+      be used to endorse or promote products derived from this Software without 
+      specific prior written permission. 
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+   INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+   PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE CONTRIBUTORS OR 
+   COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN 
+   AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION 
+   WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE SOFTWARE.
+*/
+
+
+// Short_Cycle_Girth.h finds the girth of a bipartite graph without the
+// matrix recursions.  Every cycle lies in the 2-core of the graph, i.e.,
+// what is left once vertices of degree 0 or 1 are removed repeatedly.
+// A breadth first search from each vertex of U in the core finds the
+// shortest cycle through it, so the girth is found in O(|U||E|) time.
+// The searches are split into tasks run on a Short_Cycle_Thread_Pool.
+//
+// Alternatively (POWERS) the girth is the length of the shortest closed
+// walk of the non-backtracking matrix B of the core, whose rows and
+// columns are the directed edges.  Boolean powers of I+B are formed as
+// bit matrices by repeated squaring and the girth is then found by a
+// binary search over the walk length, with O(log g) Boolean products
+// of O(m^3/64) operations each for m directed edges.  This suits cores
+// with few edges and a large girth.
+//
+// A cycle alternates between U and W, so none is longer than twice the
+// smaller side of the core.  Short_Cycle_Engine uses both results to
+// skip the trace tests of the lengths below the girth, whose path
+// matrices it still forms, and to skip the counts of lengths that
+// cannot occur.
+
+#ifndef SHORT_CYCLE_GIRTH
+#define SHORT_CYCLE_GIRTH
+
+#include <vector>
+#include "Short_Cycle_Sparse_Matrix.h"
+#include "Short_Cycle_Tasks.h"
+
+class Short_Cycle_Girth
+{
+  public:
+	enum Method { SEARCH, POWERS };
+	
+	Short_Cycle_Girth( void );
+	
+	void set_method( Method method ) { method_ = method; };
+	Method method( void ) const { return method_; };
+	
+	// Find the girth of the graph with incidence matrix E, of which ET is
+	// the transpose.  The searches run on pool, or in order if it is NULL.
+	void compute( const Short_Cycle_Sparse_Matrix& E, const Short_Cycle_Sparse_Matrix& ET,
+				  Short_Cycle_Thread_Pool* pool );
+	
+	int girth( void ) const { return g_; };				 // 1000000 if there are no cycles.
+	int max_cycle( void ) const { return max_cycle_; };  // No cycle is longer.
+	
+  private:
+	class Search;
+	friend class Search;
+	
+	void prune( void ); // Find the 2-core.
+	void power_search( Short_Cycle_Thread_Pool* pool ); // g_ by POWERS.
+	
+	// The length of the shortest cycle through vertex u of U if it is
+	// below bound, bound otherwise.  dist has U_+W_ elements, all -1,
+	// and is left so; queue has room for U_+W_ vertices.
+	int search( int u, int bound, int* dist, int* queue ) const;
+	
+	const Short_Cycle_Sparse_Matrix* E_;
+	const Short_Cycle_Sparse_Matrix* ET_;
+	int U_, W_;
+	std::vector<char> core_;	 // Vertices of U then of W.
+	std::vector<int> sources_;   // The vertices of U in the core.
+	std::vector<int> best_;		 // The result of each task.
+	Method method_;
+	int g_;
+	int max_cycle_;
+};
+
+#endif
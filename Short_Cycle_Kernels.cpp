@@ -0,0 +1,440 @@
+/* Short_Cycle_Kernels.cpp
+
+   Copyright (c) 2005 Thomas R. Halford 
+   All rights reserved.
+ 
+   Developed by: Thomas R. Halford
+                 Communication Sciences Institute
+                 University of Southern California
+                 http://csi.usc.edu
+ 
+   Permission is hereby granted, free of charge, to any person obtaining a copy 
+   of this software and associated documentation files (the "Software"), to deal 
+   with the Software without restriction, including without limitation the rights 
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+   copies of the Software, and to permit persons to whom the Software is furnished 
+   to do so, subject to the following conditions:
+  
+    * Redistributions of source code must retain the above copyright notice, this 
+      list of conditions and the following disclaimers.
+    * Redistributions in binary form must reproduce the above copyright notice, 
+      this list of conditions and the following disclaimers in the documentation 
+      and/or other materials provided with the distribution.
+    * Neither the names of Thomas R. Halford, the Communication Sciences Institute, 
+      the University of Southern California nor the names of its contributors may 
+      be used to endorse or promote products derived from this Software without 
+      specific prior written permission. 
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+   INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+   PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE CONTRIBUTORS OR 
+   COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN 
+   AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION 
+   WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE SOFTWARE.
+*/
+
+#include <string.h>
+#include "Short_Cycle_Kernels.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SCM_X86_DISPATCH
+#endif
+
+// Blocking parameters.  A kc x nc panel of b is reused by every row of a,
+// so it is sized to stay in the L2 cache.
+static const int MX_KC = 256;
+static const int MX_NC_BYTES = 256*1024;
+
+static inline int mx_min( int a, int b ) { return a < b ? a : b; }
+
+// Elementwise operations.
+enum { MX_ADD, MX_SUB, MX_MUL, MX_SCALE, MX_CHOOSE_2, MX_CHOOSE_3 };
+
+// y = binom(x,2) and y = binom(x,3) for a scalar or vector x of element
+// type T, computed as in mx_binom_2() and mx_binom_3() of
+// Short_Cycle_Matrix.h.  Vectors are passed by reference so that the
+// default target versions can be inlined into the SIMD kernels.
+template <class T>
+struct Mx_Binom
+{
+	template <class V> static inline void two( V& y, const V& x )
+	{
+		V odd = -(x & 1);
+		y = (((x >> 1)*(x-1)) & ~odd) | ((x*((x-1) >> 1)) & odd);
+	}
+	
+	template <class V> static inline void three( V& y, const V& x )
+	{
+		const T inv3 = ((T)~(T)0)/3*2+1;
+		V b2;
+		two(b2,x);
+		y = b2*(x-2)*inv3;
+	}
+};
+
+template <>
+struct Mx_Binom<double>
+{
+	template <class V> static inline void two( V& y, const V& x )   { y = x*(x-1.0)/2.0; }
+	template <class V> static inline void three( V& y, const V& x ) { y = x*(x-1.0)*(x-2.0)/6.0; }
+};
+
+// Elements from..n-1, one at a time.
+template <class T>
+static inline void mx_elementwise_tail( int op, size_t from, size_t n, T s, const T* x, T* y )
+{
+	switch( op )
+	{
+		case MX_ADD:      for( size_t ii = from; ii < n; ii++ ) y[ii] += x[ii]; break;
+		case MX_SUB:      for( size_t ii = from; ii < n; ii++ ) y[ii] -= x[ii]; break;
+		case MX_MUL:      for( size_t ii = from; ii < n; ii++ ) y[ii] *= x[ii]; break;
+		case MX_SCALE:    for( size_t ii = from; ii < n; ii++ ) y[ii] *= s;     break;
+		case MX_CHOOSE_2: for( size_t ii = from; ii < n; ii++ ) { Mx_Binom<T>::two(y[ii],x[ii]);   y[ii] *= s; } break;
+		case MX_CHOOSE_3: for( size_t ii = from; ii < n; ii++ ) { Mx_Binom<T>::three(y[ii],x[ii]); y[ii] *= s; } break;
+	}
+}
+
+// Portable kernel.  Each row of c is updated by the rows of the b panel
+// scaled by the elements of a; zero elements of a are skipped.
+template <class T>
+static void mx_gemm_portable( int m, int n, int k, const T* a, int lda,
+							  const T* b, int ldb, T* c, int ldc )
+{
+	int NC = MX_NC_BYTES/(MX_KC*(int)sizeof(T));
+	for( int kb = 0; kb < k; kb += MX_KC )
+	{
+		int kc = mx_min(MX_KC,k-kb);
+		for( int nb = 0; nb < n; nb += NC )
+		{
+			int nc = mx_min(NC,n-nb);
+			for( int rr = 0; rr < m; rr++ )
+			{
+				const T* ar = a+(size_t)rr*lda+kb;
+				T* cr = c+(size_t)rr*ldc+nb;
+				for( int kk = 0; kk < kc; kk++ )
+				{
+					T val = ar[kk];
+					if( val == 0 ) continue;
+					const T* br = b+(size_t)(kb+kk)*ldb+nb;
+					for( int cc = 0; cc < nc; cc++ ) cr[cc] += val*br[cc];
+				}
+			}
+		}
+	}
+}
+
+#ifdef SCM_X86_DISPATCH
+
+// The SIMD kernels are written once with GCC vector extensions and
+// instantiated for each instruction set by the target specific wrappers
+// below.  A 4 x 2W block of c is held in registers while a kc x 2W strip
+// of b is streamed through.
+template <class T, int W>
+struct Mx_Vec
+{
+	typedef T type __attribute__((vector_size(W*sizeof(T))));
+};
+
+template <class T, int W>
+static inline __attribute__((always_inline))
+void mx_gemm_simd( int m, int n, int k, const T* a, int lda,
+				   const T* b, int ldb, T* c, int ldc )
+{
+	typedef typename Mx_Vec<T,W>::type V;
+	const int MR = 4;
+	int NC = MX_NC_BYTES/(MX_KC*(int)sizeof(T));
+	NC -= NC%(2*W);
+	
+	for( int kb = 0; kb < k; kb += MX_KC )
+	{
+		int kc = mx_min(MX_KC,k-kb);
+		for( int nb = 0; nb < n; nb += NC )
+		{
+			int nc = mx_min(NC,n-nb);
+			int rr = 0;
+			
+			// Full 4 row tiles.
+			for( ; rr+MR <= m; rr += MR )
+			{
+				const T* a0 = a+(size_t)rr*lda+kb;
+				int cc = 0;
+				for( ; cc+2*W <= nc; cc += 2*W )
+				{
+					T* c0 = c+(size_t)rr*ldc+nb+cc;
+					V acc[MR][2];
+					for( int ii = 0; ii < MR; ii++ )
+					{
+						memcpy(&acc[ii][0],c0+ii*ldc,sizeof(V));
+						memcpy(&acc[ii][1],c0+ii*ldc+W,sizeof(V));
+					}
+					
+					const T* b0 = b+(size_t)kb*ldb+nb+cc;
+					for( int kk = 0; kk < kc; kk++, b0 += ldb )
+					{
+						V v0, v1;
+						memcpy(&v0,b0,sizeof(V));
+						memcpy(&v1,b0+W,sizeof(V));
+						for( int ii = 0; ii < MR; ii++ )
+						{
+							T s = a0[ii*lda+kk];
+							acc[ii][0] += s*v0;
+							acc[ii][1] += s*v1;
+						}
+					}
+					
+					for( int ii = 0; ii < MR; ii++ )
+					{
+						memcpy(c0+ii*ldc,&acc[ii][0],sizeof(V));
+						memcpy(c0+ii*ldc+W,&acc[ii][1],sizeof(V));
+					}
+				}
+				
+				// Remaining columns.
+				for( int ii = 0; ii < MR; ii++ )
+				{
+					T* cr = c+(size_t)(rr+ii)*ldc+nb;
+					for( int kk = 0; kk < kc; kk++ )
+					{
+						T s = a0[ii*lda+kk];
+						const T* br = b+(size_t)(kb+kk)*ldb+nb;
+						for( int jj = cc; jj < nc; jj++ ) cr[jj] += s*br[jj];
+					}
+				}
+			}
+			
+			// Remaining rows, one at a time.
+			for( ; rr < m; rr++ )
+			{
+				const T* ar = a+(size_t)rr*lda+kb;
+				T* cr = c+(size_t)rr*ldc+nb;
+				for( int kk = 0; kk < kc; kk++ )
+				{
+					T s = ar[kk];
+					if( s == 0 ) continue;
+					const T* br = b+(size_t)(kb+kk)*ldb+nb;
+					int jj = 0;
+					for( ; jj+W <= nc; jj += W )
+					{
+						V vb, vc;
+						memcpy(&vb,br+jj,sizeof(V));
+						memcpy(&vc,cr+jj,sizeof(V));
+						vc += s*vb;
+						memcpy(cr+jj,&vc,sizeof(V));
+					}
+					
+					for( ; jj < nc; jj++ ) cr[jj] += s*br[jj];
+				}
+			}
+		}
+	}
+}
+
+__attribute__((target("avx2")))
+static void mx_gemm_avx2( int m, int n, int k, const uint32_t* a, int lda,
+						  const uint32_t* b, int ldb, uint32_t* c, int ldc )
+{
+	mx_gemm_simd<uint32_t,8>(m,n,k,a,lda,b,ldb,c,ldc);
+}
+
+__attribute__((target("avx2")))
+static void mx_gemm_avx2( int m, int n, int k, const uint64_t* a, int lda,
+						  const uint64_t* b, int ldb, uint64_t* c, int ldc )
+{
+	mx_gemm_simd<uint64_t,4>(m,n,k,a,lda,b,ldb,c,ldc);
+}
+
+__attribute__((target("avx2,fma")))
+static void mx_gemm_avx2( int m, int n, int k, const double* a, int lda,
+						  const double* b, int ldb, double* c, int ldc )
+{
+	mx_gemm_simd<double,4>(m,n,k,a,lda,b,ldb,c,ldc);
+}
+
+__attribute__((target("avx512f,avx512dq")))
+static void mx_gemm_avx512( int m, int n, int k, const uint32_t* a, int lda,
+							const uint32_t* b, int ldb, uint32_t* c, int ldc )
+{
+	mx_gemm_simd<uint32_t,16>(m,n,k,a,lda,b,ldb,c,ldc);
+}
+
+__attribute__((target("avx512f,avx512dq")))
+static void mx_gemm_avx512( int m, int n, int k, const uint64_t* a, int lda,
+							const uint64_t* b, int ldb, uint64_t* c, int ldc )
+{
+	mx_gemm_simd<uint64_t,8>(m,n,k,a,lda,b,ldb,c,ldc);
+}
+
+__attribute__((target("avx512f,avx512dq")))
+static void mx_gemm_avx512( int m, int n, int k, const double* a, int lda,
+							const double* b, int ldb, double* c, int ldc )
+{
+	mx_gemm_simd<double,8>(m,n,k,a,lda,b,ldb,c,ldc);
+}
+
+// Elementwise SIMD kernel, W elements per vector.
+template <class T, int W>
+static inline __attribute__((always_inline))
+void mx_elementwise_simd( int op, size_t n, T s, const T* x, T* y )
+{
+	typedef typename Mx_Vec<T,W>::type V;
+	size_t ii = 0;
+	V vx, vy;
+	switch( op )
+	{
+		case MX_ADD: 
+		case MX_SUB:
+		case MX_MUL:
+			for( ; ii+W <= n; ii += W )
+			{
+				memcpy(&vx,x+ii,sizeof(V));
+				memcpy(&vy,y+ii,sizeof(V));
+				if( op == MX_ADD )      vy += vx;
+				else if( op == MX_SUB ) vy -= vx;
+				else                    vy *= vx;
+				memcpy(y+ii,&vy,sizeof(V));
+			}
+			break;
+			
+		case MX_SCALE:
+			for( ; ii+W <= n; ii += W )
+			{
+				memcpy(&vy,y+ii,sizeof(V));
+				vy *= s;
+				memcpy(y+ii,&vy,sizeof(V));
+			}
+			break;
+			
+		case MX_CHOOSE_2:
+			for( ; ii+W <= n; ii += W )
+			{
+				memcpy(&vx,x+ii,sizeof(V));
+				Mx_Binom<T>::two(vy,vx);
+				vy *= s;
+				memcpy(y+ii,&vy,sizeof(V));
+			}
+			break;
+			
+		case MX_CHOOSE_3:
+			for( ; ii+W <= n; ii += W )
+			{
+				memcpy(&vx,x+ii,sizeof(V));
+				Mx_Binom<T>::three(vy,vx);
+				vy *= s;
+				memcpy(y+ii,&vy,sizeof(V));
+			}
+			break;
+	}
+	
+	mx_elementwise_tail(op,ii,n,s,x,y);
+}
+
+template <class T>
+__attribute__((target("avx2")))
+static void mx_elementwise_avx2( int op, size_t n, T s, const T* x, T* y )
+{
+	mx_elementwise_simd<T,32/sizeof(T)>(op,n,s,x,y);
+}
+
+template <class T>
+__attribute__((target("avx512f,avx512dq")))
+static void mx_elementwise_avx512( int op, size_t n, T s, const T* x, T* y )
+{
+	mx_elementwise_simd<T,64/sizeof(T)>(op,n,s,x,y);
+}
+
+#endif
+
+static int mx_detect_isa( void )
+{
+	int isa = 0;
+#ifdef SCM_X86_DISPATCH
+	__builtin_cpu_init();
+	if( __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq") ) isa = 2;
+	else if( __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") )    isa = 1;
+#endif
+	return isa;
+}
+
+// The detection runs once; the initialization of a local static is
+// thread safe, so the kernels may be called from the worker threads.
+int mx_isa( void )
+{
+	static const int isa = mx_detect_isa();
+	return isa;
+}
+
+// Dispatch on the instruction set.
+template <class T>
+static void mx_gemm_dispatch( int m, int n, int k, const T* a, int lda,
+							  const T* b, int ldb, T* c, int ldc )
+{
+#ifdef SCM_X86_DISPATCH
+	switch( mx_isa() )
+	{
+		case 2:  mx_gemm_avx512(m,n,k,a,lda,b,ldb,c,ldc); return;
+		case 1:  mx_gemm_avx2(m,n,k,a,lda,b,ldb,c,ldc);   return;
+		default: break;
+	}
+#endif
+	mx_gemm_portable(m,n,k,a,lda,b,ldb,c,ldc);
+}
+
+void mx_gemm( int m, int n, int k, const uint32_t* a, int lda,
+			  const uint32_t* b, int ldb, uint32_t* c, int ldc )
+{
+	mx_gemm_dispatch(m,n,k,a,lda,b,ldb,c,ldc);
+}
+
+void mx_gemm( int m, int n, int k, const uint64_t* a, int lda,
+			  const uint64_t* b, int ldb, uint64_t* c, int ldc )
+{
+	mx_gemm_dispatch(m,n,k,a,lda,b,ldb,c,ldc);
+}
+
+void mx_gemm( int m, int n, int k, const double* a, int lda,
+			  const double* b, int ldb, double* c, int ldc )
+{
+	mx_gemm_dispatch(m,n,k,a,lda,b,ldb,c,ldc);
+}
+
+// Elementwise kernels.
+template <class T>
+static void mx_elementwise( int op, size_t n, T s, const T* x, T* y )
+{
+#ifdef SCM_X86_DISPATCH
+	switch( mx_isa() )
+	{
+		case 2:  mx_elementwise_avx512(op,n,s,x,y); return;
+		case 1:  mx_elementwise_avx2(op,n,s,x,y);   return;
+		default: break;
+	}
+#endif
+	mx_elementwise_tail(op,0,n,s,x,y);
+}
+
+template <class T> void mx_add_n( size_t n, const T* x, T* y )   { mx_elementwise(MX_ADD,n,(T)0,x,y); }
+template <class T> void mx_sub_n( size_t n, const T* x, T* y )   { mx_elementwise(MX_SUB,n,(T)0,x,y); }
+template <class T> void mx_mul_n( size_t n, const T* x, T* y )   { mx_elementwise(MX_MUL,n,(T)0,x,y); }
+template <class T> void mx_scale_n( size_t n, T s, T* y )		  { mx_elementwise(MX_SCALE,n,s,(const T*)y,y); }
+template <class T> void mx_choose_2_n( size_t n, T s, const T* x, T* y ) { mx_elementwise(MX_CHOOSE_2,n,s,x,y); }
+template <class T> void mx_choose_3_n( size_t n, T s, const T* x, T* y ) { mx_elementwise(MX_CHOOSE_3,n,s,x,y); }
+
+// Explicit instantiations for the supported element types.
+template void mx_add_n( size_t, const uint32_t*, uint32_t* );
+template void mx_add_n( size_t, const uint64_t*, uint64_t* );
+template void mx_add_n( size_t, const double*, double* );
+template void mx_sub_n( size_t, const uint32_t*, uint32_t* );
+template void mx_sub_n( size_t, const uint64_t*, uint64_t* );
+template void mx_sub_n( size_t, const double*, double* );
+template void mx_mul_n( size_t, const uint32_t*, uint32_t* );
+template void mx_mul_n( size_t, const uint64_t*, uint64_t* );
+template void mx_mul_n( size_t, const double*, double* );
+template void mx_scale_n( size_t, uint32_t, uint32_t* );
+template void mx_scale_n( size_t, uint64_t, uint64_t* );
+template void mx_scale_n( size_t, double, double* );
+template void mx_choose_2_n( size_t, uint32_t, const uint32_t*, uint32_t* );
+template void mx_choose_2_n( size_t, uint64_t, const uint64_t*, uint64_t* );
+template void mx_choose_2_n( size_t, double, const double*, double* );
+template void mx_choose_3_n( size_t, uint32_t, const uint32_t*, uint32_t* );
+template void mx_choose_3_n( size_t, uint64_t, const uint64_t*, uint64_t* );
+template void mx_choose_3_n( size_t, double, const double*, double* );
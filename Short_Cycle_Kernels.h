@@ -0,0 +1,70 @@
+/* Short_Cycle_Kernels.h
+
+   Copyright (c) 2005 Thomas R. Halford 
+   All rights reserved.
+ 
+   Developed by: Thomas R. Halford
+                 Communication Sciences Institute
+                 University of Southern California
+                 http://csi.usc.edu
+ 
+   Permission is hereby granted, free of charge, to any person obtaining a copy 
+   of this software and associated documentation files (the "Software"), to deal 
+   with the Software without restriction, including without limitation the rights 
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+   copies of the Software, and to permit persons to whom the Software is furnished 
+   to do so, subject to the following conditions:
+  
+    * Redistributions of source code must retain the above copyright notice, this 
+      list of conditions and the following disclaimers.
+    * Redistributions in binary form must reproduce the above copyright notice, 
+      this list of conditions and the following disclaimers in the documentation 
+      and/or other materials provided with the distribution.
+    * Neither the names of Thomas R. Halford, the Communication Sciences Institute, 
+      the University of Southern California nor the names of its contributors may 
+      be used to endorse or promote products derived from this Software without 
+      specific prior written permission. 
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+   INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+   PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE CONTRIBUTORS OR 
+   COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN 
+   AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION 
+   WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE SOFTWARE.
+*/
+
+// Short_Cycle_Kernels.h declares the dense matrix multiplication and
+// elementwise kernels used by Short_Cycle_Matrix.  The multiplication
+// kernels are cache blocked and register tiled.  On x86 processors AVX-512
+// or AVX2 versions are selected at run time; other processors and
+// compilers use a portable version.  Integer arithmetic wraps modulo 2^w.
+ 
+#ifndef SHORT_CYCLE_KERNELS
+#define SHORT_CYCLE_KERNELS
+
+#include <stddef.h>
+#include <stdint.h>
+
+// c += a \times b for row major a (m x k), b (k x n) and c (m x n) with
+// leading dimensions lda, ldb and ldc.
+void mx_gemm( int m, int n, int k, const uint32_t* a, int lda,
+			  const uint32_t* b, int ldb, uint32_t* c, int ldc );
+void mx_gemm( int m, int n, int k, const uint64_t* a, int lda,
+			  const uint64_t* b, int ldb, uint64_t* c, int ldc );
+void mx_gemm( int m, int n, int k, const double* a, int lda,
+			  const double* b, int ldb, double* c, int ldc );
+
+// Elementwise kernels over n contiguous elements.  They are branch free
+// and instantiated for uint32_t, uint64_t and double.
+template <class T> void mx_add_n( size_t n, const T* x, T* y );		   // y = y + x
+template <class T> void mx_sub_n( size_t n, const T* x, T* y );		   // y = y - x
+template <class T> void mx_mul_n( size_t n, const T* x, T* y );		   // y = y o x
+template <class T> void mx_scale_n( size_t n, T s, T* y );				   // y = s*y
+template <class T> void mx_choose_2_n( size_t n, T s, const T* x, T* y ); // y = s*binom(x,2)
+template <class T> void mx_choose_3_n( size_t n, T s, const T* x, T* y ); // y = s*binom(x,3)
+
+// The instruction set used by the kernels: 2 for AVX-512, 1 for AVX2 and
+// 0 for the portable version.
+int mx_isa( void );
+ 
+#endif
@@ -36,59 +36,173 @@
 #include <iostream>
 #include <fstream>
 #include <math.h>
+#include <string.h>
+#include <limits.h>
 #include <string>
+// BLAS is optional.  Define SCM_USE_CBLAS to use cblas_dgemm and
+// cblas_daxpy for double matrices.
 // NOTE: Location of cblas.h is machine dependent.
+#ifdef SCM_USE_CBLAS
 //#include "openblas/cblas.h"
 #include "vecLib/cblas.h"
+#endif
 #include "Short_Cycle_Matrix.h"
+#include "Short_Cycle_Sparse_Matrix.h"
+#include "Short_Cycle_Diag_Matrix.h"
+#include "Short_Cycle_Edge_Matrix.h"
+#include "Short_Cycle_Kernels.h"
 
 using namespace std;
+
+// Dense kernels.  Products use the kernels of Short_Cycle_Kernels.h
+// unless BLAS is enabled for double.
+#ifdef SCM_USE_CBLAS
+static void mx_product( int m, int n, int k, const double* a, int lda,
+						const double* b, int ldb, double* c, int ldc )
+{
+	cblas_dgemm(CblasRowMajor,CblasNoTrans,CblasNoTrans,m,n,k,1.0,a,lda,b,ldb,1.0,c,ldc);
+}
+
+static void mx_add( size_t n, const double* x, double* y ) { cblas_daxpy((int)n,1.0,x,1,y,1); }
+static void mx_sub( size_t n, const double* x, double* y ) { cblas_daxpy((int)n,-1.0,x,1,y,1); }
+#endif
+
+template <class T>
+static void mx_product( int m, int n, int k, const T* a, int lda,
+						const T* b, int ldb, T* c, int ldc )
+{
+	mx_gemm(m,n,k,a,lda,b,ldb,c,ldc);
+}
+
+template <class T>
+static void mx_add( size_t n, const T* x, T* y ) { mx_add_n(n,x,y); }
+
+template <class T>
+static void mx_sub( size_t n, const T* x, T* y ) { mx_sub_n(n,x,y); }
+
+// Out-of-core products.  Products over mapped matrices (see
+// Short_Cycle_Pool.h) work through blocks of about SCM_TILE_BYTES of
+// rows and prefetch the operand rows of the next block while the current
+// one is computed.  Elementwise passes are sequential and left to the
+// read ahead of the system.
+static int mx_tile_rows( int nc, size_t el_bytes )
+{
+	size_t rows = SCM_TILE_BYTES/((size_t)(nc > 0 ? nc : 1)*el_bytes);
+	return rows > (size_t)INT_MAX ? INT_MAX : (rows > 0 ? (int)rows : 1);
+}
+
+// Prefetch the rows of in selected by rows from..to-1 of sel.
+template <class T>
+static void mx_prefetch_rows( const Short_Cycle_Sparse_Matrix& sel, int from, int to,
+							  const T* in, int ld )
+{
+	if( to > sel.e_nr() ) to = sel.e_nr();
+	const int* row_ptr = sel.row_ptr();
+	const int* col_idx = sel.col_idx();
+	for( int pp = (from < to ? row_ptr[from] : 0); from < to && pp < row_ptr[to]; pp++ ) 
+	{
+		mx_prefetch(in+(size_t)col_idx[pp]*ld,ld*sizeof(T));
+	}
+}
+
 // Constructors.
-Short_Cycle_Matrix::Short_Cycle_Matrix( void )
-  : data_(NULL), i_nc_(0), i_nr_(0), e_nc_(0), e_nr_(0), set_(0)
+template <class T>
+Short_Cycle_Matrix<T>::Short_Cycle_Matrix( void )
+  : data_(NULL), i_nc_(0), i_nr_(0), e_nc_(0), e_nr_(0), lift_(0), set_(0), n_alloc_(0), pool_(NULL)
 {
 	return;
 }
 	
-Short_Cycle_Matrix::Short_Cycle_Matrix( const Short_Cycle_Matrix& copy_mx )
+template <class T>
+Short_Cycle_Matrix<T>::Short_Cycle_Matrix( const Short_Cycle_Matrix& copy_mx )
+  : data_(NULL), lift_(0), set_(0), n_alloc_(0), pool_(NULL)
 {
 	*this = copy_mx;
 }
 
-Short_Cycle_Matrix::~Short_Cycle_Matrix( void )
+template <class T>
+Short_Cycle_Matrix<T>::~Short_Cycle_Matrix( void )
 {
-	if( set_ ) 
-	{ 
-		delete [] data_; 
-		set_ = 0; 
-	}
+	delete_data();
 }
 	
-Short_Cycle_Matrix& Short_Cycle_Matrix::operator=( const Short_Cycle_Matrix& copy_mx )
+template <class T>
+Short_Cycle_Matrix<T>& Short_Cycle_Matrix<T>::operator=( const Short_Cycle_Matrix& copy_mx )
 {
-	if( set_ ) delete [] data_;
+	if( this == &copy_mx ) return *this;
 	
 	// Copy the matrix dimensions.
 	e_nc_ = copy_mx.e_nc_;
 	e_nr_ = copy_mx.e_nr_;
 	i_nc_ = copy_mx.i_nc_;
 	i_nr_ = copy_mx.i_nr_;
+	lift_ = copy_mx.lift_;
 	
 	// Copy the matrix data.
-	data_ = new double[i_nr_*i_nc_];
-	memcpy(data_,copy_mx.data_,i_nr_*i_nc_*sizeof(double));
-	set_ = 1;
+	allocate();
+	memcpy(data_,copy_mx.data_,(size_t)i_nr_*i_nc_*sizeof(T));
 	
 	return* this;
 }
 
+// Binomial coefficients are formed by the elementwise kernels.  The 
+// operand may be *this.
+template <class T>
+Short_Cycle_Matrix<T>& Short_Cycle_Matrix<T>::operator=( const Mx_Choose_2<T,Short_Cycle_Matrix>& x )
+{
+	copy_size(x.operand());
+	allocate();
+	mx_choose_2_n((size_t)i_nr_*i_nc_,x.scale(),x.operand().data(),data_);
+	return *this;
+}
+
+template <class T>
+Short_Cycle_Matrix<T>& Short_Cycle_Matrix<T>::operator=( const Mx_Choose_3<T,Short_Cycle_Matrix>& x )
+{
+	copy_size(x.operand());
+	allocate();
+	mx_choose_3_n((size_t)i_nr_*i_nc_,x.scale(),x.operand().data(),data_);
+	return *this;
+}
+
+#if __cplusplus >= 201103L
+template <class T>
+Short_Cycle_Matrix<T>::Short_Cycle_Matrix( Short_Cycle_Matrix&& move_mx )
+  : data_(move_mx.data_), i_nc_(move_mx.i_nc_), i_nr_(move_mx.i_nr_),
+	e_nc_(move_mx.e_nc_), e_nr_(move_mx.e_nr_), lift_(move_mx.lift_), set_(move_mx.set_), 
+	n_alloc_(move_mx.n_alloc_), pool_(move_mx.pool_)
+{
+	move_mx.data_ = NULL;
+	move_mx.set_  = 0;
+}
+
+template <class T>
+Short_Cycle_Matrix<T>& Short_Cycle_Matrix<T>::operator=( Short_Cycle_Matrix&& move_mx )
+{
+	if( this == &move_mx ) return *this;
+	delete_data();
+	
+	copy_size(move_mx);
+	data_    = move_mx.data_;
+	set_     = move_mx.set_;
+	n_alloc_ = move_mx.n_alloc_;
+	pool_    = move_mx.pool_;
+	move_mx.data_ = NULL;
+	move_mx.set_  = 0;
+	
+	return *this;
+}
+#endif
+
 
 // Read an incidence matrix from a file.
-void Short_Cycle_Matrix::read_incidence_matrix_file( int nc, int nr, const char* filename )
+template <class T>
+void Short_Cycle_Matrix<T>::read_incidence_matrix_file( int nc, int nr, const char* filename )
 {
 	// Set the matrix dimensions.
 	e_nc_ = nc;
 	e_nr_ = nr;	
+	lift_ = 0;
 	set_i_nc();
 	set_i_nr();
 
@@ -103,285 +217,800 @@ void Short_Cycle_Matrix::read_incidence_matrix_file( int nc, int nr, const char*
 		for( int cc = 0, pp = ww; cc < e_nc_; cc++, pp++ )
 		{
 			fin >> tmp; 
-			data_[pp] = tmp+0.0;
+			data_[pp] = (T)tmp;
 		}
 	}
 	
 	fin.close();
 }
 
-// Read an incidence matrix from an alist file.
-void Short_Cycle_Matrix::read_alist_file( const char* filename )
+// Read an incidence matrix from an alist file (see
+// Short_Cycle_Sparse_Matrix::read_alist_file()).
+template <class T>
+int Short_Cycle_Matrix<T>::read_alist_file( const char* filename )
 {
-	// Read the matrix dimensions from the file along
-	// with the extraneous maximum vertex degree information. 
-	ifstream fin(filename);
-	int nc, nr, tmp, tmp2;
-	fin >> nr >> nc >> tmp >> tmp2;
-	cout << " " << nr << " " << nc << " " << tmp << " " << tmp2 << "\n";
+	Short_Cycle_Sparse_Matrix E;
+	if( !E.read_alist_file(filename) ) return 0;
+	
 	// Set the matrix dimensions.
-	e_nc_ = nc;
-	e_nr_ = nr;
+	e_nc_ = E.e_nc();
+	e_nr_ = E.e_nr();
+	lift_ = 0;
 	set_i_nc();
 	set_i_nr();
 	
-	// Allocate the data memory.
+	// Allocate the data memory and set the 1's of each row.
 	reset_data();
-	
-
-	// Read in the number of 1's per row.
-	// Skip over the number of 1's per column.
-	int ii, jj, rp;
-	int* row_weights = new int[nr];
-	for( ii = 0; ii < nr; ii++ ) { fin >> tmp; row_weights[ii] = tmp; }
-	for( ii = 0; ii < nc; ii++ ) { fin >> tmp; }
-	
-	// Read in the 1's in each row and set the matrix data.
-	for( ii = 0, rp = 0; ii < nr; ii++, rp+=i_nc_ )
+	for( int rr = 0; rr < e_nr_; rr++ )
 	{
-		for( jj = 0; jj < row_weights[ii]; jj++ )
-		{
-			fin >> tmp;
-			//NEW LINES TO HANDLE D.MACKAY IRREGULAR GRAPHS (WHERE ALIST FILE ZERO PADS EACH LINE)
-			while (tmp == 0)
-				fin >> tmp;
-			data_[rp+tmp-1] = 1.0; // The alist format indexes rows from 1.
-			
-		}
+		for( int pp = E.row_ptr()[rr]; pp < E.row_ptr()[rr+1]; pp++ ) data_[(size_t)rr*i_nc_+E.col_idx()[pp]] = 1;
 	}
 	
-	delete [] row_weights;
-	fin.close();
+	return 1;
 }
 
 // Given that the external nc has been set,
 // set the appropriate internal nc.
-void Short_Cycle_Matrix::set_i_nc( void )
+template <class T>
+void Short_Cycle_Matrix<T>::set_i_nc( void )
 {
-	if( e_nc_%4 == 0 )      i_nc_ = e_nc_;
-	else if( e_nc_%4 == 1 ) i_nc_ = e_nc_+3;
-	else if( e_nc_%4 == 2 ) i_nc_ = e_nc_+2;
-	else 					i_nc_ = e_nc_+1;
+	i_nc_ = internal_dim(e_nc_);
 }
 
 // Given that the external nr has been set,
 // set the appropriate internal nr.
-void Short_Cycle_Matrix::set_i_nr( void )
+template <class T>
+void Short_Cycle_Matrix<T>::set_i_nr( void )
 {
-	if( e_nr_%4 == 0 )      i_nr_ = e_nr_;
-	else if( e_nr_%4 == 1 ) i_nr_ = e_nr_+3;
-	else if( e_nr_%4 == 2 ) i_nr_ = e_nr_+2;
-	else 					i_nr_ = e_nr_+1;
+	i_nr_ = internal_dim(e_nr_);
+}
+
+// The internal dimension corresponding to an external 
+// dimension e_dim, i.e., e_dim rounded up to a multiple of SCM_PAD.
+template <class T>
+int Short_Cycle_Matrix<T>::internal_dim( int e_dim )
+{
+	return (e_dim+SCM_PAD-1)/SCM_PAD*SCM_PAD;
 }
 
 // Reset the data to all zero elements.
-void Short_Cycle_Matrix::reset_data( void )
+template <class T>
+void Short_Cycle_Matrix<T>::reset_data( void )
 {
-	if( set_ ) delete [] data_;
-	data_ = new double[i_nr_*i_nc_];
-	memset(data_,0,i_nr_*i_nc_*sizeof(double));
-	set_ = 1;
+	allocate();
+	memset(data_,0,(size_t)i_nr_*i_nc_*sizeof(T));
 }
 
 // Free the matrix data.
-void Short_Cycle_Matrix::delete_data( void )
+template <class T>
+void Short_Cycle_Matrix<T>::delete_data( void )
 {
-	if( set_ ) delete [] data_;
-	set_ = 0;
+	if( set_ ) mx_free(data_,n_alloc_,pool_);
+	data_    = NULL;
+	n_alloc_ = 0;
+	pool_    = NULL;
+	set_     = 0;
+}
+
+// Allocate memory for i_nr_*i_nc_ elements.  The memory is drawn from 
+// the current Short_Cycle_Pool (if any), to which delete_data() returns
+// it, and is not initialized.
+template <class T>
+void Short_Cycle_Matrix<T>::allocate( void )
+{
+	if( set_ && n_alloc_ == (size_t)i_nr_*i_nc_ ) return;
+	delete_data();
+	n_alloc_ = (size_t)i_nr_*i_nc_;
+	data_    = mx_alloc<T>(n_alloc_,pool_);
+	set_     = 1;
+}
+
+// Refer to rows r0 ... r1-1 of source.  set_ is clear, so the rows
+// are never freed through *this.
+template <class T>
+void Short_Cycle_Matrix<T>::view_rows( const Short_Cycle_Matrix& source, int r0, int r1 )
+{
+	delete_data();
+	e_nc_ = source.e_nc_;
+	e_nr_ = (source.e_nr_ < r1 ? source.e_nr_ : r1)-r0;
+	i_nc_ = source.i_nc_;
+	i_nr_ = r1-r0;
+	lift_ = 0;
+	if( e_nr_ < 0 ) e_nr_ = 0;
+	data_ = source.data_+(size_t)r0*i_nc_;
 }
 
 // Copy the dimensions, but not data, of copy_mx into *this.
-void Short_Cycle_Matrix::copy_size( const Short_Cycle_Matrix& copy_mx )
+template <class T>
+void Short_Cycle_Matrix<T>::copy_size( const Short_Cycle_Matrix& copy_mx )
 {
 	e_nc_ = copy_mx.e_nc();
 	e_nr_ = copy_mx.e_nr();
 	i_nc_ = copy_mx.i_nc();
 	i_nr_ = copy_mx.i_nr();
+	lift_ = copy_mx.lift();
 }
 
 // Copy the dimensions, but not data, of copy_mx^T into *this. 
-void Short_Cycle_Matrix::copy_transpose_size( const Short_Cycle_Matrix& copy_mx )
+template <class T>
+void Short_Cycle_Matrix<T>::copy_transpose_size( const Short_Cycle_Matrix& copy_mx )
 {
 	e_nc_ = copy_mx.e_nr();
 	e_nr_ = copy_mx.e_nc();
 	i_nc_ = copy_mx.i_nr();
 	i_nr_ = copy_mx.i_nc();
+	lift_ = 0;
+}
+
+// Take the external rows of a product from left, or its generating rows
+// if left is lifted.
+template <class T>
+void Short_Cycle_Matrix<T>::set_rows( const Short_Cycle_Sparse_Matrix& left )
+{
+	lift_ = left.lift();
+	e_nr_ = left.gen_nr();
+	i_nr_ = (lift_ ? internal_dim(e_nr_) : left.i_nr());
 }
 
 // Matrix trace.
-double Short_Cycle_Matrix::trace( void ) const
+template <class T>
+T Short_Cycle_Matrix<T>::trace( void ) const
 {
-	double sum = 0.0;
+	T sum = 0;
 	for( int ii = 0, pp = 0; ii < e_nr_; ii++, pp+=(i_nc_+1) ) sum += data_[pp];
-	return sum;
+	return (lift_ ? (T)lift_*sum : sum);
 }
 
-// Set *this to source^T.
-void Short_Cycle_Matrix::transpose( const Short_Cycle_Matrix& source )
+// Matrix trace accumulated in 64 bits.  Each diagonal element is assumed
+// to be an exact count even when the sum is not representable in T.
+template <class T>
+int64_t Short_Cycle_Matrix<T>::int_trace( void ) const
 {
-	if( set_ ) delete [] data_;
-	copy_transpose_size(source);
+	int64_t sum = 0;
+	for( int ii = 0, pp = 0; ii < e_nr_; ii++, pp+=(i_nc_+1) ) sum += (int64_t)data_[pp];
+	return (lift_ ? lift_*sum : sum);
+}
+
+// Trace of *this \times right_t^T.  Each row-wise dot product is a
+// diagonal element and is accumulated in 64 bits.
+template <class T>
+int64_t Short_Cycle_Matrix<T>::trace_mult( const Short_Cycle_Matrix& right_t ) const
+{
+	int64_t sum = 0;
+	for( int rr = 0; rr < e_nr_; rr++ )
+	{
+		const T* l = data_+(size_t)rr*i_nc_;
+		const T* r = right_t.data_+(size_t)rr*right_t.i_nc_;
+		T dot = 0;
+		for( int kk = 0; kk < i_nc_; kk++ ) dot += l[kk]*r[kk];
+		sum += (int64_t)dot;
+	}
 	
-	data_ = new double[i_nr_*i_nc_];
-	for( int rr = 0, oo = 0; rr < i_nr_; rr++, oo += i_nc_ )
+	return (lift_ ? lift_*sum : sum);
+}
+
+// Trace of *this \times right_t^T where right_t is sparse.
+template <class T>
+int64_t Short_Cycle_Matrix<T>::trace_mult( const Short_Cycle_Sparse_Matrix& right_t ) const
+{
+	const int* row_ptr = right_t.row_ptr();
+	const int* col_idx = right_t.col_idx();
+	int64_t sum = 0;
+	for( int rr = 0; rr < e_nr_; rr++ )
+	{
+		const T* l = data_+(size_t)rr*i_nc_;
+		T dot = 0;
+		for( int pp = row_ptr[rr]; pp < row_ptr[rr+1]; pp++ ) dot += l[col_idx[pp]];
+		sum += (int64_t)dot;
+	}
+	
+	return (lift_ ? lift_*sum : sum);
+}
+
+// Set *this to source^T.  The generating rows of a lifted transpose are
+// read from the columns of the full source.
+template <class T>
+void Short_Cycle_Matrix<T>::transpose( const Short_Cycle_Matrix& source )
+{
+	if( source.lift_ )
 	{
-		for( int cc = 0, pp = oo; cc < i_nc_; cc++, pp++ ) data_[pp] = source(cc,rr);
+		e_nc_ = source.e_nr_*source.lift_;
+		e_nr_ = source.e_nc_/source.lift_;
+		set_i_nc();
+		set_i_nr();
+		reset_data();
+		lift_ = source.lift_;
+		for( int rr = 0; rr < e_nr_; rr++ )
+		{
+			T* out = data_+(size_t)rr*i_nc_;
+			for( int cc = 0; cc < e_nc_; cc++ ) out[cc] = source.lifted(cc,rr);
+		}
+		
+		return;
 	}
 	
-	set_ = 1;
+	copy_transpose_size(source);
+	allocate();
+	
+	size_t oo = 0;
+	for( int rr = 0; rr < i_nr_; rr++, oo += i_nc_ )
+	{
+		for( int cc = 0; cc < i_nc_; cc++ ) data_[oo+cc] = source(cc,rr);
+	}
 }
 
-// *this = left \times right
-void Short_Cycle_Matrix::matrix_mult( Short_Cycle_Matrix& left,
-									  Short_Cycle_Matrix& right )
+// *this = left \times right.  The epilogue is applied to the zeroed rows
+// before the product is accumulated, i.e., it plays the role of the beta
+// term of GEMM and costs no extra pass over the product.
+template <class T>
+void Short_Cycle_Matrix<T>::matrix_mult( const Short_Cycle_Matrix& left,
+										 const Short_Cycle_Matrix& right,
+										 const Mx_Row_Op<T>* epilogue )
 {
 	// Set dimensions and allocate data memory.
 	e_nc_ = right.e_nc();
 	e_nr_ = left.e_nr();
 	i_nc_ = right.i_nc();
 	i_nr_ = left.i_nr();
+	lift_ = left.lift();
 
 	reset_data();
+	if( epilogue ) 
+	{
+		for( int rr = 0; rr < i_nr_; rr++ ) epilogue->apply(rr,0,data_+(size_t)rr*i_nc_);
+	}
+	
+	// Each nonzero left(r,k) adds row k of a lifted right, rotated.
+	if( right.lift() )
+	{
+		for( int rr = 0; rr < e_nr_; rr++ )
+		{
+			const T* in = left.data()+(size_t)rr*left.i_nc();
+			T* out = data_+(size_t)rr*i_nc_;
+			for( int kk = 0; kk < left.e_nc(); kk++ )
+			{
+				T val = in[kk];
+				if( val == 0 ) continue;
+				int shift;
+				const T* src = right.lifted_row(kk,shift);
+				for( int cc = shift; cc < e_nc_; cc++ ) out[cc] += val*src[cc-shift];
+				for( int cc = 0; cc < shift; cc++ ) out[cc] += val*src[cc-shift+e_nc_];
+			}
+		}
+		
+		return;
+	}
 	
-	// Use BLAS matrix multiplication.
-	cblas_dgemm(CblasRowMajor,CblasNoTrans,CblasNoTrans,i_nr_,i_nc_,left.i_nc(),1.0,
-				left.data(),left.i_nc(),right.data(),i_nc_,0.0,data_,i_nc_);
+	// Mapped operands are multiplied a block of rows at a time, so that
+	// the block of the product stays resident while right streams past.
+	int tile = i_nr_;
+	if( mx_buffer_mapped(data_) || mx_buffer_mapped(left.data()) || mx_buffer_mapped(right.data()) )
+	{
+		tile = mx_tile_rows(i_nc_+left.i_nc(),sizeof(T));
+	}
+	
+	for( int rr = 0; rr < i_nr_; rr += tile )
+	{
+		int mb = (i_nr_-rr < tile ? i_nr_-rr : tile);
+		const T* a = left.data()+(size_t)rr*left.i_nc();
+		if( rr+mb < i_nr_ ) mx_prefetch(a+(size_t)mb*left.i_nc(),(size_t)mb*left.i_nc()*sizeof(T));
+		mx_product(mb,i_nc_,left.i_nc(),a,left.i_nc(),right.data(),i_nc_,data_+(size_t)rr*i_nc_,i_nc_);
+	}
+}
+
+// *this = Z[left \times right]
+// Assumes a square matrix results.  The diagonal is zeroed before the
+// epilogue is applied, so the epilogue follows the product here.
+template <class T>
+void Short_Cycle_Matrix<T>::mx_mult_zero( const Short_Cycle_Matrix& left,
+										  const Short_Cycle_Matrix& right,
+										  const Mx_Row_Op<T>* epilogue ) 
+{
+	matrix_mult(left,right);
+	Mx_Zero_Diag<T> zero(epilogue);
+	for( int r = 0; r < i_nr_; r++ ) zero.apply(r,0,data_+(size_t)r*i_nc_);	
 }
 
-// *this = (left \times right) o I
-// Assumes a square matrix results.	
-void Short_Cycle_Matrix::mx_mult_diag( const Short_Cycle_Matrix& left,
-									   const Short_Cycle_Matrix& right )
+// *this = left \times right where both operands are sparse.  Only
+// sum_k (nonzeros in row k of right)*(nonzeros in column k of left)
+// operations are required.
+template <class T>
+void Short_Cycle_Matrix<T>::matrix_mult( const Short_Cycle_Sparse_Matrix& left,
+									  const Short_Cycle_Sparse_Matrix& right )
 {
-	// Set dimensions and allocate memory.
+	// Set dimensions and allocate data memory.
 	e_nc_ = right.e_nc();
-	e_nr_ = left.e_nr();
 	i_nc_ = right.i_nc();
-	i_nr_ = left.i_nr();
+	set_rows(left);
 
 	reset_data();
 	
-	// Perform multiplication only for diagonal elements.
-	double sum;
-	int inner = left.i_nc();
-	for( int rr = 0; rr < i_nr_; rr++ )
+	const int* l_row_ptr = left.row_ptr();
+	const int* l_col_idx = left.col_idx();
+	const int* r_row_ptr = right.row_ptr();
+	const int* r_col_idx = right.col_idx();
+	for( int rr = 0; rr < e_nr_; rr++ )
 	{
-		sum = 0.0;
-		for( int kk = 0; kk < inner; kk++ ) sum += left(rr,kk)*right(kk,rr);
-		data_[rr*i_nc_+rr] = sum;
+		T* out = data_+(size_t)rr*i_nc_;
+		for( int pp = l_row_ptr[rr]; pp < l_row_ptr[rr+1]; pp++ )
+		{
+			int kk = l_col_idx[pp];
+			for( int qq = r_row_ptr[kk]; qq < r_row_ptr[kk+1]; qq++ ) out[r_col_idx[qq]] += 1;
+		}
 	}
 }
 
-// *this = Z[left \times right]
-// Assumes a square matrix results.
-void Short_Cycle_Matrix::mx_mult_zero( Short_Cycle_Matrix& left,
-									   Short_Cycle_Matrix& right ) 
+// *this = left \times right where left is sparse.  Each row of the
+// result is the sum of the rows of right selected by a row of left,
+// so only nnz(left)*i_nc operations are required.  The rows of a lifted
+// right are added in two runs either side of their rotation.
+template <class T>
+void Short_Cycle_Matrix<T>::matrix_mult( const Short_Cycle_Sparse_Matrix& left,
+										 const Short_Cycle_Matrix& right,
+										 const Mx_Row_Op<T>* epilogue )
 {
-	matrix_mult(left,right);
-	for( int r = 0; r < i_nr_; r++ ) data_[r*i_nc_+r] = 0.0;	
+	// Set dimensions and allocate data memory.
+	e_nc_ = right.e_nc();
+	i_nc_ = right.i_nc();
+	set_rows(left);
+
+	reset_data();
+	
+	if( right.lift() )
+	{
+		const int* row_ptr = left.row_ptr();
+		const int* col_idx = left.col_idx();
+		for( int rr = 0; rr < e_nr_; rr++ )
+		{
+			T* out = data_+(size_t)rr*i_nc_;
+			for( int pp = row_ptr[rr]; pp < row_ptr[rr+1]; pp++ )
+			{
+				int shift;
+				const T* src = right.lifted_row(col_idx[pp],shift);
+				for( int cc = shift; cc < e_nc_; cc++ ) out[cc] += src[cc-shift];
+				for( int cc = 0; cc < shift; cc++ ) out[cc] += src[cc-shift+e_nc_];
+			}
+			
+			if( epilogue ) epilogue->apply(rr,0,out);
+		}
+		
+		return;
+	}
+	
+	const int* row_ptr = left.row_ptr();
+	const int* col_idx = left.col_idx();
+	const T* in = right.data();
+	int tile = (mx_buffer_mapped(in) ? mx_tile_rows(i_nc_,sizeof(T)) : 0);
+	if( tile ) mx_prefetch_rows(left,0,tile,in,i_nc_);
+	for( int rr = 0; rr < e_nr_; rr++ )
+	{
+		if( tile && rr%tile == 0 ) mx_prefetch_rows(left,rr+tile,rr+2*tile,in,i_nc_);
+		T* out = data_+(size_t)rr*i_nc_;
+		for( int pp = row_ptr[rr]; pp < row_ptr[rr+1]; pp++ )
+		{
+			const T* src = in+(size_t)col_idx[pp]*i_nc_;
+			for( int cc = 0; cc < i_nc_; cc++ ) out[cc] += src[cc];
+		}
+		
+		if( epilogue ) epilogue->apply(rr,0,out);
+	}
 }
 
-// Use BLAS matrix addition.
-void Short_Cycle_Matrix::operator+=( Short_Cycle_Matrix& right )
+// *this = left \times right where right is sparse.  Each nonzero
+// left(r,k) is added to the columns of row r selected by row k of right,
+// so only i_nr*nnz(right) operations are required.
+template <class T>
+void Short_Cycle_Matrix<T>::matrix_mult( const Short_Cycle_Matrix& left,
+										 const Short_Cycle_Sparse_Matrix& right,
+										 const Mx_Row_Op<T>* epilogue )
 {
-	cblas_daxpy(i_nr_*i_nc_,1.0,right.data(),1,data_,1);
+	// Set dimensions and allocate data memory.
+	e_nc_ = right.e_nc();
+	e_nr_ = left.e_nr();
+	i_nc_ = right.i_nc();
+	i_nr_ = left.i_nr();
+	lift_ = left.lift();
+
+	reset_data();
+	
+	const int* row_ptr = right.row_ptr();
+	const int* col_idx = right.col_idx();
+	int inner = right.e_nr();
+	int tile = (mx_buffer_mapped(left.data()) ? mx_tile_rows(left.i_nc(),sizeof(T)) : 0);
+	for( int rr = 0; rr < i_nr_; rr++ )
+	{
+		const T* in = left.data()+(size_t)rr*left.i_nc();
+		if( tile && rr%tile == 0 && rr+tile < i_nr_ ) 
+		{
+			mx_prefetch(in+(size_t)tile*left.i_nc(),(size_t)tile*left.i_nc()*sizeof(T));
+		}
+		
+		T* out = data_+(size_t)rr*i_nc_;
+		for( int kk = 0; kk < inner; kk++ )
+		{
+			T val = in[kk];
+			if( val == 0 ) continue;
+			for( int pp = row_ptr[kk]; pp < row_ptr[kk+1]; pp++ ) out[col_idx[pp]] += val;
+		}
+		
+		if( epilogue ) epilogue->apply(rr,0,out);
+	}
 }
 
-// Use BLAS matrix addition.
-void Short_Cycle_Matrix::operator-=( Short_Cycle_Matrix& right )
+// *this = left \times right where the product is symmetric and both
+// operands are sparse.  Only the elements on or above the diagonal are
+// accumulated.  start[k] is the first nonzero of row k of right in 
+// column rr or later; the column indices are sorted within each row,
+// so it only moves forward as rr increases.
+template <class T>
+void Short_Cycle_Matrix<T>::matrix_mult_sym( const Short_Cycle_Sparse_Matrix& left,
+											 const Short_Cycle_Sparse_Matrix& right )
 {
-	cblas_daxpy(i_nr_*i_nc_,-1.0,right.data(),1,data_,1);
+	// Set dimensions and allocate data memory.
+	e_nc_ = right.e_nc();
+	e_nr_ = left.e_nr();
+	i_nc_ = right.i_nc();
+	i_nr_ = left.i_nr();
+
+	// The column-wise reads of the mirror would thrash a mapped matrix,
+	// and the generating rows of a lifted product are not symmetric.
+	allocate();
+	if( mx_buffer_mapped(data_) || left.lift() ) 
+	{
+		matrix_mult(left,right);
+		return;
+	}
+	
+	reset_data();
+	
+	const int* l_row_ptr = left.row_ptr();
+	const int* l_col_idx = left.col_idx();
+	const int* r_row_ptr = right.row_ptr();
+	const int* r_col_idx = right.col_idx();
+	int inner = right.e_nr();
+	int* start = new int[inner+1];
+	memcpy(start,r_row_ptr,(inner+1)*sizeof(int));
+	for( int rr = 0; rr < e_nr_; rr++ )
+	{
+		T* out = data_+(size_t)rr*i_nc_;
+		for( int pp = l_row_ptr[rr]; pp < l_row_ptr[rr+1]; pp++ )
+		{
+			int kk = l_col_idx[pp], qq = start[kk];
+			while( qq < r_row_ptr[kk+1] && r_col_idx[qq] < rr ) qq++;
+			start[kk] = qq;
+			for( ; qq < r_row_ptr[kk+1]; qq++ ) out[r_col_idx[qq]] += 1;
+		}
+	}
+	
+	delete [] start;
+	mirror_upper();
 }
+
+// *this = left \times right where the product is symmetric and right is 
+// sparse.  As above, only the upper triangle is accumulated and each row
+// of the epilogue is applied from the diagonal on.
+template <class T>
+void Short_Cycle_Matrix<T>::matrix_mult_sym( const Short_Cycle_Matrix& left,
+											 const Short_Cycle_Sparse_Matrix& right,
+											 const Mx_Row_Op<T>* epilogue )
+{
+	// Set dimensions and allocate data memory.
+	e_nc_ = right.e_nc();
+	e_nr_ = left.e_nr();
+	i_nc_ = right.i_nc();
+	i_nr_ = left.i_nr();
+
+	allocate();
+	if( mx_buffer_mapped(data_) || left.lift() ) 
+	{
+		matrix_mult(left,right,epilogue);
+		return;
+	}
 	
-// Direct matrix product.	
-void Short_Cycle_Matrix::operator*=( const Short_Cycle_Matrix& right )
-{		
-	for( int rr = 0, oo = 0; rr < i_nr_; rr++, oo += i_nc_ )
+	reset_data();
+	
+	const int* row_ptr = right.row_ptr();
+	const int* col_idx = right.col_idx();
+	int inner = right.e_nr();
+	int* start = new int[inner+1];
+	memcpy(start,row_ptr,(inner+1)*sizeof(int));
+	for( int rr = 0; rr < i_nr_; rr++ )
 	{
-		for( int cc = 0, pp = oo; cc < i_nc_; cc++, pp++ )
+		const T* in = left.data()+(size_t)rr*left.i_nc();
+		T* out = data_+(size_t)rr*i_nc_;
+		for( int kk = 0; kk < inner; kk++ )
 		{
-			data_[pp] *= right[pp];
+			int pp = start[kk];
+			while( pp < row_ptr[kk+1] && col_idx[pp] < rr ) pp++;
+			start[kk] = pp;
+			
+			T val = in[kk];
+			if( val == 0 ) continue;
+			for( ; pp < row_ptr[kk+1]; pp++ ) out[col_idx[pp]] += val;
 		}
+		
+		if( epilogue ) epilogue->apply(rr,rr,out);
 	}
+	
+	delete [] start;
+	mirror_upper();
 }
 
-// Multiplication by a constant.
-void Short_Cycle_Matrix::operator*=( double right )
+// Copy the upper triangle of a square matrix into the lower triangle.
+// The copy is blocked so that the transposed reads stay in cache.
+template <class T>
+void Short_Cycle_Matrix<T>::mirror_upper( void )
 {
-	for( int rr = 0, oo = 0; rr < i_nr_; rr++, oo += i_nc_ )
+	const int block = 64;
+	for( int r0 = 0; r0 < i_nr_; r0 += block )
 	{
-		for( int cc = 0, pp = oo; cc < i_nc_; cc++, pp++ )
+		for( int c0 = 0; c0 <= r0; c0 += block )
 		{
-			data_[pp] *= right;
+			for( int rr = r0; rr < r0+block && rr < i_nr_; rr++ )
+			{
+				for( int cc = c0; cc < c0+block && cc < rr; cc++ ) data_[(size_t)rr*i_nc_+cc] = data_[(size_t)cc*i_nc_+rr];
+			}
 		}
 	}
 }
 
-// Direct matrix product.
-Short_Cycle_Matrix operator*( const Short_Cycle_Matrix& left,
-							  const Short_Cycle_Matrix& right )
+// *this = Z[left \times right] where left is sparse.
+// Assumes a square matrix results.
+template <class T>
+void Short_Cycle_Matrix<T>::mx_mult_zero( const Short_Cycle_Sparse_Matrix& left,
+										  const Short_Cycle_Matrix& right,
+										  const Mx_Row_Op<T>* epilogue ) 
 {
-	Short_Cycle_Matrix out;
-	out.copy_size(left);
-	out.reset_data();
+	Mx_Zero_Diag<T> zero(epilogue);
+	matrix_mult(left,right,&zero);
+}
+
+// *this = left \times right where left is diagonal, i.e., the
+// rows of right are scaled by the diagonal of left.
+template <class T>
+void Short_Cycle_Matrix<T>::matrix_mult( const Short_Cycle_Diag_Matrix<T>& left,
+									  const Short_Cycle_Matrix& right )
+{
+	copy_size(right);
+	allocate();
+	
+	size_t oo = 0;
+	for( int rr = 0; rr < i_nr_; rr++, oo += i_nc_ )
+	{
+		T val = left[rr];
+		for( int cc = 0; cc < i_nc_; cc++ ) data_[oo+cc] = val*right[oo+cc];
+	}
+}
+
+// *this = left \times right where right is diagonal, i.e., the
+// columns of left are scaled by the diagonal of right.
+template <class T>
+void Short_Cycle_Matrix<T>::matrix_mult( const Short_Cycle_Matrix& left,
+									  const Short_Cycle_Diag_Matrix<T>& right )
+{
+	copy_size(left);
+	allocate();
 	
-	for( int rr = 0, oo = 0; rr < out.i_nr(); rr++, oo += out.i_nc() )
+	const T* d = right.data();
+	size_t oo = 0;
+	for( int rr = 0; rr < i_nr_; rr++, oo += i_nc_ )
 	{
-		for( int cc = 0, pp = oo; cc < out.i_nc(); cc++, pp++ )
+		for( int cc = 0; cc < i_nc_; cc++ ) data_[oo+cc] = left[oo+cc]*d[cc];
+	}
+}
+
+// *this = left \times right where left is sparse and right is diagonal,
+// i.e., each nonzero left(r,c) is replaced by the c-th diagonal element.
+template <class T>
+void Short_Cycle_Matrix<T>::matrix_mult( const Short_Cycle_Sparse_Matrix& left,
+									  const Short_Cycle_Diag_Matrix<T>& right )
+{
+	// Set dimensions and allocate data memory.
+	e_nc_ = left.e_nc();
+	i_nc_ = left.i_nc();
+	set_rows(left);
+
+	reset_data();
+	
+	const int* row_ptr = left.row_ptr();
+	const int* col_idx = left.col_idx();
+	size_t oo = 0;
+	for( int rr = 0; rr < e_nr_; rr++, oo += i_nc_ )
+	{
+		for( int pp = row_ptr[rr]; pp < row_ptr[rr+1]; pp++ ) data_[oo+col_idx[pp]] = right[col_idx[pp]];
+	}
+}
+
+// Subtract a diagonal matrix, only from the generating rows if lifted.
+template <class T>
+void Short_Cycle_Matrix<T>::operator-=( const Short_Cycle_Diag_Matrix<T>& right )
+{
+	int n = (lift_ ? e_nr_ : right.i_n());
+	for( int ii = 0, pp = 0; ii < n; ii++, pp += (i_nc_+1) ) data_[pp] -= right[ii];
+}
+
+// *this = left \times right where left is sparse and right is an edge
+// matrix.  Each nonzero left(r,k) adds the stored elements of row k of
+// right to row r, so only sum_k (nnz in column k of left)*(nnz in row k
+// of right) operations are required.
+template <class T>
+void Short_Cycle_Matrix<T>::matrix_mult( const Short_Cycle_Sparse_Matrix& left,
+										 const Short_Cycle_Edge_Matrix<T>& right,
+										 const Mx_Row_Op<T>* epilogue )
+{
+	const Short_Cycle_Sparse_Matrix& pattern = right.pattern();
+	
+	// Set dimensions and allocate data memory.
+	e_nc_ = pattern.e_nc();
+	i_nc_ = pattern.i_nc();
+	set_rows(left);
+
+	reset_data();
+	
+	const int* l_row_ptr = left.row_ptr();
+	const int* l_col_idx = left.col_idx();
+	const int* r_row_ptr = pattern.row_ptr();
+	const int* r_col_idx = pattern.col_idx();
+	const T* in = right.data();
+	for( int rr = 0; rr < e_nr_; rr++ )
+	{
+		T* out = data_+(size_t)rr*i_nc_;
+		for( int pp = l_row_ptr[rr]; pp < l_row_ptr[rr+1]; pp++ )
 		{
-			out.set_el(pp,left[pp]*right[pp]);
+			int kk = l_col_idx[pp];
+			for( int qq = r_row_ptr[kk]; qq < r_row_ptr[kk+1]; qq++ ) out[r_col_idx[qq]] += in[qq];
 		}
+		
+		if( epilogue ) epilogue->apply(rr,0,out);
 	}
-	
-	return out;
 }
 
-// Multiplication by a constant.
-Short_Cycle_Matrix operator*( double left, const Short_Cycle_Matrix& right )
+// *this = Z[left \times right] where left is sparse and right is an
+// edge matrix.  Assumes a square matrix results.
+template <class T>
+void Short_Cycle_Matrix<T>::mx_mult_zero( const Short_Cycle_Sparse_Matrix& left,
+										  const Short_Cycle_Edge_Matrix<T>& right,
+										  const Mx_Row_Op<T>* epilogue ) 
 {
-	Short_Cycle_Matrix out = right;
-	out *= left;
-	return out;
+	Mx_Zero_Diag<T> zero(epilogue);
+	matrix_mult(left,right,&zero);
+}
+
+// Add an edge matrix, on the generating rows if lifted.
+template <class T>
+void Short_Cycle_Matrix<T>::operator+=( const Short_Cycle_Edge_Matrix<T>& right )
+{
+	const int* row_ptr = right.pattern().row_ptr();
+	const int* col_idx = right.pattern().col_idx();
+	size_t oo = 0;
+	int n = (lift_ ? e_nr_ : right.pattern().e_nr());
+	for( int rr = 0; rr < n; rr++, oo += i_nc_ )
+	{
+		for( int pp = row_ptr[rr]; pp < row_ptr[rr+1]; pp++ ) data_[oo+col_idx[pp]] += right[pp];
+	}
 }
 
-Short_Cycle_Matrix Short_Cycle_Matrix::mx_choose_2( double mult_fac )
+// Subtract an edge matrix, on the generating rows if lifted.
+template <class T>
+void Short_Cycle_Matrix<T>::operator-=( const Short_Cycle_Edge_Matrix<T>& right )
 {
-	Short_Cycle_Matrix out = *this;
-	for( int ii = 0; ii < out.i_nc()*out.i_nr(); ii++ )
+	const int* row_ptr = right.pattern().row_ptr();
+	const int* col_idx = right.pattern().col_idx();
+	size_t oo = 0;
+	int n = (lift_ ? e_nr_ : right.pattern().e_nr());
+	for( int rr = 0; rr < n; rr++, oo += i_nc_ )
 	{
-		out.set_el(ii,mult_fac*out[ii]*(out[ii]-1.0)/2.0);
+		for( int pp = row_ptr[rr]; pp < row_ptr[rr+1]; pp++ ) data_[oo+col_idx[pp]] -= right[pp];
 	}
+}
+
+// Matrix addition.
+template <class T>
+void Short_Cycle_Matrix<T>::operator+=( Short_Cycle_Matrix& right )
+{
+	mx_add((size_t)i_nr_*i_nc_,right.data(),data_);
+}
+
+// Matrix subtraction.
+template <class T>
+void Short_Cycle_Matrix<T>::operator-=( Short_Cycle_Matrix& right )
+{
+	mx_sub((size_t)i_nr_*i_nc_,right.data(),data_);
+}
 	
-	return out;
+// Direct matrix product.	
+template <class T>
+void Short_Cycle_Matrix<T>::operator*=( const Short_Cycle_Matrix& right )
+{		
+	mx_mul_n((size_t)i_nr_*i_nc_,right.data(),data_);
 }
 
-Short_Cycle_Matrix Short_Cycle_Matrix::mx_choose_3( double mult_fac )
+// Direct matrix product with a sparse (0/1) matrix, i.e., every
+// element of *this outside the sparsity pattern of right is zeroed.
+template <class T>
+void Short_Cycle_Matrix<T>::operator*=( const Short_Cycle_Sparse_Matrix& right )
 {
-	Short_Cycle_Matrix out = *this;
-	for( int ii = 0; ii < out.i_nc()*out.i_nr(); ii++ )
+	const int* row_ptr = right.row_ptr();
+	const int* col_idx = right.col_idx();
+	size_t oo = 0;
+	for( int rr = 0; rr < i_nr_; rr++, oo += i_nc_ )
 	{
-		out.set_el(ii,mult_fac*out[ii]*(out[ii]-1.0)*(out[ii]-2.0)/6.0);
+		if( rr >= right.e_nr() ) { memset(data_+oo,0,i_nc_*sizeof(T)); continue; }
+		
+		// Zero the runs of elements between consecutive nonzeros of right.
+		int cc = 0;
+		for( int pp = row_ptr[rr]; pp < row_ptr[rr+1]; pp++ )
+		{
+			memset(data_+oo+cc,0,(col_idx[pp]-cc)*sizeof(T));
+			cc = col_idx[pp]+1;
+		}
+		
+		memset(data_+oo+cc,0,(i_nc_-cc)*sizeof(T));
+	}
+}
+
+// Multiplication by a constant.
+template <class T>
+void Short_Cycle_Matrix<T>::operator*=( T right )
+{
+	mx_scale_n((size_t)i_nr_*i_nc_,right,data_);
+}
+
+// Direct matrix product with a sparse (0/1) matrix.
+template <class T>
+Short_Cycle_Matrix<T> operator*( const Short_Cycle_Matrix<T>& left,
+								 const Short_Cycle_Sparse_Matrix& right )
+{
+	Short_Cycle_Matrix<T> out;
+	out.copy_size(left);
+	out.reset_data();
+	
+	const int* row_ptr = right.row_ptr();
+	const int* col_idx = right.col_idx();
+	size_t oo = 0;
+	int n = (left.lift() ? left.e_nr() : right.e_nr());
+	for( int rr = 0; rr < n; rr++, oo += out.i_nc() )
+	{
+		for( int pp = row_ptr[rr]; pp < row_ptr[rr+1]; pp++ ) 
+		{
+			out.set_el(oo+col_idx[pp],left[oo+col_idx[pp]]);
+		}
 	}
 	
 	return out;
 }
 
-void Short_Cycle_Matrix::diagonal( double* d )
+template <class T>
+void Short_Cycle_Matrix<T>::diagonal( double* d )
 {
-	for( int ii = 0, pp = 0; ii < e_nr_; ii++, pp+=(i_nc_+1) ) d[ii] = data_[pp];
+	for( int ii = 0, pp = 0; ii < e_nr_; ii++, pp+=(i_nc_+1) ) d[ii] = (double)data_[pp];
+	for( int ii = e_nr_; ii < e_nr_*lift_; ii++ ) d[ii] = d[ii-e_nr_];
 }
 
-ostream& operator<<( ostream& os, Short_Cycle_Matrix& mx )
+template <class T>
+ostream& operator<<( ostream& os, const Short_Cycle_Matrix<T>& mx )
 {
-	for( int rr = 0, oo = 0; rr < mx.e_nr_; rr++, oo += mx.i_nc_ )
+	for( int rr = 0; rr < mx.e_nr(); rr++ )
 	{
-		for( int cc = 0, pp = oo; cc < mx.e_nc_; cc++, pp++ )
+		for( int cc = 0; cc < mx.e_nc(); cc++ )
 		{
-			os << mx.data_[pp] << " ";
+			os << mx(rr,cc) << " ";
 		}
 		
 		os << endl;
 	}
 
 	return os;
-}
\ No newline at end of file
+}
+
+// Explicit instantiations for the supported element types.
+template class Short_Cycle_Matrix<double>;
+template class Short_Cycle_Matrix<uint32_t>;
+template class Short_Cycle_Matrix<uint64_t>;
+
+template Short_Cycle_Matrix<double> operator*( const Short_Cycle_Matrix<double>&, const Short_Cycle_Sparse_Matrix& );
+template Short_Cycle_Matrix<uint32_t> operator*( const Short_Cycle_Matrix<uint32_t>&, const Short_Cycle_Sparse_Matrix& );
+template Short_Cycle_Matrix<uint64_t> operator*( const Short_Cycle_Matrix<uint64_t>&, const Short_Cycle_Sparse_Matrix& );
+template ostream& operator<<( ostream&, const Short_Cycle_Matrix<double>& );
+template ostream& operator<<( ostream&, const Short_Cycle_Matrix<uint32_t>& );
+template ostream& operator<<( ostream&, const Short_Cycle_Matrix<uint64_t>& );
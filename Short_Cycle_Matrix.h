@@ -35,26 +35,96 @@
 
 // Short_Cycle_Matrix.h defines the matrix class used by the
 // short cycle counter.  The distinction between "internal" and "external"
-// exists in order to take advantage of Apple's AltiVec instruction set
-// that requires matrix dimensions to be multiples of 4.
+// dimensions exists for the vector kernels: internal dimensions are padded
+// to a multiple of SCM_PAD elements and buffers are SCM_ALIGN byte aligned
+// (see Short_Cycle_Pool.h), so every row starts on a cache line and the
+// padded rows can be processed in whole vectors.
+//
+// The matrix is templated on its element type T.  The counter uses the
+// unsigned integer types uint32_t and uint64_t since every element is a
+// path or cycle count; double is kept for the BLAS based products.  The
+// implementation is explicitly instantiated for these three types in
+// Short_Cycle_Matrix.cpp.
+//
+// A matrix is also the leaf of the expressions of Short_Cycle_Expr.h, so
+// that, e.g., L -= mx_prod(D,M) - P*Q is evaluated in a single pass.
+//
+// A lifted matrix (lift() = Z > 0) is the block circulant matrix of a
+// quasi-cyclic code (see Short_Cycle_Sparse_Matrix.h) and only its e_nr
+// generating rows are stored.  Row s*e_nr+b is generating row b rotated
+// s*e_nc/Z places to the right, and since generating row b is also row b
+// of the full matrix, the diagonal, elementwise, row and column scaling
+// and dense times sparse operations apply to the stored rows unchanged.
+// A product with a lifted sparse left operand forms only the generating
+// rows, and the rows of a dense right operand are rotated as they are
+// read.  Lifted operands give lifted results and the traces are those of
+// the full matrix, so the counter runs with storage and work reduced by
+// a factor of Z.
  
 #ifndef SHORT_CYCLE_MATRIX
 #define SHORT_CYCLE_MATRIX
 
 #include <iostream>
+#include <stddef.h>
+#include <stdint.h>
+
+// Internal dimensions are multiples of SCM_PAD elements.  The default of
+// 16 makes every row a multiple of 64 bytes for each element type.
+#ifndef SCM_PAD
+#define SCM_PAD 16
+#endif
+
+class Short_Cycle_Sparse_Matrix;
+template <class T> class Short_Cycle_Diag_Matrix;
+template <class T> class Short_Cycle_Edge_Matrix;
+
+// binom(x,2) and binom(x,3) for a count x.  For the (unsigned) integer
+// types the even one of x and x-1 is halved before multiplying, and 3 is
+// divided out of x(x-1)(x-2)/2 by multiplying with its inverse modulo 2^w,
+// so the result is exact modulo 2^w whenever x itself is exact.  Both are
+// branch free and give 0 for x < 2 and x < 3 respectively.
+template <class T>
+inline T mx_binom_2( T x )
+{
+	T odd = -(x & 1);
+	return (((x >> 1)*(x-1)) & ~odd) | ((x*((x-1) >> 1)) & odd);
+}
+
+template <class T>
+inline T mx_binom_3( T x )
+{
+	const T inv3 = ((T)~(T)0)/3*2+1;
+	return mx_binom_2(x)*(x-2)*inv3;
+}
+
+inline double mx_binom_2( double x ) { return x*(x-1.0)/2.0; }
+inline double mx_binom_3( double x ) { return x*(x-1.0)*(x-2.0)/6.0; }
+
+#include "Short_Cycle_Expr.h"
+#include "Short_Cycle_Pool.h"
  
-class Short_Cycle_Matrix
+template <class T>
+class Short_Cycle_Matrix : public Mx_Expr< T, Short_Cycle_Matrix<T> >
 {
   public:
 	// Constructors.
 	Short_Cycle_Matrix( void );
 	Short_Cycle_Matrix( const Short_Cycle_Matrix& copy_mx );
+	template <class X> Short_Cycle_Matrix( const Mx_Expr<T,X>& x );
 	~Short_Cycle_Matrix( void );
 	Short_Cycle_Matrix& operator=( const Short_Cycle_Matrix& copy_mx ); 
+	template <class X> Short_Cycle_Matrix& operator=( const Mx_Expr<T,X>& x ); 
+	Short_Cycle_Matrix& operator=( const Mx_Choose_2<T,Short_Cycle_Matrix>& x );
+	Short_Cycle_Matrix& operator=( const Mx_Choose_3<T,Short_Cycle_Matrix>& x );
+#if __cplusplus >= 201103L
+	// Moves take the data of the source instead of copying it.
+	Short_Cycle_Matrix( Short_Cycle_Matrix&& move_mx );
+	Short_Cycle_Matrix& operator=( Short_Cycle_Matrix&& move_mx );
+#endif
 	
 	// Methods for reading matrices from files.
 	void read_incidence_matrix_file( int nc, int nr, const char* filename );
-	void read_alist_file( const char* filename );
+	int read_alist_file( const char* filename );	// 0 if it cannot be read.
 	
 	// Accessors.
 	int set( void )  const { return set_; };
@@ -62,13 +132,34 @@ class Short_Cycle_Matrix
 	int i_nr( void ) const { return i_nr_; };
 	int e_nc( void ) const { return e_nc_; };
 	int e_nr( void ) const { return e_nr_; };
-	double get_el( int p ) { return data_[p]; };
-	double get_el( int r, int c ) const { return data_[i_nc_*r+c]; };
-	double operator[]( int p ) const { return data_[p]; };
-	double operator()( int r, int c ) const { return data_[i_nc_*r+c]; };
+	int lift( void ) const { return lift_; };
+	T get_el( size_t p ) { return data_[p]; };
+	T get_el( int r, int c ) const { return data_[(size_t)i_nc_*r+c]; };
+	T operator[]( size_t p ) const { return data_[p]; };
+	T operator()( int r, int c ) const { return data_[(size_t)i_nc_*r+c]; };
+	
+	// Element (r,c) of the full matrix, which for a lifted matrix is 
+	// element (c-shift) mod e_nc of the stored row returned by lifted_row(). 
+	T lifted( int r, int c ) const
+	{
+		int shift;
+		const T* row = lifted_row(r,shift);
+		return row[c < shift ? c-shift+e_nc_ : c-shift];
+	};
+	const T* lifted_row( int r, int& shift ) const
+	{
+		int s = (lift_ ? r/e_nr_ : 0);
+		shift = (lift_ ? s*(e_nc_/lift_) : 0);
+		return data_+(size_t)(r-s*e_nr_)*i_nc_;
+	};
+	
+	// Expression leaf interface (see Short_Cycle_Expr.h).
+	T at( int, int, size_t p ) const { return data_[p]; };
+	const Short_Cycle_Matrix& shape( void ) const { return *this; };
 	
 	// Data accessor needed by BLAS multiplication methods.
-	double* data( void ) { return data_; }; 
+	T* data( void ) { return data_; }; 
+	const T* data( void ) const { return data_; };
 	
 	// Dimension setting methods.
 	void set_e_nc( int e_nc ) { e_nc_ = e_nc; };
@@ -77,55 +168,237 @@ class Short_Cycle_Matrix
 	void set_i_nr( void ); // Set i_nr_ using e_nr_.
 	void set_i_nc( int i_nc ) { i_nc_ = i_nc; };
 	void set_i_nr( int i_nr ) { i_nr_ = i_nr; };
+	static int internal_dim( int e_dim ); // Internal dimension for e_dim.
 	void copy_size( const Short_Cycle_Matrix& copy_mx );
 	void copy_transpose_size( const Short_Cycle_Matrix& copy_mx );
 	
+	// Refer to rows r0 ... r1-1 of source, which may include padding rows,
+	// without copying them.  *this does not own the rows and must only be
+	// read, and only while source is unchanged.
+	void view_rows( const Short_Cycle_Matrix& source, int r0, int r1 );
+	
 	// Elementing setting methods.
-	void set_el( int r, int c, double v ) { data_[r*i_nc_+c] = v; };
-	void dec_el( int p, double v ) { data_[p] -= v; };
-	void set_el( int p, double v ) { data_[p] = v; };
+	void set_el( int r, int c, T v ) { data_[(size_t)r*i_nc_+c] = v; };
+	void dec_el( size_t p, T v ) { data_[p] -= v; };
+	void set_el( size_t p, T v ) { data_[p] = v; };
 	void reset_data( void );
 	
 	// Free the matrix memory.
 	void delete_data( void );
 	
-	// Matrix trace.
-	double trace( void ) const;
-	int int_trace( void ) const { return (int)trace(); };
+	// Allocate (uninitialized) memory for the internal dimensions.  The
+	// current buffer is kept if it already has the right size.
+	void allocate( void );
+	
+	// Matrix trace, that of the full matrix if lifted.
+	T trace( void ) const;
+	int64_t int_trace( void ) const; // The trace accumulated in 64 bits.
+	
+	// Trace of *this \times right_t^T without forming the product, i.e.,
+	// the sum of the row-wise dot products of *this and right_t.
+	int64_t trace_mult( const Short_Cycle_Matrix& right_t ) const;
+	int64_t trace_mult( const Short_Cycle_Sparse_Matrix& right_t ) const;
 	
-	// Matrix operations.
+	// Matrix operations.  The optional epilogue is applied to each row of
+	// the result, e.g., by matrix_mult_sub() below.
 	void transpose( const Short_Cycle_Matrix& source );   // *this = source^T 
-	void matrix_mult( Short_Cycle_Matrix& left,
-					  Short_Cycle_Matrix& right );        // *this = left \times right
-	void mx_mult_diag( const Short_Cycle_Matrix& left,
-					   const Short_Cycle_Matrix& right ); // *this = (left \times right) o I
-	void mx_mult_zero( Short_Cycle_Matrix& left,
-					   Short_Cycle_Matrix& right );       // *this = Z(left \times right)
+	void matrix_mult( const Short_Cycle_Matrix& left,
+					  const Short_Cycle_Matrix& right,
+					  const Mx_Row_Op<T>* epilogue = NULL );  // *this = left \times right
+	void mx_mult_zero( const Short_Cycle_Matrix& left,
+					   const Short_Cycle_Matrix& right,
+					   const Mx_Row_Op<T>* epilogue = NULL ); // *this = Z(left \times right)
+	
+	// Matrix operations with a sparse (incidence) operand.
+	void matrix_mult( const Short_Cycle_Sparse_Matrix& left,
+					  const Short_Cycle_Sparse_Matrix& right ); // *this = left \times right
+	void matrix_mult( const Short_Cycle_Sparse_Matrix& left,
+					  const Short_Cycle_Matrix& right,
+					  const Mx_Row_Op<T>* epilogue = NULL );   // *this = left \times right
+	void matrix_mult( const Short_Cycle_Matrix& left,
+					  const Short_Cycle_Sparse_Matrix& right,
+					  const Mx_Row_Op<T>* epilogue = NULL );   // *this = left \times right
+	void mx_mult_zero( const Short_Cycle_Sparse_Matrix& left,
+					   const Short_Cycle_Matrix& right,
+					   const Mx_Row_Op<T>* epilogue = NULL );  // *this = Z(left \times right)
+	void operator*=( const Short_Cycle_Sparse_Matrix& right );    // *this = *this o right
+	
+	// Products known to be symmetric, e.g., the even length path matrices
+	// P_{2k}.  Only the upper triangle is formed, which halves the work,
+	// and it is then mirrored.  The epilogue must also be symmetric.
+	void matrix_mult_sym( const Short_Cycle_Sparse_Matrix& left,
+						  const Short_Cycle_Sparse_Matrix& right ); // *this = left \times right
+	void matrix_mult_sym( const Short_Cycle_Matrix& left,
+						  const Short_Cycle_Sparse_Matrix& right,
+						  const Mx_Row_Op<T>* epilogue = NULL );   // *this = left \times right
+	void mirror_upper( void ); // Copy the upper triangle into the lower.
+	
+	// Matrix operations with a diagonal operand.
+	void matrix_mult( const Short_Cycle_Diag_Matrix<T>& left,
+					  const Short_Cycle_Matrix& right );        // *this = left \times right
+	void matrix_mult( const Short_Cycle_Matrix& left,
+					  const Short_Cycle_Diag_Matrix<T>& right );   // *this = left \times right
+	void matrix_mult( const Short_Cycle_Sparse_Matrix& left,
+					  const Short_Cycle_Diag_Matrix<T>& right );   // *this = left \times right
+	void operator-=( const Short_Cycle_Diag_Matrix<T>& right );      // *this = *this - right
+	
+	// Matrix operations with an edge-indexed operand.
+	void matrix_mult( const Short_Cycle_Sparse_Matrix& left,
+					  const Short_Cycle_Edge_Matrix<T>& right,
+					  const Mx_Row_Op<T>* epilogue = NULL );      // *this = left \times right
+	void mx_mult_zero( const Short_Cycle_Sparse_Matrix& left,
+					   const Short_Cycle_Edge_Matrix<T>& right,
+					   const Mx_Row_Op<T>* epilogue = NULL );     // *this = Z(left \times right)
+	void operator+=( const Short_Cycle_Edge_Matrix<T>& right );      // *this = *this + right
+	void operator-=( const Short_Cycle_Edge_Matrix<T>& right );      // *this = *this - right
+	
 	void operator+=( Short_Cycle_Matrix& right );         // *this = *this + right
 	void operator-=( Short_Cycle_Matrix& right );		  // *this = *this - right
 	void operator*=( const Short_Cycle_Matrix& right );   // *this = *this o right
-	void operator*=( double right );					  // *this = right*(*this)
-	friend Short_Cycle_Matrix operator*( const Short_Cycle_Matrix& left,
-										 const Short_Cycle_Matrix& right );
-	friend Short_Cycle_Matrix operator*( double left, const Short_Cycle_Matrix& right );
+	void operator*=( T right );						  // *this = right*(*this)
 	
-	Short_Cycle_Matrix mx_choose_2( double mult_fac );
-	Short_Cycle_Matrix mx_choose_3( double mult_fac );
+	// Expression updates, each a single pass without temporaries.
+	template <class X> void operator+=( const Mx_Expr<T,X>& x ); // *this = *this + x
+	template <class X> void operator-=( const Mx_Expr<T,X>& x ); // *this = *this - x
 	
-	// Place the matrix diagonal in d.  The external matrix dimension is used. 
-	void diagonal( double* d );
+	// Products fused with the subtraction of an expression, which is
+	// applied row by row as each row of the product is formed.  For
+	// dense operands it is folded into the accumulating GEMM instead.
+	template <class L, class R, class X> 
+	void matrix_mult_sub( const L& left, const R& right,
+						  const Mx_Expr<T,X>& sub );  // *this = left \times right - sub
+	template <class L, class R, class X> 
+	void mx_mult_zero_sub( const L& left, const R& right,
+						   const Mx_Expr<T,X>& sub ); // *this = Z(left \times right) - sub
+	template <class L, class R, class X> 
+	void matrix_mult_sym_sub( const L& left, const R& right,
+							  const Mx_Expr<T,X>& sub ); // *this = left \times right - sub
 	
-	// Output matrix for debugging.
-	friend std::ostream& operator<<(std::ostream& os, Short_Cycle_Matrix& mx );
+	// mult_fac*binom(*this,2) and mult_fac*binom(*this,3) elementwise.
+	// Exact for integer T provided the elements are true (unwrapped) counts.
+	Mx_Choose_2<T,Short_Cycle_Matrix> mx_choose_2( T mult_fac ) const
+	{ 
+		return Mx_Choose_2<T,Short_Cycle_Matrix>(mult_fac,*this); 
+	};
+	Mx_Choose_3<T,Short_Cycle_Matrix> mx_choose_3( T mult_fac ) const
+	{ 
+		return Mx_Choose_3<T,Short_Cycle_Matrix>(mult_fac,*this); 
+	};
+	
+	// Place the matrix diagonal in d.  The external matrix dimension is used,
+	// times the lifting size if lifted. 
+	void diagonal( double* d );
 	
   private:
-	double*     data_;
+	// Take the rows and lifting size of a product from its sparse left operand.
+	void set_rows( const Short_Cycle_Sparse_Matrix& left );
+	
+
+	T*          data_;
 	int			i_nc_;		// "Internal" matrix dimensions.
 	int			i_nr_;		
 	int			e_nc_;      // "External" matrix dimensions. 
 	int			e_nr_;
+	int			lift_;		// Lifting size if lifted, 0 otherwise.
 	int			set_;		// Flag indicating if memory allocated.
+	size_t		n_alloc_;	// Number of elements allocated.
+	Short_Cycle_Pool* pool_; // Pool data_ came from, if any.
 };
+
+// Direct matrix product with a sparse matrix.  The direct product of two
+// matrices and multiplication by a constant are expressions.
+template <class T>
+Short_Cycle_Matrix<T> operator*( const Short_Cycle_Matrix<T>& left,
+								 const Short_Cycle_Sparse_Matrix& right );
+
+// Output matrix for debugging.
+template <class T>
+std::ostream& operator<<( std::ostream& os, const Short_Cycle_Matrix<T>& mx );
+
+// Expression evaluation.  Every node reads only element p of its matrix
+// operands, so *this may itself appear in the expression.
+template <class T> template <class X>
+Short_Cycle_Matrix<T>::Short_Cycle_Matrix( const Mx_Expr<T,X>& x )
+  : data_(NULL), lift_(0), set_(0), n_alloc_(0), pool_(NULL)
+{
+	*this = x;
+}
+
+template <class T> template <class X>
+Short_Cycle_Matrix<T>& Short_Cycle_Matrix<T>::operator=( const Mx_Expr<T,X>& x )
+{
+	const X& e = x.self();
+	const Short_Cycle_Matrix& shape = e.shape();
+	T* out = data_;
+	Short_Cycle_Pool* pool = pool_;
+	size_t n = (size_t)shape.i_nr()*shape.i_nc();
+	if( !set_ || n_alloc_ != n ) out = mx_alloc<T>(n,pool);
+	
+	size_t oo = 0;
+	for( int rr = 0; rr < shape.i_nr(); rr++, oo += shape.i_nc() )
+	{
+		for( int cc = 0; cc < shape.i_nc(); cc++ ) out[oo+cc] = e.at(rr,cc,oo+cc);
+	}
+	
+	copy_size(shape);
+	if( out != data_ )
+	{
+		if( set_ ) mx_free(data_,n_alloc_,pool_);
+		data_    = out;
+		n_alloc_ = n;
+		pool_    = pool;
+		set_     = 1;
+	}
+	
+	return *this;
+}
+
+template <class T> template <class X>
+void Short_Cycle_Matrix<T>::operator+=( const Mx_Expr<T,X>& x )
+{
+	const X& e = x.self();
+	size_t oo = 0;
+	for( int rr = 0; rr < i_nr_; rr++, oo += i_nc_ )
+	{
+		for( int cc = 0; cc < i_nc_; cc++ ) data_[oo+cc] += e.at(rr,cc,oo+cc);
+	}
+}
+
+template <class T> template <class X>
+void Short_Cycle_Matrix<T>::operator-=( const Mx_Expr<T,X>& x )
+{
+	const X& e = x.self();
+	size_t oo = 0;
+	for( int rr = 0; rr < i_nr_; rr++, oo += i_nc_ )
+	{
+		for( int cc = 0; cc < i_nc_; cc++ ) data_[oo+cc] -= e.at(rr,cc,oo+cc);
+	}
+}
+
+template <class T> template <class L, class R, class X> 
+void Short_Cycle_Matrix<T>::matrix_mult_sub( const L& left, const R& right,
+											 const Mx_Expr<T,X>& sub )
+{
+	Mx_Sub_Row<T,X> epilogue(sub.self());
+	matrix_mult(left,right,&epilogue);
+}
+
+template <class T> template <class L, class R, class X> 
+void Short_Cycle_Matrix<T>::mx_mult_zero_sub( const L& left, const R& right,
+											  const Mx_Expr<T,X>& sub )
+{
+	Mx_Sub_Row<T,X> epilogue(sub.self());
+	mx_mult_zero(left,right,&epilogue);
+}
+
+template <class T> template <class L, class R, class X> 
+void Short_Cycle_Matrix<T>::matrix_mult_sym_sub( const L& left, const R& right,
+												 const Mx_Expr<T,X>& sub )
+{
+	Mx_Sub_Row<T,X> epilogue(sub.self());
+	matrix_mult_sym(left,right,&epilogue);
+}
+
  
 #endif
 
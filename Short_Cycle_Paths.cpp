@@ -0,0 +1,157 @@
+/* Short_Cycle_Paths.cpp
+
+   Copyright (c) 2005 Thomas R. Halford 
+   All rights reserved.
+ 
+   Developed by: Thomas R. Halford
+                 Communication Sciences Institute
+                 University of Southern California
+                 http://csi.usc.edu
+ 
+   Permission is hereby granted, free of charge, to any person obtaining a copy 
+   of this software and associated documentation files (the "Software"), to deal 
+   with the Software without restriction, including without limitation the rights 
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+   copies of the Software, and to permit persons to whom the Software is furnished 
+   to do so, subject to the following conditions:
+  
+    * Redistributions of source code must retain the above copyright notice, this 
+      list of conditions and the following disclaimers.
+    * Redistributions in binary form must reproduce the above copyright notice, 
+      this list of conditions and the following disclaimers in the documentation 
+      and/or other materials provided with the distribution.
+    * Neither the names of Thomas R. Halford, the Communication Sciences Institute, 
+      the University of Southern California nor the names of its contributors may 
+      be used to endorse or promote products derived from this Software without 
+      specific prior written permission. 
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+   INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+   PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE CONTRIBUTORS OR 
+   COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN 
+   AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION 
+   WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE SOFTWARE.
+*/
+
+
+#include "Short_Cycle_Paths.h"
+
+using namespace std;
+
+Short_Cycle_Paths::Short_Cycle_Paths( void )
+ : E_(NULL), ET_(NULL), U_(0), W_(0), u_(0), w_(0), shortest_(0), longest_(0), N_(NULL), per_u_(NULL), 
+   per_edge_(NULL), sign_(0)
+{
+	return;
+}
+
+// A breadth first search from u to depth bound-1 that does not take the
+// edge to w.  Vertex ww of W is vertex U_+ww.  The distances are kept
+// for count() and cleared by the next search.
+int Short_Cycle_Paths::shortest( const Short_Cycle_Sparse_Matrix& E, const Short_Cycle_Sparse_Matrix& ET,
+								 int u, int w, int bound )
+{
+	if( E.e_nr() != U_ || E.e_nc() != W_ )
+	{
+		U_ = E.e_nr();
+		W_ = E.e_nc();
+		dist_.assign(U_+W_,-1);
+		on_path_.assign(U_+W_,0);
+		queue_.clear();
+	}
+	
+	for( size_t ii = 0; ii < queue_.size(); ii++ ) dist_[queue_[ii]] = -1;
+	queue_.clear();
+	E_  = &E;
+	ET_ = &ET;
+	u_  = u;
+	w_  = U_+w;
+	
+	const int* row_ptr = E.row_ptr();
+	const int* col_idx = E.col_idx();
+	const int* t_row_ptr = ET.row_ptr();
+	const int* t_col_idx = ET.col_idx();
+	
+	size_t head = 0;
+	queue_.push_back(u);
+	dist_[u] = 0;
+	while( head < queue_.size() )
+	{
+		int vv = queue_[head++];
+		int dv = dist_[vv];
+		if( dv+2 > bound ) break;
+		
+		int first = (vv < U_ ? row_ptr[vv] : t_row_ptr[vv-U_]);
+		int last  = (vv < U_ ? row_ptr[vv+1] : t_row_ptr[vv-U_+1]);
+		for( int pp = first; pp < last; pp++ )
+		{
+			int xx = (vv < U_ ? U_+col_idx[pp] : t_col_idx[pp]);
+			if( dist_[xx] >= 0 || (vv == u && xx == w_) ) continue;
+			dist_[xx] = dv+1;
+			queue_.push_back(xx);
+		}
+	}
+	
+	return (dist_[w_] > 0 ? dist_[w_]+1 : 0);
+}
+
+void Short_Cycle_Paths::count( int shortest, int longest, int64_t* N, double* per_u, double* per_edge, int sign )
+{
+	if( dist_[w_] < 0 ) return;
+	shortest_ = shortest;
+	longest_  = longest;
+	N_ = N;
+	per_u_ = per_u;
+	per_edge_ = per_edge;
+	sign_ = sign;
+	path_.clear();
+	edges_.clear();
+	
+	// The edge (u,w) closes every cycle.
+	int uw = E_->find(u_,w_-U_);
+	if( uw >= 0 ) edges_.push_back(uw);
+	on_path_[w_] = 1;
+	extend(w_,0);
+	on_path_[w_] = 0;
+}
+
+// Extend a path from w that has reached vv after depth steps.  A vertex
+// is only worth a visit if its distance to u is known and small enough
+// to close a cycle of at most longest_ edges.  The position in E of an
+// edge from a vertex of W is found in the row of its vertex in U.
+void Short_Cycle_Paths::extend( int vv, int depth )
+{
+	const int* ptr = (vv < U_ ? E_->row_ptr() : ET_->row_ptr());
+	const int* idx = (vv < U_ ? E_->col_idx() : ET_->col_idx());
+	int row = (vv < U_ ? vv : vv-U_);
+	for( int pp = ptr[row]; pp < ptr[row+1]; pp++ )
+	{
+		int xx = (vv < U_ ? U_+idx[pp] : idx[pp]);
+		if( on_path_[xx] || dist_[xx] < 0 || depth+2+dist_[xx] > longest_ ) continue;
+		
+		// A cycle of depth+2 edges, unless it is the edge itself.
+		if( xx == u_ && (depth == 0 || depth+2 < shortest_) ) continue;
+		edges_.push_back(vv < U_ ? pp : E_->find(xx,vv-U_));
+		if( xx == u_ )
+		{
+			int kk = (depth+2-shortest_)/2;
+			double* per_u = per_u_+(size_t)kk*U_;
+			double* per_edge = per_edge_+(size_t)kk*E_->nnz();
+			N_[kk] += sign_;
+			per_u[u_] += 2*sign_;
+			for( size_t ii = 0; ii < path_.size(); ii++ ) per_u[path_[ii]] += 2*sign_;
+			for( size_t ii = 0; ii < edges_.size(); ii++ ) per_edge[edges_[ii]] += sign_;
+		}
+		
+		else
+		{
+			on_path_[xx] = 1;
+			if( xx < U_ ) path_.push_back(xx);
+			extend(xx,depth+1);
+			if( xx < U_ ) path_.pop_back();
+			on_path_[xx] = 0;
+		}
+		
+		edges_.pop_back();
+	}
+}
@@ -0,0 +1,96 @@
+/* Short_Cycle_Paths.h
+
+   Copyright (c) 2005 Thomas R. Halford 
+   All rights reserved.
+ 
+   Developed by: Thomas R. Halford
+                 Communication Sciences Institute
+                 University of Southern California
+                 http://csi.usc.edu
+ 
+   Permission is hereby granted, free of charge, to any person obtaining a copy 
+   of this software and associated documentation files (the "Software"), to deal 
+   with the Software without restriction, including without limitation the rights 
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+   copies of the Software, and to permit persons to whom the Software is furnished 
+   to do so, subject to the following conditions:
+  
+    * Redistributions of source code must retain the above copyright notice, this 
+      list of conditions and the following disclaimers.
+    * Redistributions in binary form must reproduce the above copyright notice, 
+      this list of conditions and the following disclaimers in the documentation 
+      and/or other materials provided with the distribution.
+    * Neither the names of Thomas R. Halford, the Communication Sciences Institute, 
+      the University of Southern California nor the names of its contributors may 
+      be used to endorse or promote products derived from this Software without 
+      specific prior written permission. 
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+   INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+   PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE CONTRIBUTORS OR 
+   COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN 
+   AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION 
+   WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE SOFTWARE.
+*/
+
+// Short_Cycle_Paths.h counts the short cycles through one edge (u,w) of
+// a bipartite graph, each of which is a path from w to u that avoids
+// the edge, closed by it.  A breadth first search from u gives the
+// distance of every vertex to u, and so the shortest such cycle; a
+// depth first search from w then lists the paths, abandoning any that
+// cannot reach u within the longest length wanted.  Only the vertices
+// within that length of u are touched, so the cost depends on the
+// neighbourhood of the edge and not on the size of the graph.
+// Short_Cycle_Counter uses it to update its counts as edges are added
+// and removed.
+
+#ifndef SHORT_CYCLE_PATHS
+#define SHORT_CYCLE_PATHS
+
+#include <vector>
+#include <stdint.h>
+#include "Short_Cycle_Sparse_Matrix.h"
+
+class Short_Cycle_Paths
+{
+  public:
+	Short_Cycle_Paths( void );
+	
+	// The length of the shortest cycle through the edge between vertex u
+	// of U and vertex w of W in the graph with incidence matrix E (of
+	// which ET is the transpose), if it is at most bound, and 0 if there
+	// is none.  The edge need not be in E; it is treated as present.
+	int shortest( const Short_Cycle_Sparse_Matrix& E, const Short_Cycle_Sparse_Matrix& ET,
+				  int u, int w, int bound );
+	
+	// Add sign to N[k], 2*sign to per_u[k*|U|+v] for each vertex v of U
+	// on the cycle (as it is closed in either direction) and sign to
+	// per_edge[k*nnz+p] for each of its edges at position p of E (nnz
+	// being that of E), for every cycle of length shortest+2k up to
+	// longest through the edge.  The edge itself is left out of per_edge
+	// if it is not in E.  Follows shortest() for the same graph and edge
+	// and a bound of at least longest.
+	void count( int shortest, int longest, int64_t* N, double* per_u, double* per_edge, int sign );
+	
+  private:
+	void extend( int vv, int depth ); // The depth first search.
+	
+	const Short_Cycle_Sparse_Matrix* E_;
+	const Short_Cycle_Sparse_Matrix* ET_;
+	int U_, W_;
+	int u_, w_;
+	std::vector<int> dist_;		// Distance to u_, -1 if beyond the bound.
+	std::vector<int> queue_;	// The vertices reached by shortest().
+	std::vector<char> on_path_;
+	std::vector<int> path_;		// The vertices of U on the current path.
+	std::vector<int> edges_;	// The positions in E of its edges.
+	
+	// The state of count().
+	int shortest_, longest_;
+	int64_t* N_;
+	double* per_u_;
+	double* per_edge_;
+	int sign_;
+};
+
+#endif
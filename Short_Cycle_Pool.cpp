@@ -0,0 +1,336 @@
+/* Short_Cycle_Pool.cpp
+
+   Copyright (c) 2005 Thomas R. Halford 
+   All rights reserved.
+ 
+   Developed by: Thomas R. Halford
+                 Communication Sciences Institute
+                 University of Southern California
+                 http://csi.usc.edu
+ 
+   Permission is hereby granted, free of charge, to any person obtaining a copy 
+   of this software and associated documentation files (the "Software"), to deal 
+   with the Software without restriction, including without limitation the rights 
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+   copies of the Software, and to permit persons to whom the Software is furnished 
+   to do so, subject to the following conditions:
+  
+    * Redistributions of source code must retain the above copyright notice, this 
+      list of conditions and the following disclaimers.
+    * Redistributions in binary form must reproduce the above copyright notice, 
+      this list of conditions and the following disclaimers in the documentation 
+      and/or other materials provided with the distribution.
+    * Neither the names of Thomas R. Halford, the Communication Sciences Institute, 
+      the University of Southern California nor the names of its contributors may 
+      be used to endorse or promote products derived from this Software without 
+      specific prior written permission. 
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+   INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+   PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE CONTRIBUTORS OR 
+   COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN 
+   AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION 
+   WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE SOFTWARE.
+*/
+
+#include <stdlib.h>
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#include <sys/mman.h>
+#define SCM_MMAP 1
+#endif
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+#include "Short_Cycle_Pool.h"
+
+using namespace std;
+
+// Aligned allocation.  Huge page advice is only a hint to the kernel.
+void* mx_buffer_new( size_t bytes )
+{
+#if defined(_WIN32)
+	void* buf = _aligned_malloc(bytes,SCM_ALIGN);
+	if( buf == NULL ) throw bad_alloc();
+	return buf;
+#else
+	size_t align = SCM_ALIGN;
+#if SCM_HUGE_PAGE_BYTES > 0 && defined(__linux__) && defined(MADV_HUGEPAGE)
+	const size_t huge = 2*1024*1024;
+	if( bytes >= (size_t)SCM_HUGE_PAGE_BYTES ) align = huge;
+#endif
+	
+	void* buf = NULL;
+	if( posix_memalign(&buf,align,bytes) != 0 ) throw bad_alloc();
+#if SCM_HUGE_PAGE_BYTES > 0 && defined(__linux__) && defined(MADV_HUGEPAGE)
+	if( align == huge ) madvise(buf,bytes-bytes%huge,MADV_HUGEPAGE);
+#endif
+	return buf;
+#endif
+}
+
+// The mapped buffers and their sizes.
+static map<const void*,size_t> mx_mapped_;
+static Short_Cycle_Lock mx_mapped_lock_;
+
+// The scratch file is unlinked at once, so it disappears with the mapping
+// even if the program is killed.
+void* mx_mapped_buffer_new( size_t bytes, const char* dir )
+{
+#ifdef SCM_MMAP
+	if( dir == NULL || *dir == 0 ) dir = getenv("TMPDIR");
+	if( dir == NULL || *dir == 0 ) dir = "/tmp";
+	string path = string(dir)+"/scm_XXXXXX";
+	vector<char> name(path.begin(),path.end());
+	name.push_back(0);
+	
+	int fd = mkstemp(&name[0]);
+	if( fd < 0 ) throw bad_alloc();
+	unlink(&name[0]);
+	
+	void* buf = MAP_FAILED;
+	if( ftruncate(fd,(off_t)bytes) == 0 ) buf = mmap(NULL,bytes,PROT_READ|PROT_WRITE,MAP_SHARED,fd,0);
+	close(fd);
+	if( buf == MAP_FAILED ) throw bad_alloc();
+	
+	mx_mapped_lock_.acquire();
+	try
+	{
+		mx_mapped_[buf] = bytes;
+	}
+	
+	catch( ... )
+	{
+		mx_mapped_lock_.release();
+		munmap(buf,bytes);
+		throw;
+	}
+	
+	mx_mapped_lock_.release();
+	return buf;
+#else
+	(void)dir;
+	return mx_buffer_new(bytes);
+#endif
+}
+
+void mx_buffer_delete( void* buf )
+{
+#ifdef SCM_MMAP
+	size_t bytes = 0;
+	mx_mapped_lock_.acquire();
+	map<const void*,size_t>::iterator it = mx_mapped_.find(buf);
+	if( it != mx_mapped_.end() )
+	{
+		bytes = it->second;
+		mx_mapped_.erase(it);
+	}
+	
+	mx_mapped_lock_.release();
+	if( bytes > 0 )
+	{
+		munmap(buf,bytes);
+		return;
+	}
+#endif
+#if defined(_WIN32)
+	_aligned_free(buf);
+#else
+	free(buf);
+#endif
+}
+
+int mx_buffer_mapped( const void* buf )
+{
+	mx_mapped_lock_.acquire();
+	int mapped = mx_mapped_.count(buf) > 0;
+	mx_mapped_lock_.release();
+	return mapped;
+}
+
+// MADV_WILLNEED starts the reads and returns.  The range is widened to
+// whole pages and clipped to the buffer containing addr.
+void mx_prefetch( const void* addr, size_t bytes )
+{
+#ifdef SCM_MMAP
+	const char* from = (const char*)addr;
+	const char* to   = from+bytes;
+	mx_mapped_lock_.acquire();
+	map<const void*,size_t>::iterator it = mx_mapped_.upper_bound(addr);
+	int found = 0;
+	if( it != mx_mapped_.begin() )
+	{
+		--it;
+		const char* base = (const char*)it->first;
+		if( from < base+it->second )
+		{
+			found = 1;
+			if( to > base+it->second ) to = base+it->second;
+		}
+	}
+	
+	mx_mapped_lock_.release();
+	if( !found || to <= from ) return;
+	
+	size_t page = (size_t)sysconf(_SC_PAGESIZE);
+	from -= (size_t)from%page;
+	madvise((void*)from,to-from,MADV_WILLNEED);
+#else
+	(void)addr;
+	(void)bytes;
+#endif
+}
+
+// The current pool of each thread.  It is kept out of the header so that
+// only this file needs thread_local support.
+#if SCM_THREADS
+static thread_local Short_Cycle_Pool* mx_current_ = NULL;
+#else
+static Short_Cycle_Pool* mx_current_ = NULL;
+#endif
+
+Short_Cycle_Pool::Short_Cycle_Pool( void ) 
+  : pooled_(0), budget_(0), ram_(0)
+{
+	return;
+}
+
+Short_Cycle_Pool::~Short_Cycle_Pool( void )
+{
+	if( mx_current_ == this ) mx_current_ = NULL;
+	trim();
+}
+
+// New buffers are allocated outside the lock.  Over budget, the pooled
+// RAM buffers of other sizes are freed first.
+void* Short_Cycle_Pool::get( size_t bytes )
+{
+	void* buf = NULL;
+	int mapped = 0;
+	string dir;
+	lock_.acquire();
+	map< size_t, vector<void*> >::iterator it = free_.find(bytes);
+	if( it != free_.end() && !it->second.empty() )
+	{
+		buf = it->second.back();
+		it->second.pop_back();
+		pooled_ -= bytes;
+	}
+	
+	else if( budget_ > 0 && ram_+bytes > budget_ )
+	{
+		release(ram_+bytes-budget_);
+		mapped = ram_+bytes > budget_ && bytes >= (size_t)SCM_MAP_MIN_BYTES;
+		if( mapped ) dir = dir_;
+	}
+	
+	if( buf == NULL && !mapped ) ram_ += bytes;
+	lock_.release();
+	if( buf ) return buf;
+	
+	try
+	{
+		return mapped ? mx_mapped_buffer_new(bytes,dir.c_str()) : mx_buffer_new(bytes);
+	}
+	
+	catch( ... )
+	{
+		if( !mapped )
+		{
+			lock_.acquire();
+			ram_ -= bytes;
+			lock_.release();
+		}
+		
+		throw;
+	}
+}
+
+void Short_Cycle_Pool::put( void* buf, size_t bytes )
+{
+	lock_.acquire();
+	try
+	{
+		free_[bytes].push_back(buf);
+		pooled_ += bytes;
+	}
+	
+	catch( ... )
+	{
+		// The buffer cannot be pooled.  It is freed and, if held in RAM,
+		// no longer counts against the budget.
+		if( !mx_buffer_mapped(buf) ) ram_ -= (ram_ < bytes ? ram_ : bytes);
+		mx_buffer_delete(buf);
+	}
+	
+	lock_.release();
+}
+
+void Short_Cycle_Pool::trim( void )
+{
+	lock_.acquire();
+	for( map< size_t, vector<void*> >::iterator it = free_.begin(); it != free_.end(); ++it )
+	{
+		for( size_t ii = 0; ii < it->second.size(); ii++ ) 
+		{
+			if( !mx_buffer_mapped(it->second[ii]) ) ram_ -= (ram_ < it->first ? ram_ : it->first);
+			mx_buffer_delete(it->second[ii]);
+		}
+	}
+	
+	free_.clear();
+	pooled_ = 0;
+	lock_.release();
+}
+
+// Free pooled RAM buffers until bytes have been freed or none are left.
+void Short_Cycle_Pool::release( size_t bytes )
+{
+	size_t freed = 0;
+	for( map< size_t, vector<void*> >::iterator it = free_.begin(); it != free_.end() && freed < bytes; ++it )
+	{
+		vector<void*>& bucket = it->second;
+		for( size_t ii = 0; ii < bucket.size() && freed < bytes; )
+		{
+			if( mx_buffer_mapped(bucket[ii]) ) 
+			{
+				ii++;
+				continue;
+			}
+			
+			mx_buffer_delete(bucket[ii]);
+			bucket.erase(bucket.begin()+ii);
+			pooled_ -= it->first;
+			ram_    -= (ram_ < it->first ? ram_ : it->first);
+			freed   += it->first;
+		}
+	}
+}
+
+void Short_Cycle_Pool::set_budget( size_t bytes, const char* dir )
+{
+	lock_.acquire();
+	budget_ = bytes;
+	dir_    = (dir ? dir : "");
+	lock_.release();
+}
+
+size_t Short_Cycle_Pool::pooled( void ) const
+{
+	lock_.acquire();
+	size_t bytes = pooled_;
+	lock_.release();
+	return bytes;
+}
+
+Short_Cycle_Pool* Short_Cycle_Pool::current( void )
+{
+	return mx_current_;
+}
+
+Short_Cycle_Pool* Short_Cycle_Pool::use( Short_Cycle_Pool* pool )
+{
+	Short_Cycle_Pool* prev = mx_current_;
+	mx_current_ = pool;
+	return prev;
+}
@@ -0,0 +1,192 @@
+/* Short_Cycle_Pool.h
+
+   Copyright (c) 2005 Thomas R. Halford 
+   All rights reserved.
+ 
+   Developed by: Thomas R. Halford
+                 Communication Sciences Institute
+                 University of Southern California
+                 http://csi.usc.edu
+ 
+   Permission is hereby granted, free of charge, to any person obtaining a copy 
+   of this software and associated documentation files (the "Software"), to deal 
+   with the Software without restriction, including without limitation the rights 
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+   copies of the Software, and to permit persons to whom the Software is furnished 
+   to do so, subject to the following conditions:
+  
+    * Redistributions of source code must retain the above copyright notice, this 
+      list of conditions and the following disclaimers.
+    * Redistributions in binary form must reproduce the above copyright notice, 
+      this list of conditions and the following disclaimers in the documentation 
+      and/or other materials provided with the distribution.
+    * Neither the names of Thomas R. Halford, the Communication Sciences Institute, 
+      the University of Southern California nor the names of its contributors may 
+      be used to endorse or promote products derived from this Software without 
+      specific prior written permission. 
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+   INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+   PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE CONTRIBUTORS OR 
+   COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN 
+   AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION 
+   WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE SOFTWARE.
+*/
+
+// Short_Cycle_Pool.h defines a pool of matrix buffers.  Freed buffers are
+// kept in buckets keyed by their exact size and handed out again by the
+// next allocation of that size, so the many same-sized matrices of a
+// count, and of consecutive counts of same-sized graphs, are allocated
+// from the system only once.
+//
+// The matrix classes allocate through mx_alloc(), which uses the current
+// pool of the calling thread, if any, and records it, and free through
+// mx_free(), which returns the buffer to the pool it came from whichever
+// thread frees it.  Short_Cycle_Counter makes its pool current for the
+// duration of count() and Short_Cycle_Thread_Pool makes the caller's
+// current pool current on its worker threads while they run a graph, so
+// counters running on different threads each keep to their own pool.
+//
+// Buffers are SCM_ALIGN byte aligned.  If SCM_HUGE_PAGE_BYTES is
+// defined as more than 0 (it is 0 by default), buffers of at least that
+// many bytes are aligned to 2MB and, on Linux, advised to use transparent
+// huge pages, which cuts the TLB misses of the column-wise accesses to
+// large matrices.  Where the kernel compacts memory to satisfy the advice
+// this can cost far more system time than it saves, so it is opt in.
+//
+// A pool may be given a RAM budget.  Once the RAM buffers it holds,
+// in use or pooled, would exceed the budget, pooled buffers of other
+// sizes are released and, failing that, buffers of at least
+// SCM_MAP_MIN_BYTES are memory-mapped from unlinked scratch files
+// instead, so that the operating system pages them to disk.  The products
+// of Short_Cycle_Matrix stream such matrices in blocks of rows of about
+// SCM_TILE_BYTES and prefetch the next block with mx_prefetch().
+//
+// The current pool is kept per thread (thread_local) so that counters
+// counting on different threads at once do not switch each other's
+// pool; the workers of Short_Cycle_Tasks.h are handed the pool of the
+// count instead of inheriting it.  They share that pool, and counters
+// may share one too, so the pool is locked.  Threads are used when
+// compiled as C++11 or later unless SCM_THREADS is defined as 0.
+
+#ifndef SHORT_CYCLE_POOL
+#define SHORT_CYCLE_POOL
+
+#include <stddef.h>
+#include <map>
+#include <vector>
+#include <string>
+#include <new>
+
+#ifndef SCM_THREADS
+#if __cplusplus >= 201103L
+#define SCM_THREADS 1
+#else
+#define SCM_THREADS 0
+#endif
+#endif
+
+#if SCM_THREADS
+#include <mutex>
+#endif
+
+#ifndef SCM_ALIGN
+#define SCM_ALIGN 64
+#endif
+
+#ifndef SCM_HUGE_PAGE_BYTES
+#define SCM_HUGE_PAGE_BYTES 0
+#endif
+
+#ifndef SCM_MAP_MIN_BYTES
+#define SCM_MAP_MIN_BYTES (16*1024*1024)
+#endif
+
+#ifndef SCM_TILE_BYTES
+#define SCM_TILE_BYTES (64*1024*1024)
+#endif
+
+// A mutex, which does nothing without threads.
+class Short_Cycle_Lock
+{
+  public:
+#if SCM_THREADS
+	void acquire( void ) { mutex_.lock(); };
+	void release( void ) { mutex_.unlock(); };
+  private:
+	std::mutex mutex_;
+#else
+	void acquire( void ) {};
+	void release( void ) {};
+#endif
+};
+
+// Aligned buffers.  mx_buffer_new() throws std::bad_alloc on failure.
+// mx_mapped_buffer_new() maps a scratch file in directory dir (TMPDIR or
+// /tmp if NULL) and falls back to mx_buffer_new() where mapping is not
+// supported.  mx_buffer_delete() frees either kind.
+void* mx_buffer_new( size_t bytes );
+void* mx_mapped_buffer_new( size_t bytes, const char* dir );
+void mx_buffer_delete( void* buf );
+int mx_buffer_mapped( const void* buf ); // Non-zero if buf is mapped.
+
+// Ask the system to read [addr,addr+bytes) of a mapped buffer ahead of
+// its use.  It returns at once and does nothing for RAM buffers.
+void mx_prefetch( const void* addr, size_t bytes );
+
+class Short_Cycle_Pool
+{
+  public:
+	Short_Cycle_Pool( void );
+	~Short_Cycle_Pool( void );
+	
+	void* get( size_t bytes );			  // A buffer of bytes bytes.
+	void put( void* buf, size_t bytes );  // Return a buffer to the pool.
+	void trim( void );					  // Free every pooled buffer.
+	size_t pooled( void ) const;		  // Bytes held by the pool.
+	
+	// Limit the RAM buffers held by the pool to bytes, 0 for no limit.
+	// Scratch files are created in dir.
+	void set_budget( size_t bytes, const char* dir = NULL );
+	size_t budget( void ) const { return budget_; };
+	
+	// The pool used by mx_alloc() on the calling thread.  use() returns
+	// the previous pool so that it can be restored.
+	static Short_Cycle_Pool* current( void );
+	static Short_Cycle_Pool* use( Short_Cycle_Pool* pool );
+	
+  private:
+	Short_Cycle_Pool( const Short_Cycle_Pool& );
+	Short_Cycle_Pool& operator=( const Short_Cycle_Pool& );
+	
+	void release( size_t bytes ); // Free pooled RAM buffers, lock held.
+	
+	std::map< size_t, std::vector<void*> > free_; // Buffers by size.
+	size_t pooled_;
+	size_t budget_;
+	size_t ram_;		// RAM buffers allocated and not yet trimmed.
+	std::string dir_;
+	mutable Short_Cycle_Lock lock_;
+};
+
+// Allocate and free n elements of type T.  The data is not initialized.
+// mx_alloc() sets pool to the pool the buffer came from (NULL if none),
+// which must be passed back to mx_free().
+template <class T>
+inline T* mx_alloc( size_t n, Short_Cycle_Pool*& pool )
+{
+	size_t bytes = (n > 0 ? n : 1)*sizeof(T);
+	pool = Short_Cycle_Pool::current();
+	return (T*)(pool ? pool->get(bytes) : mx_buffer_new(bytes));
+}
+
+template <class T>
+inline void mx_free( T* buf, size_t n, Short_Cycle_Pool* pool )
+{
+	if( buf == NULL ) return;
+	size_t bytes = (n > 0 ? n : 1)*sizeof(T);
+	if( pool ) pool->put(buf,bytes);
+	else       mx_buffer_delete(buf);
+}
+
+#endif
@@ -0,0 +1,915 @@
+/* Short_Cycle_Sparse_Matrix.cpp
+
+   Copyright (c) 2005 Thomas R. Halford 
+   All rights reserved.
+ 
+   Developed by: Thomas R. Halford
+                 Communication Sciences Institute
+                 University of Southern California
+                 http://csi.usc.edu
+ 
+   Permission is hereby granted, free of charge, to any person obtaining a copy 
+   of this software and associated documentation files (the "Software"), to deal 
+   with the Software without restriction, including without limitation the rights 
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+   copies of the Software, and to permit persons to whom the Software is furnished 
+   to do so, subject to the following conditions:
+  
+    * Redistributions of source code must retain the above copyright notice, this 
+      list of conditions and the following disclaimers.
+    * Redistributions in binary form must reproduce the above copyright notice, 
+      this list of conditions and the following disclaimers in the documentation 
+      and/or other materials provided with the distribution.
+    * Neither the names of Thomas R. Halford, the Communication Sciences Institute, 
+      the University of Southern California nor the names of its contributors may 
+      be used to endorse or promote products derived from this Software without 
+      specific prior written permission. 
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+   INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+   PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE CONTRIBUTORS OR 
+   COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN 
+   AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION 
+   WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE SOFTWARE.
+*/
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <ctype.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#define SCM_MMAP 1
+#endif
+#include "Short_Cycle_Matrix.h"
+#include "Short_Cycle_Sparse_Matrix.h"
+#include "Short_Cycle_Stream.h"
+
+using namespace std;
+// Constructors.
+Short_Cycle_Sparse_Matrix::Short_Cycle_Sparse_Matrix( void )
+  : row_ptr_(NULL), col_idx_(NULL), i_nc_(0), i_nr_(0), e_nc_(0), e_nr_(0), nnz_(0), lift_(0), set_(0), 
+    map_(NULL), map_bytes_(0)
+{
+	return;
+}
+
+Short_Cycle_Sparse_Matrix::Short_Cycle_Sparse_Matrix( const Short_Cycle_Sparse_Matrix& copy_mx )
+  : row_ptr_(NULL), col_idx_(NULL), set_(0), map_(NULL), map_bytes_(0)
+{
+	*this = copy_mx;
+}
+
+Short_Cycle_Sparse_Matrix::~Short_Cycle_Sparse_Matrix( void )
+{
+	delete_data();
+}
+
+Short_Cycle_Sparse_Matrix& Short_Cycle_Sparse_Matrix::operator=( const Short_Cycle_Sparse_Matrix& copy_mx )
+{
+	if( this == &copy_mx ) return *this;
+	
+	// Copy the matrix dimensions.
+	e_nc_ = copy_mx.e_nc_;
+	e_nr_ = copy_mx.e_nr_;
+	i_nc_ = copy_mx.i_nc_;
+	i_nr_ = copy_mx.i_nr_;
+	nnz_  = copy_mx.nnz_;
+	lift_ = copy_mx.lift_;
+	
+	// Copy the sparse structure.
+	allocate();
+	memcpy(row_ptr_,copy_mx.row_ptr_,(e_nr_+1)*sizeof(int));
+	memcpy(col_idx_,copy_mx.col_idx_,nnz_*sizeof(int));
+	
+	return *this;
+}
+
+// Allocate the structure arrays for the current dimensions and nnz_.
+void Short_Cycle_Sparse_Matrix::allocate( void )
+{
+	delete_data();
+	row_ptr_ = new int[e_nr_+1];
+	col_idx_ = new int[nnz_ > 0 ? nnz_ : 1];
+	set_ = 1;
+}
+
+// Release a mapped (or, without mmap, read) binary file.
+static void binary_release( void* buf, size_t bytes )
+{
+#ifdef SCM_MMAP
+	munmap(buf,bytes);
+#else
+	(void)bytes;
+	delete [] (char*)buf;
+#endif
+}
+
+// Free the matrix data.
+void Short_Cycle_Sparse_Matrix::delete_data( void )
+{
+	if( set_ == 1 ) 
+	{
+		delete [] row_ptr_;
+		delete [] col_idx_;
+	}
+	
+	if( set_ == 2 ) binary_release(map_,map_bytes_);
+	
+	row_ptr_ = col_idx_ = NULL;
+	map_ = NULL;
+	map_bytes_ = 0;
+	set_ = 0;
+}
+
+// The arrays of a mapped matrix are read only.
+void Short_Cycle_Sparse_Matrix::own( void )
+{
+	if( set_ != 2 ) return;
+	
+	int* row_ptr = new int[e_nr_+1];
+	int* col_idx = new int[nnz_ > 0 ? nnz_ : 1];
+	memcpy(row_ptr,row_ptr_,(e_nr_+1)*sizeof(int));
+	memcpy(col_idx,col_idx_,nnz_*sizeof(int));
+	delete_data();
+	row_ptr_ = row_ptr;
+	col_idx_ = col_idx;
+	set_ = 1;
+}
+
+// The whole of a text file, mapped if it is an uncompressed regular file
+// and otherwise (compressed, a pipe, or standard input named "-") read
+// into memory through Short_Cycle_Stream.
+struct Text_File
+{
+	const char*  begin;
+	const char*  end;
+	void*		 map;
+	size_t		 map_bytes;
+	vector<char> data;
+};
+
+static int text_open( const char* filename, Text_File& file )
+{
+	file.begin = file.end = NULL;
+	file.map = NULL;
+	file.map_bytes = 0;
+#ifdef SCM_MMAP
+	int fd = (strcmp(filename,"-") == 0 ? -1 : open(filename,O_RDONLY));
+	struct stat st;
+	if( fd >= 0 && fstat(fd,&st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 )
+	{
+		void* buf = mmap(NULL,(size_t)st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+		if( buf != MAP_FAILED && 
+			Short_Cycle_Stream::format_of((const char*)buf,(size_t)st.st_size) != Short_Cycle_Stream::PLAIN )
+		{
+			munmap(buf,(size_t)st.st_size);
+			buf = MAP_FAILED;
+		}
+		
+		if( buf != MAP_FAILED )
+		{
+			madvise(buf,(size_t)st.st_size,MADV_SEQUENTIAL);
+			close(fd);
+			file.map = buf;
+			file.map_bytes = (size_t)st.st_size;
+			file.begin = (const char*)buf;
+			file.end = file.begin+file.map_bytes;
+			return 1;
+		}
+	}
+	
+	if( fd >= 0 ) close(fd);
+#endif
+	Short_Cycle_Stream in;
+	if( !in.open(filename) ) return 0;
+	size_t n = 0, got = 0;
+	do
+	{
+		if( file.data.size() < n+65536 ) file.data.resize(2*n+65536);
+		got = in.read(&file.data[n],file.data.size()-n);
+		n += got;
+	}
+	while( got > 0 );
+	
+	if( in.error() ) return 0;
+	file.data.resize(n);
+	file.begin = (n > 0 ? &file.data[0] : NULL);
+	file.end = file.begin+n;
+	return 1;
+}
+
+static void text_close( Text_File& file )
+{
+#ifdef SCM_MMAP
+	if( file.map ) munmap(file.map,file.map_bytes);
+#endif
+	file.map = NULL;
+	vector<char>().swap(file.data);
+}
+
+// Scan an unsigned decimal integer after any white space.  Returns 0 at
+// the end of the text, at anything else or if the value exceeds INT_MAX.
+static inline int scan_int( const char*& p, const char* end, int& value )
+{
+	while( p < end && (*p == ' ' || *p == '\n' || *p == '\t' || *p == '\r' || *p == '\f' || *p == '\v') ) p++;
+	if( p == end || (unsigned)(*p-'0') > 9 ) return 0;
+	
+	int v = 0;
+	for( ; p < end && (unsigned)(*p-'0') <= 9; p++ )
+	{
+		int d = *p-'0';
+		if( v > (INT_MAX-d)/10 ) return 0;
+		v = 10*v+d;
+	}
+	
+	value = v;
+	return 1;
+}
+
+// Scan n degrees (each at most m) into the offsets ptr.
+static int scan_degrees( const char*& p, const char* end, int n, int m, vector<int>& ptr )
+{
+	ptr.assign(n+1,0);
+	for( int rr = 0, d = 0; rr < n; rr++ )
+	{
+		if( !scan_int(p,end,d) || d > m || ptr[rr] > INT_MAX-d ) return 0;
+		ptr[rr+1] = ptr[rr]+d;
+	}
+	
+	return 1;
+}
+
+// Scan the n lists of indices 1 ... m into idx, sorted and from 0.  The
+// zeros with which D. MacKay's irregular graphs pad each line are skipped.
+static int scan_lists( const char*& p, const char* end, int n, int m, const vector<int>& ptr, 
+					   vector<int>& idx )
+{
+	idx.resize(ptr[n]);
+	for( int rr = 0; rr < n; rr++ )
+	{
+		for( int pp = ptr[rr], v = 0; pp < ptr[rr+1]; pp++ )
+		{
+			do { if( !scan_int(p,end,v) ) return 0; } while( v == 0 );
+			if( v > m ) return 0;
+			
+			int qq = pp;
+			for( ; qq > ptr[rr] && idx[qq-1] > v-1; qq-- ) idx[qq] = idx[qq-1];
+			if( qq > ptr[rr] && idx[qq-1] == v-1 ) return 0;
+			idx[qq] = v-1;
+		}
+	}
+	
+	return 1;
+}
+
+// Check that the CSC structure (col_ptr, row_idx) is that of the CSR
+// structure (row_ptr, col_idx), both sorted and in range with the same
+// number of nonzeros.  The rows of each column then appear in the order
+// in which the rows are visited.
+static int is_transpose( int nr, int nc, const int* row_ptr, const int* col_idx, 
+						 const int* col_ptr, const int* row_idx )
+{
+	vector<int> next(col_ptr,col_ptr+nc);
+	for( int rr = 0; rr < nr; rr++ )
+	{
+		for( int pp = row_ptr[rr]; pp < row_ptr[rr+1]; pp++ )
+		{
+			int cc = col_idx[pp];
+			if( next[cc] == col_ptr[cc+1] || row_idx[next[cc]++] != rr ) return 0;
+		}
+	}
+	
+	return 1;
+}
+
+// Read an incidence matrix from an alist file: the dimensions, the
+// maximum degrees, the row and column degrees, and then the row and
+// column lists.  The column lists must be those of the transpose of the
+// row lists.
+int Short_Cycle_Sparse_Matrix::read_alist_file( const char* filename, Short_Cycle_Sparse_Matrix* columns )
+{
+	Text_File file;
+	if( !text_open(filename,file) ) return 0;
+	
+	const char* p = file.begin;
+	int nr = 0, nc = 0, max_r, max_c;
+	vector<int> row_ptr, col_idx, col_ptr, row_idx;
+	int valid = ( scan_int(p,file.end,nr) && scan_int(p,file.end,nc) &&
+				  scan_int(p,file.end,max_r) && scan_int(p,file.end,max_c) &&
+				  scan_degrees(p,file.end,nr,nc,row_ptr) && scan_degrees(p,file.end,nc,nr,col_ptr) &&
+				  row_ptr[nr] == col_ptr[nc] &&
+				  scan_lists(p,file.end,nr,nc,row_ptr,col_idx) && scan_lists(p,file.end,nc,nr,col_ptr,row_idx) );
+	text_close(file);
+	
+	if( valid && row_ptr[nr] > 0 ) valid = is_transpose(nr,nc,&row_ptr[0],&col_idx[0],&col_ptr[0],&row_idx[0]);
+	if( !valid ) return 0;
+	
+	e_nr_ = nr;
+	e_nc_ = nc;
+	i_nr_ = Short_Cycle_Matrix<double>::internal_dim(e_nr_);
+	i_nc_ = Short_Cycle_Matrix<double>::internal_dim(e_nc_);
+	nnz_  = row_ptr[nr];
+	lift_ = 0;
+	allocate();
+	memcpy(row_ptr_,&row_ptr[0],(e_nr_+1)*sizeof(int));
+	if( nnz_ ) memcpy(col_idx_,&col_idx[0],nnz_*sizeof(int));
+	
+	if( columns )
+	{
+		columns->e_nr_ = nc;
+		columns->e_nc_ = nr;
+		columns->i_nr_ = i_nc_;
+		columns->i_nc_ = i_nr_;
+		columns->nnz_  = nnz_;
+		columns->lift_ = 0;
+		columns->allocate();
+		memcpy(columns->row_ptr_,&col_ptr[0],(nc+1)*sizeof(int));
+		if( nnz_ ) memcpy(columns->col_idx_,&row_idx[0],nnz_*sizeof(int));
+	}
+	
+	return 1;
+}
+
+// Read an incidence matrix from a file of its nr rows of nc elements.
+// Only the nonzero elements are stored and the file is streamed, so no
+// dense intermediate is required.
+int Short_Cycle_Sparse_Matrix::read_incidence_matrix_file( int nc, int nr, const char* filename )
+{
+	Short_Cycle_Stream in;
+	if( nc < 0 || nr < 0 || !in.open(filename) ) return 0;
+	
+	// Record the columns of the nonzero elements in each row.
+	vector<int> row_ptr(nr+1,0), col_idx;
+	size_t total = (size_t)nr*nc, seen = 0;
+	string line;
+	while( seen < total && in.read_line(line) )
+	{
+		const char* p = line.c_str();
+		const char* end = p+line.size();
+		int v;
+		while( seen < total && scan_int(p,end,v) )
+		{
+			if( v ) col_idx.push_back((int)(seen%nc));
+			if( ++seen%nc == 0 ) row_ptr[seen/nc] = (int)col_idx.size();
+		}
+		
+		if( seen < total && p != end ) return 0;
+	}
+	
+	if( seen < total || in.error() ) return 0;
+	
+	e_nc_ = nc;
+	e_nr_ = nr;	
+	lift_ = 0;
+	i_nc_ = Short_Cycle_Matrix<double>::internal_dim(e_nc_);
+	i_nr_ = Short_Cycle_Matrix<double>::internal_dim(e_nr_);
+	nnz_ = (int)col_idx.size();
+	allocate();
+	memcpy(row_ptr_,&row_ptr[0],(e_nr_+1)*sizeof(int));
+	if( nnz_ ) memcpy(col_idx_,&col_idx[0],nnz_*sizeof(int));
+	return 1;
+}
+
+// Read a MatrixMarket coordinate file: the banner, comment lines, the
+// line of dimensions and number of entries, then one entry per line.
+int Short_Cycle_Sparse_Matrix::read_matrix_market_file( const char* filename )
+{
+	Short_Cycle_Stream in;
+	string line, banner[5];
+	if( !in.open(filename) || !in.read_line(line) ) return 0;
+	
+	// The banner is not case sensitive.
+	for( size_t ii = 0; ii < line.size(); ii++ ) line[ii] = (char)tolower((unsigned char)line[ii]);
+	istringstream words(line);
+	for( int ii = 0; ii < 5; ii++ ) words >> banner[ii];
+	const string& field = banner[3];
+	const string& symmetry = banner[4];
+	if( banner[0] != "%%matrixmarket" || banner[1] != "matrix" || banner[2] != "coordinate" ) return 0;
+	if( field != "pattern" && field != "integer" && field != "real" && field != "complex" ) return 0;
+	if( symmetry != "general" && symmetry != "symmetric" && symmetry != "skew-symmetric" && 
+		symmetry != "hermitian" ) return 0;
+	int mirror = (symmetry != "general");
+	int values = (field == "pattern" ? 0 : field == "complex" ? 2 : 1);
+	
+	// Comment lines may come before the dimensions.
+	int nr = 0, nc = 0, entries = 0;
+	const char *p, *end;
+	do
+	{
+		if( !in.read_line(line) ) return 0;
+		p = line.c_str();
+		end = p+line.size();
+		while( p < end && isspace((unsigned char)*p) ) p++;
+	}
+	while( p == end || *p == '%' );
+	
+	if( !scan_int(p,end,nr) || !scan_int(p,end,nc) || !scan_int(p,end,entries) ) return 0;
+	if( mirror && nr != nc ) return 0;
+	
+	// Explicit zeros are dropped.
+	vector<int> rows, cols;
+	rows.reserve(entries < (1 << 24) ? entries : (1 << 24));
+	cols.reserve(rows.capacity());
+	int read = 0;
+	while( read < entries && in.read_line(line) )
+	{
+		p = line.c_str();
+		end = p+line.size();
+		while( p < end && isspace((unsigned char)*p) ) p++;
+		if( p == end || *p == '%' ) continue;
+		
+		int rr, cc, nonzero = 1;
+		if( !scan_int(p,end,rr) || !scan_int(p,end,cc) || rr < 1 || rr > nr || cc < 1 || cc > nc ) return 0;
+		if( values )
+		{
+			nonzero = 0;
+			for( int vv = 0; vv < values; vv++ )
+			{
+				char* next;
+				double x = strtod(p,&next);
+				if( next == p ) return 0;
+				if( x != 0.0 ) nonzero = 1;
+				p = next;
+			}
+		}
+		
+		read++;
+		if( !nonzero ) continue;
+		rows.push_back(rr-1);
+		cols.push_back(cc-1);
+		if( mirror && rr != cc )
+		{
+			rows.push_back(cc-1);
+			cols.push_back(rr-1);
+		}
+	}
+	
+	if( read < entries || in.error() ) return 0;
+	build(nr,nc,rows,cols);
+	return 1;
+}
+
+// Read an edge list of one edge u w per line, numbered from 0.  Blank
+// lines, lines beginning # or % and anything after w are ignored.
+int Short_Cycle_Sparse_Matrix::read_edge_list_file( const char* filename, int nr, int nc )
+{
+	Short_Cycle_Stream in;
+	if( !in.open(filename) ) return 0;
+	
+	vector<int> rows, cols;
+	int max_r = -1, max_c = -1;
+	string line;
+	while( in.read_line(line) )
+	{
+		const char* p = line.c_str();
+		const char* end = p+line.size();
+		while( p < end && isspace((unsigned char)*p) ) p++;
+		if( p == end || *p == '#' || *p == '%' ) continue;
+		
+		int uu, ww;
+		if( !scan_int(p,end,uu) || !scan_int(p,end,ww) ) return 0;
+		if( (nr > 0 && uu >= nr) || (nc > 0 && ww >= nc) ) return 0;
+		if( uu > max_r ) max_r = uu;
+		if( ww > max_c ) max_c = ww;
+		rows.push_back(uu);
+		cols.push_back(ww);
+	}
+	
+	if( in.error() ) return 0;
+	build(nr > 0 ? nr : max_r+1,nc > 0 ? nc : max_c+1,rows,cols);
+	return 1;
+}
+
+// Build the structure from the nonzeros (rows[k],cols[k]), which may be
+// repeated and in any order.  rows and cols are freed as they are used.
+void Short_Cycle_Sparse_Matrix::build( int nr, int nc, vector<int>& rows, vector<int>& cols )
+{
+	// Bucket the columns by row.
+	vector<int> row_ptr(nr+1,0);
+	size_t kk, n = rows.size();
+	for( kk = 0; kk < n; kk++ ) row_ptr[rows[kk]+1]++;
+	for( int rr = 0; rr < nr; rr++ ) row_ptr[rr+1] += row_ptr[rr];
+	
+	vector<int> col_idx(n), next(row_ptr.begin(),row_ptr.end()-1);
+	for( kk = 0; kk < n; kk++ ) col_idx[next[rows[kk]]++] = cols[kk];
+	vector<int>().swap(rows);
+	vector<int>().swap(cols);
+	vector<int>().swap(next);
+	
+	// Sort each row and drop the repeats.
+	int pp = 0;
+	for( int rr = 0; rr < nr; rr++ )
+	{
+		int from = row_ptr[rr], to = row_ptr[rr+1];
+		sort(col_idx.begin()+from,col_idx.begin()+to);
+		row_ptr[rr] = pp;
+		for( int qq = from; qq < to; qq++ ) if( qq == from || col_idx[qq] != col_idx[qq-1] ) col_idx[pp++] = col_idx[qq];
+	}
+	
+	row_ptr[nr] = pp;
+	
+	e_nr_ = nr;
+	e_nc_ = nc;
+	i_nr_ = Short_Cycle_Matrix<double>::internal_dim(e_nr_);
+	i_nc_ = Short_Cycle_Matrix<double>::internal_dim(e_nc_);
+	nnz_  = pp;
+	lift_ = 0;
+	allocate();
+	memcpy(row_ptr_,&row_ptr[0],(e_nr_+1)*sizeof(int));
+	if( nnz_ ) memcpy(col_idx_,&col_idx[0],nnz_*sizeof(int));
+}
+
+// Read a QC matrix from a file of its block dimensions, lifting size
+// and shifts.
+int Short_Cycle_Sparse_Matrix::read_qc_file( const char* filename )
+{
+	int nbr, nbc, z;
+	vector<int> shift;
+	if( !read_qc_base(filename,nbr,nbc,z,shift) ) return 0;
+	
+	// The number of nonzeros must fit an int as well as the dimensions.
+	size_t blocks = 0;
+	for( size_t pp = 0; pp < (size_t)nbr*nbc; pp++ ) if( shift[pp] >= 0 ) blocks++;
+	if( (double)blocks*z > INT_MAX ) return 0;
+	
+	expand_qc(nbr,nbc,z,&shift[0]);
+	return 1;
+}
+
+// Read the block dimensions, lifting size and shifts of a QC matrix.
+// shift has an element past the last shift so that it is never empty.
+int Short_Cycle_Sparse_Matrix::read_qc_base( const char* filename, int& nbr, int& nbc, int& z,
+											 vector<int>& shift )
+{
+	ifstream fin(filename);
+	nbr = nbc = z = 0;
+	if( !(fin >> nbr >> nbc >> z) || nbr <= 0 || nbc <= 0 || z <= 0 ) return 0;
+	if( (double)nbr*z > INT_MAX || (double)nbc*z > INT_MAX || (double)nbr*nbc > INT_MAX ) return 0;
+	
+	shift.assign((size_t)nbr*nbc+1,-1);
+	for( size_t pp = 0; pp < (size_t)nbr*nbc; pp++ ) 
+	{
+		if( !(fin >> shift[pp]) || shift[pp] < -1 || shift[pp] >= z ) return 0;
+	}
+	
+	return 1;
+}
+
+// Expand the base matrix of shifts (nbr x nbc, row by row) with lifting
+// size z.  Row i*nbr+b has a nonzero in column ((i+e) mod z)*nbc+c for
+// each shift e >= 0 in column c of row b of the base matrix.
+void Short_Cycle_Sparse_Matrix::expand_qc( int nbr, int nbc, int z, const int* shift )
+{
+	e_nr_ = nbr*z;
+	e_nc_ = nbc*z;
+	i_nc_ = Short_Cycle_Matrix<double>::internal_dim(e_nc_);
+	i_nr_ = Short_Cycle_Matrix<double>::internal_dim(e_nr_);
+	lift_ = (z > 0 ? z : 0);
+	
+	int bb, cc, ii;
+	vector<int> row_nnz(nbr,0);
+	for( bb = 0, nnz_ = 0; bb < nbr; bb++ )
+	{
+		for( cc = 0; cc < nbc; cc++ ) if( shift[(size_t)bb*nbc+cc] >= 0 ) row_nnz[bb]++;
+		nnz_ += z*row_nnz[bb];
+	}
+	
+	allocate();
+	row_ptr_[0] = 0;
+	for( ii = 0; ii < z; ii++ )
+	{
+		for( bb = 0; bb < nbr; bb++ )
+		{
+			int rr = ii*nbr+bb, pp = row_ptr_[rr];
+			for( cc = 0; cc < nbc; cc++ )
+			{
+				int ee = shift[(size_t)bb*nbc+cc];
+				if( ee >= 0 ) col_idx_[pp++] = (ii+ee)%z*nbc+cc;
+			}
+			
+			// Sort the few columns of the row.
+			for( int qq = row_ptr_[rr]+1; qq < pp; qq++ )
+			{
+				int col = col_idx_[qq], tt = qq;
+				for( ; tt > row_ptr_[rr] && col_idx_[tt-1] > col; tt-- ) col_idx_[tt] = col_idx_[tt-1];
+				col_idx_[tt] = col;
+			}
+			
+			row_ptr_[rr+1] = pp;
+		}
+	}
+}
+
+// The integers of the header of a binary file.
+static const int BINARY_HEADER  = 6;
+static const int BINARY_VERSION = 1;
+
+// Check one side of a binary file: n degrees and offsets, the indices
+// (below m) increasing within each row.
+static int binary_side_valid( const int* deg, const int* ptr, const int* idx, int n, int m )
+{
+	if( ptr[0] != 0 ) return 0;
+	for( int rr = 0; rr < n; rr++ )
+	{
+		if( ptr[rr+1]-ptr[rr] != deg[rr] || deg[rr] < 0 ) return 0;
+		for( int pp = ptr[rr]; pp < ptr[rr+1]; pp++ )
+		{
+			if( idx[pp] < 0 || idx[pp] >= m || (pp > ptr[rr] && idx[pp] <= idx[pp-1]) ) return 0;
+		}
+	}
+	
+	return 1;
+}
+
+// Check that a matrix of lifting size z is a QC matrix (see
+// expand_qc()): z divides both dimensions and the columns of each row
+// past the first nr/z are those of the row nr/z before it moved nc/z on,
+// modulo nc.  Row b then follows from row nr-nr/z+b in the same way.
+static int binary_lift_valid( const int* ptr, const int* idx, int nr, int nc, int z )
+{
+	if( z == 0 ) return 1;
+	if( nr%z != 0 || nc%z != 0 ) return 0;
+	int nbr = nr/z, nbc = nc/z;
+	for( int rr = nbr; rr < nr; rr++ )
+	{
+		const int* from = idx+ptr[rr-nbr];
+		const int* to   = idx+ptr[rr];
+		int d = ptr[rr+1]-ptr[rr];
+		if( d != ptr[rr-nbr+1]-ptr[rr-nbr] ) return 0;
+		for( int pp = 0; pp < d; pp++ )
+		{
+			int cc = from[pp]+nbc;
+			if( cc >= nc ) cc -= nc;
+			if( !binary_search(to,to+d,cc) ) return 0;
+		}
+	}
+	
+	return 1;
+}
+
+// The file is mapped read only and private, so the page cache holds the
+// only copy of the arrays.  Both sides, the agreement of the CSC arrays
+// with the CSR ones and the lifting size are checked before the file is
+// accepted, which also brings it into memory.
+int Short_Cycle_Sparse_Matrix::map_binary_file( const char* filename, int transposed )
+{
+	void* buf = NULL;
+	size_t bytes = 0;
+	const size_t min_bytes = BINARY_HEADER*sizeof(int);
+#ifdef SCM_MMAP
+	int fd = open(filename,O_RDONLY);
+	if( fd < 0 ) return 0;
+	struct stat st;
+	if( fstat(fd,&st) == 0 && (size_t)st.st_size >= min_bytes )
+	{
+		bytes = (size_t)st.st_size;
+		buf = mmap(NULL,bytes,PROT_READ,MAP_PRIVATE,fd,0);
+		if( buf == MAP_FAILED ) buf = NULL;
+	}
+	
+	close(fd);
+#else
+	FILE* fin = fopen(filename,"rb");
+	if( fin == NULL ) return 0;
+	long len = (fseek(fin,0,SEEK_END) == 0 ? ftell(fin) : -1);
+	if( len >= (long)min_bytes && fseek(fin,0,SEEK_SET) == 0 )
+	{
+		bytes = (size_t)len;
+		buf = new char[bytes];
+		if( fread(buf,1,bytes,fin) != bytes ) { delete [] (char*)buf; buf = NULL; }
+	}
+	
+	fclose(fin);
+#endif
+	if( buf == NULL ) return 0;
+	
+	// Check the header and the size of the file before the arrays.
+	const int* hdr = (const int*)buf;
+	int nr = hdr[2], nc = hdr[3], nnz = hdr[4], lift = hdr[5];
+	int valid = ( memcmp(hdr,"SCTG",4) == 0 && hdr[1] == BINARY_VERSION &&
+				  nr >= 0 && nc >= 0 && nnz >= 0 && lift >= 0 &&
+				  bytes == (BINARY_HEADER+2*((size_t)nr+nc+1)+2*(size_t)nnz)*sizeof(int) );
+	
+	const int *deg_r = NULL, *deg_c = NULL, *ptr_r = NULL, *idx_r = NULL, *ptr_c = NULL, *idx_c = NULL;
+	if( valid )
+	{
+		deg_r = hdr+BINARY_HEADER;
+		deg_c = deg_r+nr;
+		ptr_r = deg_c+nc;
+		idx_r = ptr_r+nr+1;
+		ptr_c = idx_r+nnz;
+		idx_c = ptr_c+nc+1;
+		valid = ( ptr_r[nr] == nnz && ptr_c[nc] == nnz && 
+				  binary_side_valid(deg_r,ptr_r,idx_r,nr,nc) && binary_side_valid(deg_c,ptr_c,idx_c,nc,nr) &&
+				  is_transpose(nr,nc,ptr_r,idx_r,ptr_c,idx_c) && binary_lift_valid(ptr_r,idx_r,nr,nc,lift) );
+	}
+	
+	if( !valid )
+	{
+		binary_release(buf,bytes);
+		return 0;
+	}
+	
+	delete_data();
+	e_nr_ = (transposed ? nc : nr);
+	e_nc_ = (transposed ? nr : nc);
+	i_nr_ = Short_Cycle_Matrix<double>::internal_dim(e_nr_);
+	i_nc_ = Short_Cycle_Matrix<double>::internal_dim(e_nc_);
+	nnz_  = nnz;
+	lift_ = lift;
+	row_ptr_ = (int*)(transposed ? ptr_c : ptr_r);
+	col_idx_ = (int*)(transposed ? idx_c : idx_r);
+	map_ = buf;
+	map_bytes_ = bytes;
+	set_ = 2;
+	return 1;
+}
+
+static void write_ints( ofstream& fout, const int* data, size_t n )
+{
+	if( n > 0 ) fout.write((const char*)data,n*sizeof(int));
+}
+
+// Write the matrix as a binary file.  Returns 0 if the file could not
+// be written.
+int Short_Cycle_Sparse_Matrix::write_binary_file( const char* filename ) const
+{
+	Short_Cycle_Sparse_Matrix T;
+	T.transpose(*this);
+	
+	int hdr[BINARY_HEADER] = { 0, BINARY_VERSION, e_nr_, e_nc_, nnz_, lift_ };
+	memcpy(hdr,"SCTG",4);
+	vector<int> deg(e_nr_+e_nc_+1);
+	for( int rr = 0; rr < e_nr_; rr++ ) deg[rr] = row_ptr_[rr+1]-row_ptr_[rr];
+	for( int cc = 0; cc < e_nc_; cc++ ) deg[e_nr_+cc] = T.row_ptr_[cc+1]-T.row_ptr_[cc];
+	
+	ofstream fout(filename,ios::out|ios::binary|ios::trunc);
+	write_ints(fout,hdr,BINARY_HEADER);
+	write_ints(fout,&deg[0],e_nr_+e_nc_);
+	write_ints(fout,row_ptr_,e_nr_+1);
+	write_ints(fout,col_idx_,nnz_);
+	write_ints(fout,T.row_ptr_,e_nc_+1);
+	write_ints(fout,T.col_idx_,nnz_);
+	fout.close();
+	return !fout.fail();
+}
+
+// Build the sparse structure from the nonzero elements of source.
+void Short_Cycle_Sparse_Matrix::compress( const Short_Cycle_Matrix<double>& source )
+{
+	e_nc_ = source.e_nc();
+	e_nr_ = source.e_nr();
+	i_nc_ = source.i_nc();
+	i_nr_ = source.i_nr();
+	lift_ = 0;
+	
+	// Count the nonzero elements, then record their columns.
+	int rr, cc, pp;
+	for( rr = 0, nnz_ = 0; rr < e_nr_; rr++ )
+	{
+		for( cc = 0; cc < e_nc_; cc++ ) if( source(rr,cc) != 0.0 ) nnz_++;
+	}
+	
+	allocate();
+	for( rr = 0, pp = 0; rr < e_nr_; rr++ )
+	{
+		row_ptr_[rr] = pp;
+		for( cc = 0; cc < e_nc_; cc++ ) if( source(rr,cc) != 0.0 ) col_idx_[pp++] = cc;
+	}
+	
+	row_ptr_[e_nr_] = pp;
+}
+
+// Set *this to rows r0 ... r1-1 of source.  The rows past the external
+// dimension of source are empty.
+void Short_Cycle_Sparse_Matrix::copy_rows( const Short_Cycle_Sparse_Matrix& source, int r0, int r1 )
+{
+	int last = (r1 < source.e_nr_ ? r1 : source.e_nr_);
+	e_nc_ = source.e_nc_;
+	e_nr_ = (last > r0 ? last-r0 : 0);
+	i_nc_ = source.i_nc_;
+	i_nr_ = r1-r0;
+	nnz_  = (e_nr_ > 0 ? source.row_ptr_[last]-source.row_ptr_[r0] : 0);
+	lift_ = 0;
+	allocate();
+	
+	int base = (e_nr_ > 0 ? source.row_ptr_[r0] : 0);
+	row_ptr_[0] = 0;
+	for( int rr = 1; rr <= e_nr_; rr++ ) row_ptr_[rr] = source.row_ptr_[r0+rr]-base;
+	memcpy(col_idx_,source.col_idx_+base,nnz_*sizeof(int));
+}
+
+int Short_Cycle_Sparse_Matrix::find( int r, int c ) const
+{
+	for( int pp = row_ptr_[r]; pp < row_ptr_[r+1] && col_idx_[pp] <= c; pp++ ) 
+		if( col_idx_[pp] == c ) return pp;
+	return -1;
+}
+
+// The nonzeros after (r,c) move up one place, into a larger col_idx_.
+int Short_Cycle_Sparse_Matrix::insert( int r, int c )
+{
+	own();
+	int pp = row_ptr_[r];
+	while( pp < row_ptr_[r+1] && col_idx_[pp] < c ) pp++;
+	if( pp < row_ptr_[r+1] && col_idx_[pp] == c ) return 0;
+	
+	int* col_idx = new int[nnz_+1];
+	memcpy(col_idx,col_idx_,pp*sizeof(int));
+	col_idx[pp] = c;
+	memcpy(col_idx+pp+1,col_idx_+pp,(nnz_-pp)*sizeof(int));
+	delete [] col_idx_;
+	col_idx_ = col_idx;
+	nnz_++;
+	lift_ = 0;
+	for( int rr = r+1; rr <= e_nr_; rr++ ) row_ptr_[rr]++;
+	return 1;
+}
+
+// The nonzeros after (r,c) move down one place.
+int Short_Cycle_Sparse_Matrix::erase( int r, int c )
+{
+	own();
+	int pp = row_ptr_[r];
+	while( pp < row_ptr_[r+1] && col_idx_[pp] < c ) pp++;
+	if( pp == row_ptr_[r+1] || col_idx_[pp] != c ) return 0;
+	
+	memmove(col_idx_+pp,col_idx_+pp+1,(nnz_-pp-1)*sizeof(int));
+	nnz_--;
+	lift_ = 0;
+	for( int rr = r+1; rr <= e_nr_; rr++ ) row_ptr_[rr]--;
+	return 1;
+}
+
+void Short_Cycle_Sparse_Matrix::swap( Short_Cycle_Sparse_Matrix& other )
+{
+	std::swap(row_ptr_,other.row_ptr_);
+	std::swap(col_idx_,other.col_idx_);
+	std::swap(i_nc_,other.i_nc_);
+	std::swap(i_nr_,other.i_nr_);
+	std::swap(e_nc_,other.e_nc_);
+	std::swap(e_nr_,other.e_nr_);
+	std::swap(nnz_,other.nnz_);
+	std::swap(lift_,other.lift_);
+	std::swap(set_,other.set_);
+	std::swap(map_,other.map_);
+	std::swap(map_bytes_,other.map_bytes_);
+}
+
+// Set *this to source^T.  The nonzeros of each row of the result
+// are produced in increasing column order.
+void Short_Cycle_Sparse_Matrix::transpose( const Short_Cycle_Sparse_Matrix& source )
+{
+	e_nc_ = source.e_nr_;
+	e_nr_ = source.e_nc_;
+	i_nc_ = source.i_nr_;
+	i_nr_ = source.i_nc_;
+	nnz_  = source.nnz_;
+	lift_ = source.lift_;
+	allocate();
+	
+	// Count the nonzeros in each column of source.
+	int rr, pp;
+	memset(row_ptr_,0,(e_nr_+1)*sizeof(int));
+	for( pp = 0; pp < nnz_; pp++ ) row_ptr_[source.col_idx_[pp]+1]++;
+	for( rr = 0; rr < e_nr_; rr++ ) row_ptr_[rr+1] += row_ptr_[rr];
+	
+	// Scatter the row indices of source into place.
+	int* next = new int[e_nr_ > 0 ? e_nr_ : 1];
+	memcpy(next,row_ptr_,e_nr_*sizeof(int));
+	for( rr = 0; rr < source.e_nr_; rr++ )
+	{
+		for( pp = source.row_ptr_[rr]; pp < source.row_ptr_[rr+1]; pp++ ) 
+		{
+			col_idx_[next[source.col_idx_[pp]]++] = rr;
+		}
+	}
+	
+	delete [] next;
+}
+
+ostream& operator<<( ostream& os, const Short_Cycle_Sparse_Matrix& mx )
+{
+	for( int rr = 0; rr < mx.e_nr_; rr++ )
+	{
+		for( int cc = 0, pp = mx.row_ptr_[rr]; cc < mx.e_nc_; cc++ )
+		{
+			if( pp < mx.row_ptr_[rr+1] && mx.col_idx_[pp] == cc ) { os << "1 "; pp++; }
+			else os << "0 ";
+		}
+		
+		os << endl;
+	}
+
+	return os;
+}
@@ -0,0 +1,178 @@
+/* Short_Cycle_Sparse_Matrix.h
+
+   Copyright (c) 2005 Thomas R. Halford 
+   All rights reserved.
+ 
+   Developed by: Thomas R. Halford
+                 Communication Sciences Institute
+                 University of Southern California
+                 http://csi.usc.edu
+ 
+   Permission is hereby granted, free of charge, to any person obtaining a copy 
+   of this software and associated documentation files (the "Software"), to deal 
+   with the Software without restriction, including without limitation the rights 
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+   copies of the Software, and to permit persons to whom the Software is furnished 
+   to do so, subject to the following conditions:
+  
+    * Redistributions of source code must retain the above copyright notice, this 
+      list of conditions and the following disclaimers.
+    * Redistributions in binary form must reproduce the above copyright notice, 
+      this list of conditions and the following disclaimers in the documentation 
+      and/or other materials provided with the distribution.
+    * Neither the names of Thomas R. Halford, the Communication Sciences Institute, 
+      the University of Southern California nor the names of its contributors may 
+      be used to endorse or promote products derived from this Software without 
+      specific prior written permission. 
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+   INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+   PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE CONTRIBUTORS OR 
+   COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN 
+   AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION 
+   WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE SOFTWARE.
+*/
+
+// Short_Cycle_Sparse_Matrix.h defines the compressed sparse row (CSR)
+// matrix class used to store the incidence matrix E and its transpose.
+// Storing E^T in CSR form is equivalent to storing E in compressed sparse
+// column (CSC) form.  The internal dimensions follow those of 
+// Short_Cycle_Matrix so that sparse and dense operands can be mixed.
+//
+// A quasi-cyclic (QC) matrix is lifted from a base matrix by replacing
+// each element with a Z x Z circulant permutation matrix, or with the
+// zero matrix.  Vertex i of block b of a side with nb blocks is numbered
+// i*nb+b, so shifting every vertex along its block is an automorphism
+// that moves each vertex nb places on.  Every matrix the counter derives
+// from E is then block circulant in this numbering and is determined by
+// its first nb rows, its generating rows (see Short_Cycle_Matrix.h).
+//
+// The binary Tanner graph file holds, as native 32 bit integers:
+//
+//   header    "SCTG", version, nr, nc, nnz, lifting size (0 if not QC)
+//   degrees   nr row degrees, then nc column degrees
+//   CSR       nr+1 row offsets, then nnz column indices
+//   CSC       nc+1 column offsets, then nnz row indices
+//
+// The version reads as 1 only on a machine of the writer's byte order.
+// A mapped matrix uses the index arrays of the file in place and is
+// copied into memory of its own only when it is changed.
+ 
+#ifndef SHORT_CYCLE_SPARSE_MATRIX
+#define SHORT_CYCLE_SPARSE_MATRIX
+
+#include <stddef.h>
+#include <iostream>
+#include <vector>
+
+template <class T> class Short_Cycle_Matrix;
+
+class Short_Cycle_Sparse_Matrix
+{
+  public:
+	// Constructors.
+	Short_Cycle_Sparse_Matrix( void );
+	Short_Cycle_Sparse_Matrix( const Short_Cycle_Sparse_Matrix& copy_mx );
+	~Short_Cycle_Sparse_Matrix( void );
+	Short_Cycle_Sparse_Matrix& operator=( const Short_Cycle_Sparse_Matrix& copy_mx );
+	
+	// Methods for reading matrices from files.  Each of the next four
+	// returns 0, leaving *this unchanged, if the file cannot be read or is
+	// not of its format.  The files may be gzip or zstd compressed and "-"
+	// is standard input (see Short_Cycle_Stream.h).  All but the alist
+	// file are streamed, so only the nonzeros are held in memory.
+	int read_incidence_matrix_file( int nc, int nr, const char* filename );
+	
+	// The column lists of the second half of an alist file must agree
+	// with the row lists; they are kept, as the transpose, in columns if
+	// it is not NULL.
+	int read_alist_file( const char* filename, Short_Cycle_Sparse_Matrix* columns = NULL );
+	
+	// MatrixMarket coordinate files of any field; an entry is a nonzero
+	// element unless its value is 0.  The symmetric kinds are expanded.
+	int read_matrix_market_file( const char* filename );
+	
+	// One edge per line as the row u and column w, numbered from 0.  The
+	// dimensions are nr x nc if given, otherwise one more than the largest
+	// indices.
+	int read_edge_list_file( const char* filename, int nr = 0, int nc = 0 );
+	
+	// Read a QC matrix as the number of block rows and block columns and
+	// the lifting size Z, followed by the shift of each block row by row.
+	// Block (b,c) with shift 0 <= e < Z joins vertex i of row block b to
+	// vertex (i+e) mod Z of column block c.  A shift of -1 is a zero block.
+	// Each reader returns 0 if the file cannot be read, a dimension or Z
+	// is not positive, a shift is out of range or some are missing.
+	int read_qc_file( const char* filename );
+	void expand_qc( int nbr, int nbc, int z, const int* shift );
+	static int read_qc_base( const char* filename, int& nbr, int& nbc, int& z,
+							 std::vector<int>& shift ); // Without expanding it.
+	
+	// Map a binary Tanner graph file, its CSC arrays (i.e., the transpose)
+	// if transposed is set.  Each returns 0, leaving *this unchanged, if
+	// the file cannot be read or is not a valid binary file of this
+	// version, e.g., if its CSC arrays are not the transpose of its CSR
+	// arrays or the matrix is not QC with its lifting size.
+	int map_binary_file( const char* filename, int transposed = 0 );
+	int write_binary_file( const char* filename ) const;
+	
+	// Build the sparse structure from the nonzero elements of a dense matrix.
+	void compress( const Short_Cycle_Matrix<double>& source );
+	
+	// Accessors.
+	int set( void )  const { return set_; };  // 1 if allocated, 2 if mapped.
+	int i_nc( void ) const { return i_nc_; };
+	int i_nr( void ) const { return i_nr_; };
+	int e_nc( void ) const { return e_nc_; };
+	int e_nr( void ) const { return e_nr_; };
+	int nnz( void )  const { return nnz_; };
+	int lift( void ) const { return lift_; };  // Z for a QC matrix, 0 otherwise.
+	int gen_nr( void ) const { return lift_ ? e_nr_/lift_ : e_nr_; };
+	
+	// The nonzeros of row r are col_idx()[row_ptr()[r]] ... col_idx()[row_ptr()[r+1]-1].
+	const int* row_ptr( void ) const { return row_ptr_; };
+	const int* col_idx( void ) const { return col_idx_; };
+	
+	// Free the matrix memory.
+	void delete_data( void );
+	
+	// Exchange the contents of two matrices.
+	void swap( Short_Cycle_Sparse_Matrix& other );
+	
+	// Matrix operations.
+	void transpose( const Short_Cycle_Sparse_Matrix& source ); // *this = source^T
+	
+	// *this = rows r0 ... r1-1 of source, which may include padding rows.
+	void copy_rows( const Short_Cycle_Sparse_Matrix& source, int r0, int r1 );
+	
+	// The position of element (r,c) in col_idx(), -1 if it is 0.
+	int find( int r, int c ) const;
+	
+	// Set element (r,c) to 1 or 0.  Each returns 0 if it was already so.
+	// A change leaves a QC matrix an ordinary one.
+	int insert( int r, int c );
+	int erase( int r, int c );
+	
+	// Output matrix for debugging.
+	friend std::ostream& operator<<( std::ostream& os, const Short_Cycle_Sparse_Matrix& mx );
+	
+  private:
+	// Allocate row_ptr_ and col_idx_ for the current dimensions and nnz_.
+	void allocate( void );
+	void build( int nr, int nc, std::vector<int>& rows, std::vector<int>& cols );
+	void own( void );	// Copy a mapped matrix into memory of its own.
+	
+	int*		row_ptr_;	// e_nr_+1 row offsets into col_idx_.
+	int*		col_idx_;	// Column index of each nonzero, sorted within a row.
+	int			i_nc_;		// "Internal" matrix dimensions.
+	int			i_nr_;		
+	int			e_nc_;      // "External" matrix dimensions. 
+	int			e_nr_;
+	int			nnz_;		// Number of nonzero (unit) elements.
+	int			lift_;		// Lifting size of a QC matrix, 0 otherwise.
+	int			set_;		// Flag indicating if memory allocated or mapped.
+	void*		map_;		// The mapped file, if set_ == 2.
+	size_t		map_bytes_;
+};
+ 
+#endif
@@ -0,0 +1,261 @@
+/* Short_Cycle_Stream.cpp
+
+   Copyright (c) 2005 Thomas R. Halford 
+   All rights reserved.
+ 
+   Developed by: Thomas R. Halford
+                 Communication Sciences Institute
+                 University of Southern California
+                 http://csi.usc.edu
+ 
+   Permission is hereby granted, free of charge, to any person obtaining a copy 
+   of this software and associated documentation files (the "Software"), to deal 
+   with the Software without restriction, including without limitation the rights 
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+   copies of the Software, and to permit persons to whom the Software is furnished 
+   to do so, subject to the following conditions:
+  
+    * Redistributions of source code must retain the above copyright notice, this 
+      list of conditions and the following disclaimers.
+    * Redistributions in binary form must reproduce the above copyright notice, 
+      this list of conditions and the following disclaimers in the documentation 
+      and/or other materials provided with the distribution.
+    * Neither the names of Thomas R. Halford, the Communication Sciences Institute, 
+      the University of Southern California nor the names of its contributors may 
+      be used to endorse or promote products derived from this Software without 
+      specific prior written permission. 
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+   INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+   PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE CONTRIBUTORS OR 
+   COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN 
+   AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION 
+   WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE SOFTWARE.
+*/
+
+#include <string.h>
+#include <algorithm>
+#if defined(_WIN32)
+#include <io.h>
+#include <fcntl.h>
+#endif
+#include "Short_Cycle_Stream.h"
+
+using namespace std;
+
+// The size of the file and decompression buffers.
+static const size_t STREAM_BLOCK = 256*1024;
+
+Short_Cycle_Stream::Short_Cycle_Stream( void )
+ : file_(NULL), std_in_(0), format_(PLAIN), error_(0), frame_end_(1), pending_(0),
+   in_pos_(0), in_len_(0), out_pos_(0), out_len_(0)
+#if SCM_ZLIB
+   , zs_set_(0)
+#endif
+#if SCM_ZSTD
+   , zds_(NULL)
+#endif
+{
+	return;
+}
+
+Short_Cycle_Stream::~Short_Cycle_Stream( void )
+{
+	close();
+}
+
+// gzip files begin 1f 8b and zstd frames 28 b5 2f fd.
+Short_Cycle_Stream::Format Short_Cycle_Stream::format_of( const char* p, size_t n )
+{
+	const unsigned char* m = (const unsigned char*)p;
+	if( n >= 2 && m[0] == 0x1f && m[1] == 0x8b ) return GZIP;
+	if( n >= 4 && m[0] == 0x28 && m[1] == 0xb5 && m[2] == 0x2f && m[3] == 0xfd ) return ZSTD;
+	return PLAIN;
+}
+
+int Short_Cycle_Stream::open( const char* filename )
+{
+	close();
+	std_in_ = (strcmp(filename,"-") == 0);
+	file_ = (std_in_ ? stdin : fopen(filename,"rb"));
+	if( file_ == NULL ) return 0;
+#if defined(_WIN32)
+	if( std_in_ ) _setmode(_fileno(stdin),_O_BINARY);
+#endif
+	
+	// Recognize the format from the first bytes.
+	in_.resize(STREAM_BLOCK);
+	while( in_len_ < 4 && fill_in() ) {}
+	format_ = format_of(in_.empty() ? NULL : &in_[0],in_len_);
+	if( format_ != PLAIN ) out_.resize(STREAM_BLOCK);
+	
+	int ok = !error_;
+	if( format_ == GZIP )
+	{
+#if SCM_ZLIB
+		memset(&zs_,0,sizeof(zs_));
+		zs_set_ = (inflateInit2(&zs_,15+16) == Z_OK);
+		ok = ok && zs_set_;
+#else
+		ok = 0;
+#endif
+	}
+	
+	if( format_ == ZSTD )
+	{
+#if SCM_ZSTD
+		zds_ = ZSTD_createDStream();
+		ok = ok && zds_ != NULL && !ZSTD_isError(ZSTD_initDStream(zds_));
+#else
+		ok = 0;
+#endif
+	}
+	
+	if( !ok ) close();
+	return ok;
+}
+
+void Short_Cycle_Stream::close( void )
+{
+#if SCM_ZLIB
+	if( zs_set_ ) inflateEnd(&zs_);
+	zs_set_ = 0;
+#endif
+#if SCM_ZSTD
+	if( zds_ ) ZSTD_freeDStream(zds_);
+	zds_ = NULL;
+#endif
+	if( file_ && !std_in_ ) fclose(file_);
+	file_    = NULL;
+	std_in_  = 0;
+	format_  = PLAIN;
+	error_   = 0;
+	frame_end_ = 1;
+	pending_ = 0;
+	in_pos_ = in_len_ = out_pos_ = out_len_ = 0;
+}
+
+// The unread part of in_ is moved to the front first.
+int Short_Cycle_Stream::fill_in( void )
+{
+	if( file_ == NULL ) return 0;
+	if( in_pos_ > 0 )
+	{
+		memmove(&in_[0],&in_[in_pos_],in_len_-in_pos_);
+		in_len_ -= in_pos_;
+		in_pos_ = 0;
+	}
+	
+	size_t got = fread(&in_[in_len_],1,in_.size()-in_len_,file_);
+	if( got == 0 && ferror(file_) ) error_ = 1;
+	in_len_ += got;
+	return got > 0;
+}
+
+// Plain files pass through in_, which is exchanged with out_.  The
+// decompressors are fed in_ until they produce some output.  A file that
+// ends inside a compressed frame is an error.
+int Short_Cycle_Stream::fill_out( void )
+{
+	out_pos_ = out_len_ = 0;
+	if( format_ == PLAIN )
+	{
+		if( in_pos_ == in_len_ )
+		{
+			in_pos_ = in_len_ = 0;
+			if( !fill_in() ) return 0;
+		}
+		
+		out_.swap(in_);
+		swap(out_pos_,in_pos_);
+		swap(out_len_,in_len_);
+		in_.resize(STREAM_BLOCK);
+		return 1;
+	}
+	
+	while( out_len_ == 0 )
+	{
+		if( error_ ) return 0;
+		if( in_pos_ == in_len_ && !pending_ && !fill_in() )
+		{
+			if( !frame_end_ ) error_ = 1;
+			return 0;
+		}
+		
+#if SCM_ZLIB
+		if( format_ == GZIP )
+		{
+			zs_.next_in   = (Bytef*)&in_[0]+in_pos_;
+			zs_.avail_in  = (uInt)(in_len_-in_pos_);
+			zs_.next_out  = (Bytef*)&out_[0];
+			zs_.avail_out = (uInt)out_.size();
+			int ret = inflate(&zs_,Z_NO_FLUSH);
+			in_pos_  = in_len_-zs_.avail_in;
+			out_len_ = out_.size()-zs_.avail_out;
+			pending_ = (zs_.avail_out == 0);
+			frame_end_ = (ret == Z_STREAM_END);
+			
+			// Concatenated gzip members are read as one file.
+			if( ret == Z_STREAM_END ) inflateReset(&zs_);
+			else if( ret != Z_OK && ret != Z_BUF_ERROR ) error_ = 1;
+		}
+#endif
+#if SCM_ZSTD
+		if( format_ == ZSTD )
+		{
+			ZSTD_inBuffer  zin  = { &in_[0]+in_pos_, in_len_-in_pos_, 0 };
+			ZSTD_outBuffer zout = { &out_[0], out_.size(), 0 };
+			size_t ret = ZSTD_decompressStream(zds_,&zout,&zin);
+			if( ZSTD_isError(ret) ) error_ = 1;
+			in_pos_ += zin.pos;
+			out_len_ = zout.pos;
+			pending_ = (zout.pos == zout.size);
+			frame_end_ = (ret == 0);
+		}
+#endif
+	}
+	
+	return 1;
+}
+
+size_t Short_Cycle_Stream::read( char* buf, size_t bytes )
+{
+	size_t done = 0;
+	while( done < bytes )
+	{
+		if( out_pos_ == out_len_ && !fill_out() ) break;
+		size_t n = min(bytes-done,out_len_-out_pos_);
+		memcpy(buf+done,&out_[out_pos_],n);
+		out_pos_ += n;
+		done += n;
+	}
+	
+	return done;
+}
+
+// A last line without an end of line is still a line.  The \r of DOS
+// line ends is dropped.
+int Short_Cycle_Stream::read_line( string& line )
+{
+	line.clear();
+	int found = 0;
+	for( ;; )
+	{
+		if( out_pos_ == out_len_ && !fill_out() ) break;
+		const char* from = &out_[out_pos_];
+		const char* nl = (const char*)memchr(from,'\n',out_len_-out_pos_);
+		if( nl )
+		{
+			line.append(from,nl-from);
+			out_pos_ += (nl-from)+1;
+			found = 1;
+			break;
+		}
+		
+		line.append(from,out_len_-out_pos_);
+		out_pos_ = out_len_;
+	}
+	
+	if( !line.empty() && line[line.size()-1] == '\r' ) line.erase(line.size()-1);
+	return found || !line.empty();
+}
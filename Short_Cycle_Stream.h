@@ -0,0 +1,124 @@
+/* Short_Cycle_Stream.h
+
+   Copyright (c) 2005 Thomas R. Halford 
+   All rights reserved.
+ 
+   Developed by: Thomas R. Halford
+                 Communication Sciences Institute
+                 University of Southern California
+                 http://csi.usc.edu
+ 
+   Permission is hereby granted, free of charge, to any person obtaining a copy 
+   of this software and associated documentation files (the "Software"), to deal 
+   with the Software without restriction, including without limitation the rights 
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+   copies of the Software, and to permit persons to whom the Software is furnished 
+   to do so, subject to the following conditions:
+  
+    * Redistributions of source code must retain the above copyright notice, this 
+      list of conditions and the following disclaimers.
+    * Redistributions in binary form must reproduce the above copyright notice, 
+      this list of conditions and the following disclaimers in the documentation 
+      and/or other materials provided with the distribution.
+    * Neither the names of Thomas R. Halford, the Communication Sciences Institute, 
+      the University of Southern California nor the names of its contributors may 
+      be used to endorse or promote products derived from this Software without 
+      specific prior written permission. 
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+   INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+   PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE CONTRIBUTORS OR 
+   COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN 
+   AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION 
+   WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE SOFTWARE.
+*/
+
+// Short_Cycle_Stream.h reads a file, or standard input named "-", in
+// blocks, decompressing it on the fly if it is gzip or zstd compressed.
+// The format is recognized from the first bytes of the file.  gzip
+// support needs zlib (define SCM_ZLIB as 1 and link with -lz) and zstd
+// support libzstd (define SCM_ZSTD as 1 and link with -lzstd); without
+// them a compressed file cannot be opened.  Only the block buffers are
+// held in memory, so the matrix readers of Short_Cycle_Sparse_Matrix
+// need memory in proportion to the nonzeros alone.
+
+#ifndef SHORT_CYCLE_STREAM
+#define SHORT_CYCLE_STREAM
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#ifndef SCM_ZLIB
+#define SCM_ZLIB 0
+#endif
+
+#ifndef SCM_ZSTD
+#define SCM_ZSTD 0
+#endif
+
+#if SCM_ZLIB
+#include <zlib.h>
+#endif
+
+#if SCM_ZSTD
+#include <zstd.h>
+#endif
+
+class Short_Cycle_Stream
+{
+  public:
+	enum Format { PLAIN, GZIP, ZSTD };
+	
+	// Constructors.
+	Short_Cycle_Stream( void );
+	~Short_Cycle_Stream( void );
+	
+	// Returns 0 if the file cannot be opened or is compressed in a
+	// format that was not compiled in.
+	int open( const char* filename );
+	void close( void );
+	
+	Format format( void ) const { return format_; };
+	
+	// The format of a file that begins with the n bytes at p.
+	static Format format_of( const char* p, size_t n );
+	
+	// Read up to bytes (decompressed) bytes, fewer only at the end of the
+	// file.  Returns the number read.
+	size_t read( char* buf, size_t bytes );
+	
+	// Read the next line without its end of line.  Returns 0 at the end.
+	int read_line( std::string& line );
+	
+	// Set if the file could not be read or decompressed.
+	int error( void ) const { return error_; };
+	
+  private:
+	Short_Cycle_Stream( const Short_Cycle_Stream& );
+	Short_Cycle_Stream& operator=( const Short_Cycle_Stream& );
+	
+	int fill_in( void );		// Read more of the file into in_.
+	int fill_out( void );		// Decompress more of it into out_.
+	
+	FILE*			  file_;
+	int				  std_in_;	// Set if file_ is stdin, which is not closed.
+	Format			  format_;
+	int				  error_;
+	int				  frame_end_;	// Set at the end of a compressed frame.
+	int				  pending_;	// Set if the decompressor may hold more output.
+	std::vector<char> in_;		// The file as read, in_[in_pos_] ... in_[in_len_-1].
+	size_t			  in_pos_, in_len_;
+	std::vector<char> out_;		// The file as decompressed, likewise.
+	size_t			  out_pos_, out_len_;
+#if SCM_ZLIB
+	z_stream		  zs_;
+	int				  zs_set_;
+#endif
+#if SCM_ZSTD
+	ZSTD_DStream*	  zds_;
+#endif
+};
+
+#endif
@@ -0,0 +1,434 @@
+/* Short_Cycle_Tasks.cpp
+
+   Copyright (c) 2005 Thomas R. Halford 
+   All rights reserved.
+ 
+   Developed by: Thomas R. Halford
+                 Communication Sciences Institute
+                 University of Southern California
+                 http://csi.usc.edu
+ 
+   Permission is hereby granted, free of charge, to any person obtaining a copy 
+   of this software and associated documentation files (the "Software"), to deal 
+   with the Software without restriction, including without limitation the rights 
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+   copies of the Software, and to permit persons to whom the Software is furnished 
+   to do so, subject to the following conditions:
+  
+    * Redistributions of source code must retain the above copyright notice, this 
+      list of conditions and the following disclaimers.
+    * Redistributions in binary form must reproduce the above copyright notice, 
+      this list of conditions and the following disclaimers in the documentation 
+      and/or other materials provided with the distribution.
+    * Neither the names of Thomas R. Halford, the Communication Sciences Institute, 
+      the University of Southern California nor the names of its contributors may 
+      be used to endorse or promote products derived from this Software without 
+      specific prior written permission. 
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+   INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+   PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE CONTRIBUTORS OR 
+   COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN 
+   AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION 
+   WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE SOFTWARE.
+*/
+
+#include "Short_Cycle_Tasks.h"
+
+using namespace std;
+
+Short_Cycle_Task_Graph::Short_Cycle_Task_Graph( void )
+{
+	return;
+}
+
+Short_Cycle_Task_Graph::~Short_Cycle_Task_Graph( void )
+{
+	for( size_t ii = 0; ii < nodes_.size(); ii++ ) delete nodes_[ii].task;
+}
+
+Short_Cycle_Task_Graph& Short_Cycle_Task_Graph::add( const char* name, Short_Cycle_Task* task )
+{
+	Node node;
+	node.name    = name;
+	node.task    = NULL;
+	node.waiting = 0;
+	nodes_.push_back(node);
+	nodes_.back().task = task;
+	return *this;
+}
+
+// The resource for obj, which is added if it is new.
+Short_Cycle_Task_Graph::Resource& Short_Cycle_Task_Graph::resource( void* obj, void (*free)( void* ) )
+{
+	for( size_t ii = 0; ii < resources_.size(); ii++ )
+	{
+		if( resources_[ii].obj == obj ) return resources_[ii];
+	}
+	
+	Resource r;
+	r.obj     = obj;
+	r.free    = free;
+	r.keep    = 0;
+	r.writer  = -1;
+	r.pending = 0;
+	resources_.push_back(r);
+	return resources_.back();
+}
+
+// Record an access of obj by the last node added.
+void Short_Cycle_Task_Graph::access( void* obj, void (*free)( void* ), int write )
+{
+	int node = size()-1;
+	Resource& r = resource(obj,free);
+	int id = (int)(&r-&resources_[0]);
+	
+	vector<int>& acc = nodes_[node].access;
+	size_t ii = 0;
+	while( ii < acc.size() && acc[ii] != id ) ii++;
+	if( ii == acc.size() ) acc.push_back(id);
+	
+	if( r.writer >= 0 ) depend(r.writer,node);
+	if( write )
+	{
+		for( size_t jj = 0; jj < r.readers.size(); jj++ ) depend(r.readers[jj],node);
+		r.readers.clear();
+		r.writer = node;
+	}
+	
+	else r.readers.push_back(node);
+}
+
+void Short_Cycle_Task_Graph::keep_all( void )
+{
+	for( size_t ii = 0; ii < resources_.size(); ii++ ) resources_[ii].keep = 1;
+}
+
+void Short_Cycle_Task_Graph::depend( int before, int after )
+{
+	if( before == after ) return;
+	vector<int>& pred = nodes_[after].pred;
+	for( size_t ii = 0; ii < pred.size(); ii++ ) if( pred[ii] == before ) return;
+	pred.push_back(before);
+	nodes_[before].succ.push_back(after);
+}
+
+// Reset the counts of unfinished predecessors and accessors.
+void Short_Cycle_Task_Graph::start( void )
+{
+	for( size_t ii = 0; ii < resources_.size(); ii++ ) resources_[ii].pending = 0;
+	for( size_t ii = 0; ii < nodes_.size(); ii++ )
+	{
+		nodes_[ii].waiting = (int)nodes_[ii].pred.size();
+		for( size_t jj = 0; jj < nodes_[ii].access.size(); jj++ ) resources_[nodes_[ii].access[jj]].pending++;
+	}
+}
+
+void Short_Cycle_Task_Graph::finish( int node, vector<int>& ready, vector<int>& dead )
+{
+	const Node& n = nodes_[node];
+	for( size_t ii = 0; ii < n.succ.size(); ii++ )
+	{
+		if( --nodes_[n.succ[ii]].waiting == 0 ) ready.push_back(n.succ[ii]);
+	}
+	
+	for( size_t ii = 0; ii < n.access.size(); ii++ )
+	{
+		Resource& r = resources_[n.access[ii]];
+		if( --r.pending == 0 && !r.keep ) dead.push_back(n.access[ii]);
+	}
+}
+
+void Short_Cycle_Task_Graph::free_resources( const vector<int>& dead )
+{
+	for( size_t ii = 0; ii < dead.size(); ii++ ) resources_[dead[ii]].free(resources_[dead[ii]].obj);
+}
+
+// The nodes are added after all of their predecessors, so running them
+// in order respects every dependency.
+void Short_Cycle_Task_Graph::run( Short_Cycle_Thread_Pool* pool )
+{
+	if( pool && pool->threads() > 1 && size() > 1 )
+	{
+		pool->run(*this);
+		return;
+	}
+	
+	start();
+	vector<int> ready, dead;
+	for( int ii = 0; ii < size(); ii++ )
+	{
+		nodes_[ii].task->run();
+		ready.clear();
+		dead.clear();
+		finish(ii,ready,dead);
+		free_resources(dead);
+	}
+}
+
+ostream& operator<<( ostream& os, const Short_Cycle_Task_Graph& graph )
+{
+	for( int ii = 0; ii < graph.size(); ii++ )
+	{
+		const Short_Cycle_Task_Graph::Node& n = graph.nodes_[ii];
+		os << n.name << " <-";
+		for( size_t jj = 0; jj < n.pred.size(); jj++ ) os << " " << graph.nodes_[n.pred[jj]].name;
+		os << endl;
+	}
+	
+	return os;
+}
+
+Short_Cycle_Thread_Pool::Short_Cycle_Thread_Pool( int n_threads )
+  : n_threads_(1)
+#if SCM_THREADS
+	, graph_(NULL), mx_pool_(NULL), runs_(0), pushes_(0), remaining_(0), busy_(0), stop_(0)
+#endif
+{
+	set_threads(n_threads);
+}
+
+#if SCM_THREADS
+
+Short_Cycle_Thread_Pool::~Short_Cycle_Thread_Pool( void )
+{
+	stop();
+}
+
+void Short_Cycle_Thread_Pool::set_threads( int n_threads )
+{
+	stop();
+	if( n_threads <= 0 ) n_threads = (int)thread::hardware_concurrency();
+	n_threads_ = n_threads > 0 ? n_threads : 1;
+}
+
+// Start the workers other than the caller.
+void Short_Cycle_Thread_Pool::start( void )
+{
+	if( !threads_.empty() ) return;
+	for( int ii = 0; ii < n_threads_; ii++ ) queues_.push_back(new Queue);
+	stop_ = 0;
+	for( int ii = 1; ii < n_threads_; ii++ ) threads_.push_back(thread(&Short_Cycle_Thread_Pool::serve,this,ii));
+}
+
+void Short_Cycle_Thread_Pool::stop( void )
+{
+	{
+		lock_guard<mutex> guard(lock_);
+		stop_ = 1;
+	}
+	
+	wake_.notify_all();
+	for( size_t ii = 0; ii < threads_.size(); ii++ ) threads_[ii].join();
+	threads_.clear();
+	for( size_t ii = 0; ii < queues_.size(); ii++ ) delete queues_[ii];
+	queues_.clear();
+}
+
+void Short_Cycle_Thread_Pool::run( Short_Cycle_Task_Graph& graph )
+{
+	start();
+	
+	vector<int> ready;
+	graph.start();
+	for( int ii = 0; ii < graph.size(); ii++ ) if( graph.nodes_[ii].waiting == 0 ) ready.push_back(ii);
+	{
+		lock_guard<mutex> guard(lock_);
+		graph_     = &graph;
+		mx_pool_   = Short_Cycle_Pool::current();
+		remaining_ = graph.size();
+		error_     = exception_ptr();
+		busy_++;
+		runs_++;
+	}
+	
+	// The first nodes are dealt out to all of the workers.
+	for( size_t ii = 0; ii < ready.size(); ii++ )
+	{
+		Queue& q = *queues_[ii%queues_.size()];
+		lock_guard<mutex> guard(q.lock);
+		q.nodes.push_back(ready[ii]);
+	}
+	
+	{
+		lock_guard<mutex> guard(lock_);
+		pushes_++;
+	}
+	
+	wake_.notify_all();
+	ready_.notify_all();
+	work(0);
+	
+	exception_ptr error;
+	{
+		unique_lock<mutex> guard(lock_);
+		busy_--;
+		while( busy_ > 0 ) idle_.wait(guard);
+		graph_   = NULL;
+		mx_pool_ = NULL;
+		error    = error_;
+		error_ = exception_ptr();
+	}
+	
+	if( error ) rethrow_exception(error);
+}
+
+// The loop of a worker thread.  The matrices are allocated from the pool
+// of the thread that started the run.
+void Short_Cycle_Thread_Pool::serve( int id )
+{
+	unsigned long seen = 0;
+	for( ;; )
+	{
+		Short_Cycle_Pool* pool;
+		{
+			unique_lock<mutex> guard(lock_);
+			while( !stop_ && (runs_ == seen || remaining_ == 0) ) wake_.wait(guard);
+			if( stop_ ) return;
+			seen = runs_;
+			pool = mx_pool_;
+			busy_++;
+		}
+		
+		Short_Cycle_Pool::use(pool);
+		work(id);
+		Short_Cycle_Pool::use(NULL);
+		
+		{
+			lock_guard<mutex> guard(lock_);
+			busy_--;
+		}
+		
+		idle_.notify_all();
+	}
+}
+
+// Run nodes until every node of the graph has finished.
+void Short_Cycle_Thread_Pool::work( int id )
+{
+	vector<int> ready, dead;
+	for( ;; )
+	{
+		unsigned long seen;
+		{
+			lock_guard<mutex> guard(lock_);
+			if( remaining_ == 0 ) return;
+			seen = pushes_;
+		}
+		
+		int node;
+		while( (node = take(id)) >= 0 )
+		{
+			// After an error the remaining nodes are only retired.
+			int failed;
+			{
+				lock_guard<mutex> guard(lock_);
+				failed = error_ != exception_ptr();
+			}
+			
+			if( !failed )
+			{
+				try
+				{
+					graph_->nodes_[node].task->run();
+				}
+				
+				catch( ... )
+				{
+					lock_guard<mutex> guard(lock_);
+					if( !error_ ) error_ = current_exception();
+				}
+			}
+			
+			ready.clear();
+			dead.clear();
+			int done;
+			{
+				lock_guard<mutex> guard(lock_);
+				graph_->finish(node,ready,dead);
+				done = (--remaining_ == 0);
+			}
+			
+			graph_->free_resources(dead);
+			push(id,ready);
+			if( done ) 
+			{
+				ready_.notify_all();
+				return;
+			}
+		}
+		
+		// Wait for nodes to be queued or for the run to end.
+		unique_lock<mutex> guard(lock_);
+		while( remaining_ > 0 && pushes_ == seen ) ready_.wait(guard);
+	}
+}
+
+// The newest node of the worker's own queue, else the oldest node of
+// another queue.  Returns -1 if every queue is empty.
+int Short_Cycle_Thread_Pool::take( int id )
+{
+	int n = (int)queues_.size();
+	{
+		Queue& q = *queues_[id];
+		lock_guard<mutex> guard(q.lock);
+		if( !q.nodes.empty() )
+		{
+			int node = q.nodes.back();
+			q.nodes.pop_back();
+			return node;
+		}
+	}
+	
+	for( int ii = 1; ii < n; ii++ )
+	{
+		Queue& q = *queues_[(id+ii)%n];
+		lock_guard<mutex> guard(q.lock);
+		if( !q.nodes.empty() )
+		{
+			int node = q.nodes.front();
+			q.nodes.pop_front();
+			return node;
+		}
+	}
+	
+	return -1;
+}
+
+// The worker takes one of the nodes itself, so the others are woken only
+// if there is more than one.
+void Short_Cycle_Thread_Pool::push( int id, const vector<int>& nodes )
+{
+	if( nodes.empty() ) return;
+	{
+		Queue& q = *queues_[id];
+		lock_guard<mutex> guard(q.lock);
+		for( size_t ii = 0; ii < nodes.size(); ii++ ) q.nodes.push_back(nodes[ii]);
+	}
+	
+	{
+		lock_guard<mutex> guard(lock_);
+		pushes_++;
+	}
+	
+	if( nodes.size() > 1 ) ready_.notify_all();
+}
+
+#else
+
+Short_Cycle_Thread_Pool::~Short_Cycle_Thread_Pool( void )
+{
+	return;
+}
+
+void Short_Cycle_Thread_Pool::set_threads( int )
+{
+	n_threads_ = 1;
+}
+
+void Short_Cycle_Thread_Pool::run( Short_Cycle_Task_Graph& graph )
+{
+	graph.run(NULL);
+}
+
+#endif
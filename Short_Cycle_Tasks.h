@@ -0,0 +1,254 @@
+/* Short_Cycle_Tasks.h
+
+   Copyright (c) 2005 Thomas R. Halford 
+   All rights reserved.
+ 
+   Developed by: Thomas R. Halford
+                 Communication Sciences Institute
+                 University of Southern California
+                 http://csi.usc.edu
+ 
+   Permission is hereby granted, free of charge, to any person obtaining a copy 
+   of this software and associated documentation files (the "Software"), to deal 
+   with the Software without restriction, including without limitation the rights 
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+   copies of the Software, and to permit persons to whom the Software is furnished 
+   to do so, subject to the following conditions:
+  
+    * Redistributions of source code must retain the above copyright notice, this 
+      list of conditions and the following disclaimers.
+    * Redistributions in binary form must reproduce the above copyright notice, 
+      this list of conditions and the following disclaimers in the documentation 
+      and/or other materials provided with the distribution.
+    * Neither the names of Thomas R. Halford, the Communication Sciences Institute, 
+      the University of Southern California nor the names of its contributors may 
+      be used to endorse or promote products derived from this Software without 
+      specific prior written permission. 
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+   INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+   PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE CONTRIBUTORS OR 
+   COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN 
+   AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION 
+   WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE SOFTWARE.
+*/
+
+// Short_Cycle_Tasks.h defines the task graph on which Short_Cycle_Engine
+// runs the matrix recursions.  A node is a named task together with the
+// matrices it reads (in()) and writes (out()).  The dependencies follow
+// from the order in which the nodes are added: a node runs after the last
+// earlier writer of each matrix it accesses and, if it writes a matrix,
+// after every earlier reader of it.  So the graph computes what running
+// the nodes in order would.  A matrix is freed (delete_data()) as soon as
+// every node that accesses it has finished unless it is kept.
+//
+// A graph is run by a Short_Cycle_Thread_Pool.  Each worker keeps a queue
+// of the nodes made ready by the nodes it ran and takes the newest of them
+// first.  A worker with an empty queue steals the oldest node of another.
+// Without threads (see SCM_THREADS in Short_Cycle_Pool.h), or with one
+// thread, the nodes run in the order in which they were added.
+
+#ifndef SHORT_CYCLE_TASKS
+#define SHORT_CYCLE_TASKS
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Short_Cycle_Pool.h"
+
+#if SCM_THREADS
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <thread>
+#endif
+
+class Short_Cycle_Thread_Pool;
+
+// A node of a task graph.
+class Short_Cycle_Task
+{
+  public:
+	virtual ~Short_Cycle_Task( void ) {};
+	virtual void run( void ) = 0;
+};
+
+// Calls obj->method().
+template <class C>
+class Short_Cycle_Method_Task : public Short_Cycle_Task
+{
+  public:
+	Short_Cycle_Method_Task( C* obj, void (C::*method)( void ) ) : obj_(obj), method_(method) {};
+	void run( void ) { (obj_->*method_)(); };
+	
+  private:
+	C* obj_;
+	void (C::*method_)( void );
+};
+
+// Copies source into dest.
+template <class M>
+class Short_Cycle_Copy_Task : public Short_Cycle_Task
+{
+  public:
+	Short_Cycle_Copy_Task( M& dest, const M& source ) : dest_(dest), source_(source) {};
+	void run( void ) { dest_ = source_; };
+	
+  private:
+	M& dest_;
+	const M& source_;
+};
+
+class Short_Cycle_Task_Graph
+{
+  public:
+	Short_Cycle_Task_Graph( void );
+	~Short_Cycle_Task_Graph( void );
+	
+	// Add a node.  The graph owns task.  in(), out() and keep() may be
+	// chained to the node, e.g., graph.add(...).out(A).in(B).in(C).
+	Short_Cycle_Task_Graph& add( const char* name, Short_Cycle_Task* task );
+	template <class C>
+	Short_Cycle_Task_Graph& add( const char* name, C* obj, void (C::*method)( void ) )
+	{
+		return add(name,new Short_Cycle_Method_Task<C>(obj,method));
+	}
+	
+	// Add a node that copies source into dest.
+	template <class M>
+	Short_Cycle_Task_Graph& copy( const char* name, M& dest, const M& source )
+	{
+		return add(name,new Short_Cycle_Copy_Task<M>(dest,source)).out(dest).in(source);
+	}
+	
+	// The matrices accessed by the last node added.  Any class with a
+	// delete_data() method may be used.
+	template <class M> Short_Cycle_Task_Graph& in( const M& m )
+	{
+		access((void*)&m,&release<M>,0);
+		return *this;
+	}
+	
+	template <class M> Short_Cycle_Task_Graph& out( M& m )
+	{
+		access((void*)&m,&release<M>,1);
+		return *this;
+	}
+	
+	// A matrix that is needed after the graph has run.
+	template <class M> Short_Cycle_Task_Graph& keep( const M& m )
+	{
+		resource((void*)&m,&release<M>).keep = 1;
+		return *this;
+	}
+	
+	void keep_all( void ); // Keep every matrix accessed so far.
+	
+	// Run the graph once on pool, or in order if pool is NULL.  An
+	// exception thrown by a task is rethrown once the running tasks have
+	// finished; the tasks not yet started are skipped.
+	void run( Short_Cycle_Thread_Pool* pool );
+	
+	int size( void ) const { return (int)nodes_.size(); };
+	const std::string& name( int node ) const { return nodes_[node].name; };
+	
+	// Print the nodes and their dependencies.
+	friend std::ostream& operator<<( std::ostream& os, const Short_Cycle_Task_Graph& graph );
+	
+  private:
+	friend class Short_Cycle_Thread_Pool;
+	
+	struct Node
+	{
+		std::string name;
+		Short_Cycle_Task* task;
+		std::vector<int> pred, succ;
+		std::vector<int> access;	  // Resources accessed.
+		int waiting;				  // Unfinished predecessors while running.
+	};
+	
+	struct Resource
+	{
+		void* obj;
+		void (*free)( void* );
+		int keep;
+		int writer;					  // The last node to write the resource.
+		std::vector<int> readers;	  // Nodes reading it since then.
+		int pending;				  // Unfinished accessors while running.
+	};
+	
+	template <class M> static void release( void* m ) { ((M*)m)->delete_data(); };
+	
+	Resource& resource( void* obj, void (*free)( void* ) );
+	void access( void* obj, void (*free)( void* ), int write );
+	void depend( int before, int after );
+	
+	// Mark node as finished.  The nodes made ready are appended to ready
+	// and the resources that are no longer needed to dead.
+	void start( void );
+	void finish( int node, std::vector<int>& ready, std::vector<int>& dead );
+	void free_resources( const std::vector<int>& dead );
+	
+	std::vector<Node> nodes_;
+	std::vector<Resource> resources_;
+	
+	// Not copyable.
+	Short_Cycle_Task_Graph( const Short_Cycle_Task_Graph& );
+	Short_Cycle_Task_Graph& operator=( const Short_Cycle_Task_Graph& );
+};
+
+// A pool of worker threads.  The thread calling run() is one of them.
+// The other threads are started by the first run() and wait between runs.
+// While running a graph they allocate matrices from the caller's current
+// Short_Cycle_Pool.
+class Short_Cycle_Thread_Pool
+{
+  public:
+	// n_threads = 0 uses one thread per hardware thread.
+	Short_Cycle_Thread_Pool( int n_threads = 0 );
+	~Short_Cycle_Thread_Pool( void );
+	
+	void set_threads( int n_threads );
+	int threads( void ) const { return n_threads_; };
+	
+	void run( Short_Cycle_Task_Graph& graph );
+	
+  private:
+	int n_threads_;
+	
+#if SCM_THREADS
+	struct Queue
+	{
+		std::mutex lock;
+		std::deque<int> nodes;
+	};
+	
+	void start( void );
+	void stop( void );
+	void serve( int id );
+	void work( int id );
+	int take( int id );
+	void push( int id, const std::vector<int>& nodes );
+	
+	std::vector<std::thread> threads_;
+	std::vector<Queue*> queues_;		  // One per worker, 0 is the caller.
+	std::mutex lock_;					  // Guards the members below and the graph.
+	std::condition_variable wake_;		  // A run was started or the pool stopped.
+	std::condition_variable ready_;		  // Nodes were queued or the run ended.
+	std::condition_variable idle_;		  // A worker left the run.
+	Short_Cycle_Task_Graph* graph_;
+	Short_Cycle_Pool* mx_pool_;			  // The caller's current pool.
+	unsigned long runs_;				  // Runs started.
+	unsigned long pushes_;				  // Nodes queued.
+	int remaining_;						  // Nodes not yet finished.
+	int busy_;							  // Workers in the current run.
+	int stop_;
+	std::exception_ptr error_;
+#endif
+	
+	// Not copyable.
+	Short_Cycle_Thread_Pool( const Short_Cycle_Thread_Pool& );
+	Short_Cycle_Thread_Pool& operator=( const Short_Cycle_Thread_Pool& );
+};
+
+#endif
@@ -0,0 +1,199 @@
+/* Short_Cycle_Voltage.cpp
+
+   Copyright (c) 2005 Thomas R. Halford 
+   All rights reserved.
+ 
+   Developed by: Thomas R. Halford
+                 Communication Sciences Institute
+                 University of Southern California
+                 http://csi.usc.edu
+ 
+   Permission is hereby granted, free of charge, to any person obtaining a copy 
+   of this software and associated documentation files (the "Software"), to deal 
+   with the Software without restriction, including without limitation the rights 
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+   copies of the Software, and to permit persons to whom the Software is furnished 
+   to do so, subject to the following conditions:
+  
+    * Redistributions of source code must retain the above copyright notice, this 
+      list of conditions and the following disclaimers.
+    * Redistributions in binary form must reproduce the above copyright notice, 
+      this list of conditions and the following disclaimers in the documentation 
+      and/or other materials provided with the distribution.
+    * Neither the names of Thomas R. Halford, the Communication Sciences Institute, 
+      the University of Southern California nor the names of its contributors may 
+      be used to endorse or promote products derived from this Software without 
+      specific prior written permission. 
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+   INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+   PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE CONTRIBUTORS OR 
+   COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN 
+   AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION 
+   WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE SOFTWARE.
+*/
+
+
+#include "Short_Cycle_Sparse_Matrix.h"
+#include "Short_Cycle_Voltage.h"
+
+using namespace std;
+
+Short_Cycle_Voltage::Short_Cycle_Voltage( void )
+ : nbr_(0), nbc_(0), z_(0), start_(0), longest_(0), stop_(0), g_(1000000), Ng_(0), Ng2_(0), Ng4_(0)
+{
+	return;
+}
+
+// Build the base graph.  A step from a block row adds the shift and a
+// step from a block column subtracts it, both reduced modulo z.
+void Short_Cycle_Voltage::initialize( int nbr, int nbc, int z, const int* shift )
+{
+	nbr_ = nbr;
+	nbc_ = nbc;
+	z_   = (z > 0 ? z : 1);
+	
+	int nv = nbr_+nbc_, bb, cc, vv;
+	ptr_.assign(nv+1,0);
+	for( bb = 0; bb < nbr_; bb++ )
+	{
+		for( cc = 0; cc < nbc_; cc++ )
+		{
+			if( shift[(size_t)bb*nbc_+cc] < 0 ) continue;
+			ptr_[bb+1]++;
+			ptr_[nbr_+cc+1]++;
+		}
+	}
+	
+	for( vv = 0; vv < nv; vv++ ) ptr_[vv+1] += ptr_[vv];
+	to_.resize(ptr_[nv]);
+	edge_.resize(ptr_[nv]);
+	voltage_.resize(ptr_[nv]);
+	
+	vector<int> next(ptr_.begin(),ptr_.end()-1);
+	int ee = 0;
+	for( bb = 0; bb < nbr_; bb++ )
+	{
+		for( cc = 0; cc < nbc_; cc++ )
+		{
+			int sh = shift[(size_t)bb*nbc_+cc];
+			if( sh < 0 ) continue;
+			sh %= z_;
+			
+			int pp = next[bb]++;
+			to_[pp] = nbr_+cc;
+			edge_[pp] = ee;
+			voltage_[pp] = sh;
+			
+			pp = next[nbr_+cc]++;
+			to_[pp] = bb;
+			edge_[pp] = ee++;
+			voltage_[pp] = (z_-sh)%z_;
+		}
+	}
+	
+	dist_.assign(nv,-1);
+	on_walk_.assign((size_t)nv*z_,0);
+	g_ = 1000000;
+	Ng_ = Ng2_ = Ng4_ = 0;
+}
+
+int Short_Cycle_Voltage::read_qc_file( const char* filename )
+{
+	int nbr, nbc, z;
+	vector<int> shift;
+	if( !Short_Cycle_Sparse_Matrix::read_qc_base(filename,nbr,nbc,z,shift) ) return 0;
+	initialize(nbr,nbc,z,&shift[0]);
+	return 1;
+}
+
+// The walks are listed 2 deeper at a time until one closes, which is
+// then of the girth.  Each listing costs little next to the last, as the
+// number of walks grows geometrically with their length.
+int Short_Cycle_Voltage::find_girth( int max_girth )
+{
+	g_ = 1000000;
+	Ng_ = Ng2_ = Ng4_ = 0;
+	for( int kk = 4; kk <= max_girth; kk += 2 )
+	{
+		count_walks(kk,1);
+		if( walks_[kk] ) 
+		{
+			g_ = kk;
+			break;
+		}
+	}
+	
+	return g_;
+}
+
+int Short_Cycle_Voltage::count( int max_girth )
+{
+	if( find_girth(max_girth) == 1000000 ) return g_;
+	count_walks(g_+4,0);
+	Ng_  = walks_[g_]*z_/g_;
+	Ng2_ = walks_[g_+2]*z_/(g_+2);
+	Ng4_ = walks_[g_+4]*z_/(g_+4);
+	return g_;
+}
+
+// For each block row, a breadth first search for the distances to it 
+// (of at most longest/2, the furthest a closed walk can reach) and then
+// the depth first search for the walks.
+void Short_Cycle_Voltage::count_walks( int longest, int stop )
+{
+	longest_ = longest;
+	stop_ = stop;
+	walks_.assign(longest+1,0);
+	vector<int> queue;
+	for( int ss = 0; ss < nbr_ && !(stop && walks_[longest]); ss++ )
+	{
+		queue.assign(1,ss);
+		dist_[ss] = 0;
+		for( size_t head = 0; head < queue.size(); head++ )
+		{
+			int vv = queue[head];
+			if( 2*(dist_[vv]+1) > longest ) continue;
+			for( int pp = ptr_[vv]; pp < ptr_[vv+1]; pp++ )
+			{
+				if( dist_[to_[pp]] >= 0 ) continue;
+				dist_[to_[pp]] = dist_[vv]+1;
+				queue.push_back(to_[pp]);
+			}
+		}
+		
+		start_ = (size_t)ss*z_;
+		on_walk_[start_] = 1;
+		extend(ss,0,0,-1);
+		on_walk_[start_] = 0;
+		for( size_t ii = 0; ii < queue.size(); ii++ ) dist_[queue[ii]] = -1;
+	}
+}
+
+// Extend a walk that has reached vv with voltage sum after depth steps,
+// the last along last_edge, which is not taken straight back.  Vertex
+// i of block v of the lifted graph is v*Z+i.  A step that returns to a
+// vertex of the walk with the same voltage returns to the same vertex of
+// the lifted graph: it closes a cycle if that is the start, and otherwise
+// the lifted walk is no cycle and is abandoned.
+void Short_Cycle_Voltage::extend( int vv, int sum, int depth, int last_edge )
+{
+	for( int pp = ptr_[vv]; pp < ptr_[vv+1] && !(stop_ && walks_[longest_]); pp++ )
+	{
+		int xx = to_[pp];
+		if( edge_[pp] == last_edge || dist_[xx] < 0 || depth+1+dist_[xx] > longest_ ) continue;
+		
+		int next = sum+voltage_[pp];
+		if( next >= z_ ) next -= z_;
+		size_t lifted = (size_t)xx*z_+next;
+		if( on_walk_[lifted] )
+		{
+			if( lifted == start_ ) walks_[depth+1]++;
+			continue;
+		}
+		
+		on_walk_[lifted] = 1;
+		extend(xx,next,depth+1,edge_[pp]);
+		on_walk_[lifted] = 0;
+	}
+}
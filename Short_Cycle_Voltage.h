@@ -0,0 +1,114 @@
+/* Short_Cycle_Voltage.h
+
+   Copyright (c) 2005 Thomas R. Halford 
+   All rights reserved.
+ 
+   Developed by: Thomas R. Halford
+                 Communication Sciences Institute
+                 University of Southern California
+                 http://csi.usc.edu
+ 
+   Permission is hereby granted, free of charge, to any person obtaining a copy 
+   of this software and associated documentation files (the "Software"), to deal 
+   with the Software without restriction, including without limitation the rights 
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+   copies of the Software, and to permit persons to whom the Software is furnished 
+   to do so, subject to the following conditions:
+  
+    * Redistributions of source code must retain the above copyright notice, this 
+      list of conditions and the following disclaimers.
+    * Redistributions in binary form must reproduce the above copyright notice, 
+      this list of conditions and the following disclaimers in the documentation 
+      and/or other materials provided with the distribution.
+    * Neither the names of Thomas R. Halford, the Communication Sciences Institute, 
+      the University of Southern California nor the names of its contributors may 
+      be used to endorse or promote products derived from this Software without 
+      specific prior written permission. 
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+   INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+   PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE CONTRIBUTORS OR 
+   COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN 
+   AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION 
+   WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE SOFTWARE.
+*/
+
+// Short_Cycle_Voltage.h finds the girth and the short cycle counts of a
+// quasi-cyclic (QC) graph from its base matrix of shifts alone, without
+// lifting it (see Short_Cycle_Sparse_Matrix.h).  The base graph has a
+// vertex per block row and per block column and an edge per nonzero
+// block, whose voltage is its shift: a step along it from a block row
+// adds the shift to the position within the block, and a step back
+// subtracts it, modulo the lifting size Z.  A closed walk of the base 
+// graph lifts to Z closed walks of the QC graph, which are cycles if no
+// part of the walk short of the whole is itself closed with voltage 0,
+// i.e., if the lifted walk visits no vertex twice.  Each cycle of length
+// k is so found k/2 times from the block rows, once per vertex of U and
+// direction, so N_k is Z/k times the number of such closed walks of
+// length k from the block rows.
+//
+// The walks are listed by a depth first search from each block row that
+// abandons any walk that cannot return within the longest length wanted.
+// The cost depends on the base graph and the lengths only, not on Z, so 
+// a candidate base matrix is checked long before its lifted graph could
+// be built.
+
+#ifndef SHORT_CYCLE_VOLTAGE
+#define SHORT_CYCLE_VOLTAGE
+
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+class Short_Cycle_Voltage
+{
+  public:
+	Short_Cycle_Voltage( void );
+	
+	// The base matrix (nbr x nbc, row by row) of shifts, with a negative
+	// shift for a zero block, and the lifting size z.
+	void initialize( int nbr, int nbc, int z, const int* shift );
+	int read_qc_file( const char* filename ); // See Short_Cycle_Sparse_Matrix.
+	
+	// Find the girth if there is a cycle of at most max_girth edges.
+	// Returns the girth, which is 1000000 if there is no cycle that short.
+	// The search stops at the first cycle found, so that a candidate with
+	// too small a girth is rejected quickly.
+	int find_girth( int max_girth );
+	
+	// Find the girth as above and count the cycles of length g, g+2 and
+	// g+4.  Returns the girth.
+	int count( int max_girth );
+	
+	int girth( void )  const { return g_;   };
+	int64_t Ng( void )  const { return Ng_;  };
+	int64_t Ng2( void ) const { return Ng2_; };
+	int64_t Ng4( void ) const { return Ng4_; };
+	
+  private:
+	// walks_[k] = the number of closed walks of length k <= longest from
+	// the block rows that lift to cycles.  With stop set the search ends
+	// at the first one.
+	void count_walks( int longest, int stop );
+	void extend( int vv, int sum, int depth, int last_edge ); // The depth first search.
+	
+	int nbr_, nbc_, z_;
+	
+	// The base graph.  Block row b is vertex b and block column c is 
+	// vertex nbr_+c.  The steps from vertex v are those ptr_[v] ... 
+	// ptr_[v+1]-1, each to vertex to_ along edge edge_ adding voltage_.
+	std::vector<int> ptr_, to_, edge_, voltage_;
+	
+	// The state of the search.
+	std::vector<int> dist_;		// Distance to the start, -1 if none.
+	std::vector<char> on_walk_;	// The lifted vertices of the current walk.
+	size_t start_;				// The lifted start.
+	std::vector<int64_t> walks_;
+	int longest_;
+	int stop_;
+	
+	int g_;
+	int64_t Ng_, Ng2_, Ng4_;
+};
+
+#endif
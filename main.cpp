@@ -39,25 +39,89 @@
 #include <iostream>
 #include <fstream>
 #include "Short_Cycle_Matrix.h"
+#include "Short_Cycle_Sparse_Matrix.h"
 #include "Short_Cycle_Counter.h"
+#include "Short_Cycle_Batch.h"
 #include <time.h>
 #include <windows.h>
 using namespace std;
 
 int main( int argc, const char* argv[] ) 
 {
-    if( (argc != 2) && (argc != 4) ) 
+    int batch_mode   = (argc == 3 && string(argv[1]) == "-batch");
+    int qc_mode      = (argc == 3 && string(argv[1]) == "-qc");
+    int mtx_mode     = (argc == 3 && string(argv[1]) == "-mtx");
+    int edges_mode   = (argc == 3 && string(argv[1]) == "-edges");
+    int convert_mode = ((argc == 4 || argc == 6) && string(argv[1]) == "-convert");
+    if( (argc != 2) && (argc != 4) && !batch_mode && !qc_mode && !mtx_mode && !edges_mode && !convert_mode ) 
 	{
-		cout << "TWO USAGES: " << argv[0] << " nc nr inicidence_matrix_filename" << endl
-		     << "            " << argv[0] << " alist_filename" << endl;
+		cout << "EIGHT USAGES: " << argv[0] << " nc nr inicidence_matrix_filename" << endl
+		     << "              " << argv[0] << " alist_filename|binary_filename|-" << endl
+		     << "              " << argv[0] << " -qc base_matrix_filename" << endl
+		     << "              " << argv[0] << " -mtx matrix_market_filename" << endl
+		     << "              " << argv[0] << " -edges edge_list_filename" << endl
+		     << "              " << argv[0] << " -batch directory|list_filename|-" << endl
+		     << "              " << argv[0] << " -convert alist_filename binary_filename" << endl
+		     << "              " << argv[0] << " -convert nc nr inicidence_matrix_filename binary_filename" << endl;
+	}
+	
+	// Batch mode: every alist file in a directory, or those named one per
+	// line in a list file or on stdin (-), one line of counts per graph.
+	else if( batch_mode )
+	{
+		Short_Cycle_Batch batch;
+		ifstream list;
+		if( string(argv[2]) == "-" ) batch.add_stream(cin);
+		else if( !batch.add_directory(argv[2]) ) 
+		{
+			list.open(argv[2]);
+			batch.add_stream(list);
+		}
+		
+		return batch.run(cout) ? 1 : 0;
+	}
+	
+	// Write an alist or incidence matrix file as a binary Tanner graph
+	// file, which is mapped rather than parsed when it is counted.
+	else if( convert_mode )
+	{
+		Short_Cycle_Sparse_Matrix E;
+		if( argc == 6 ? !E.read_incidence_matrix_file(atoi(argv[2]),atoi(argv[3]),argv[4]) 
+					  : !E.read_alist_file(argv[2]) )
+		{
+			cout << "cannot read " << argv[argc-2] << endl;
+			return 1;
+		}
+		
+		if( !E.write_binary_file(argv[argc-1]) )
+		{
+			cout << "cannot write " << argv[argc-1] << endl;
+			return 1;
+		}
+		
+		return 0;
 	}
 																			
 	else
 	{
-		Short_Cycle_Matrix E;
-		if( argc == 4 ) E.read_incidence_matrix_file(atoi(argv[1]),atoi(argv[2]),argv[3]);
-		else		    E.read_alist_file(argv[1]);
-		Short_Cycle_Counter E_counter(E);
+		Short_Cycle_Counter E_counter;
+		if( argc != 2 || !E_counter.read_binary_file(argv[1]) )
+		{
+			Short_Cycle_Sparse_Matrix E;
+			int read = 1;
+			if( argc == 4 )      read = E.read_incidence_matrix_file(atoi(argv[1]),atoi(argv[2]),argv[3]);
+			else if( qc_mode )    read = E.read_qc_file(argv[2]);
+			else if( mtx_mode )   read = E.read_matrix_market_file(argv[2]);
+			else if( edges_mode ) read = E.read_edge_list_file(argv[2]);
+			else				  read = E.read_alist_file(argv[1]);
+			if( !read )
+			{
+				cout << "cannot read " << argv[argc-1] << endl;
+				return 1;
+			}
+			
+			E_counter.initialize(E);
+		}
 
 		LARGE_INTEGER freq, t1, t2;
 		double elapsedTime;
@@ -72,6 +136,7 @@ int main( int argc, const char* argv[] )
 		     << "N_" << g   << " = " << E_counter.Ng()  << endl
 			 << "N_" << g+2 << " = " << E_counter.Ng2() << endl
 			 << "N_" << g+4 << " = " << E_counter.Ng4() << endl;
+		if( !E_counter.exact() ) cout << "(counts may exceed 2^64 and be inexact)" << endl;
 		
 		double mg = 0.0, sg = 0.0, mg2 = 0.0, sg2 = 0.0, mg4 = 0.0, sg4 = 0.0;
 		E_counter.cycle_dist(&mg,&sg,&mg2,&sg2,&mg4,&sg4);